@@ -1,5 +1,9 @@
 #include <Arduino.h>
 #include <BleKeyboard.h>
+#include <driver/uart.h>
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
 
 // --- KONFIGURATION ---
 // Name, der im Bluetooth-Menü des Tablets erscheint
@@ -8,12 +12,113 @@ BleKeyboard bleKeyboard("Teensy-PageTurner", "ESP32-Maker", 100);
 // Pin-Definition für UART zum Teensy
 // Beim ESP32-C3 sind GPIO 20 (RX) und 21 (TX) oft die Standard-UART Pins.
 // Prüfe dein Pinout!
-#define RX_PIN 20 
+#define RX_PIN 20
 #define TX_PIN 21
+#define TEENSY_UART UART_NUM_1      // HardwareSerial(1)
+#define TEENSY_BAUD 115200
+
+// Taster für "falsch geblättert": schickt 'p' an den Teensy, der daraufhin seinen
+// Flight-Recorder (letzte ~24 s) über USB ausgibt. GPIO 9 = BOOT-Taster des ESP32-C3.
+#define DUMP_BUTTON_PIN 9
+
+// Energiesparen zwischen den Befehlen:
+// loop() blockiert in uart_read_bytes(), der Idle-Task legt den Chip dann per
+// Auto-Light-Sleep schlafen. Die ersten Flanken auf RX wecken ihn wieder; was während des
+// Aufwachens ankommt, geht verloren. Deshalb schickt der Teensy vor jedem Befehl
+// WAKE_PREAMBLE_BYTES x WAKE_BYTE (LINK_WAKE_PREAMBLE in Settings.h, muss übereinstimmen).
+// Die BLE-Verbindung hält der Controller selbst: solange er nicht im Modem-Sleep ist, hält er
+// seine PM-Sperre und der Chip regelt nur den Takt herunter (DFS) statt ganz zu schlafen.
+#define USE_LIGHT_SLEEP 1
+#define CPU_MAX_MHZ 160
+#define CPU_MIN_MHZ 40
+#define WAKE_BYTE 'U'                // 0x55: 5 steigende Flanken pro Byte
+#define WAKE_PREAMBLE_BYTES 16       // ~1.4 ms bei 115200 Baud
+#define UART_WAKE_THRESHOLD 3        // Flanken bis zum Aufwachen (Minimum beim C3)
+#define LOOP_TIMEOUT_MS 50           // So oft wird der Taster abgefragt
+#define MAX_WAKE_LATENCY_US 5000     // Obergrenze für die Zusatzlatenz
+#define LATENCY_BAD_RUN 3            // So viele Befehle in Folge über der Grenze -> Light-Sleep aus
+#define LATENCY_GOOD_RUN 32          // So viele in Folge darunter -> Light-Sleep wieder an
+
+#define BYTE_US (10 * 1000000UL / TEENSY_BAUD)   // 8N1 = 10 Bit pro Byte
 
 // Initialisiere Hardware Serial 1
 HardwareSerial TeensySerial(1);
 
+// --- LATENZ ---
+// Gemessen wird vom ersten empfangenen Byte (Präambel, sonst der Befehl selbst) bis
+// "Taste gesendet". Das Aufwachen läuft parallel zur Präambel und steckt schon darin;
+// die Zahl verschluckter Präambel-Bytes wird nur zur Diagnose ausgegeben.
+int preambleSeen = 0;
+int64_t firstByteUs = 0;
+bool lightSleep = false;
+bool sleepAvailable = true;
+int badRun = 0;
+int goodRun = 0;
+uint32_t lastLatencyUs = 0;
+uint32_t maxLatencyUs = 0;
+uint32_t latencyCount = 0;
+
+void configurePower(bool sleep) {
+#if USE_LIGHT_SLEEP
+  esp_pm_config_esp32c3_t pm;
+  pm.max_freq_mhz = CPU_MAX_MHZ;
+  pm.min_freq_mhz = CPU_MIN_MHZ;
+  pm.light_sleep_enable = sleep;
+  esp_err_t err = esp_pm_configure(&pm);
+  if (err != ESP_OK && sleep) {
+    // Core ohne Tickless-Idle: wenigstens den Takt regeln
+    Serial.println("Light-Sleep nicht verfügbar, nur Taktregelung");
+    pm.light_sleep_enable = false;
+    err = esp_pm_configure(&pm);
+    sleep = false;
+    sleepAvailable = false;
+  }
+  if (err != ESP_OK) {
+    Serial.println("Power-Management nicht verfügbar");
+    sleepAvailable = false;
+  }
+  lightSleep = (err == ESP_OK) && sleep;
+#endif
+}
+
+void recordLatency(int64_t keySent) {
+  uint32_t latency = (uint32_t)(keySent - firstByteUs);
+  int lost = WAKE_PREAMBLE_BYTES - (preambleSeen < WAKE_PREAMBLE_BYTES ? preambleSeen : WAKE_PREAMBLE_BYTES);
+  lastLatencyUs = latency;
+  if (latency > maxLatencyUs) maxLatencyUs = latency;
+  latencyCount++;
+
+  Serial.print("Latenz: ");
+  Serial.print(latency);
+  Serial.print(" us (");
+  Serial.print(lost);
+  Serial.print(" Präambel-Bytes verschluckt, max ");
+  Serial.print(maxLatencyUs);
+  Serial.print(" us, ");
+  Serial.print(latencyCount);
+  Serial.println(" Befehle)");
+
+  // Präambel ganz verschluckt: beim nächsten Mal könnte es den Befehl selbst treffen.
+  // Ein einzelner Ausreißer schaltet nichts um, erst eine Serie.
+  bool bad = latency > MAX_WAKE_LATENCY_US || preambleSeen == 0;
+  if (bad) { badRun++; goodRun = 0; }
+  else     { goodRun++; badRun = 0; }
+
+  if (lightSleep && badRun >= LATENCY_BAD_RUN) {
+    Serial.print("Latenz ");
+    Serial.print(LATENCY_BAD_RUN);
+    Serial.print("x über ");
+    Serial.print(MAX_WAKE_LATENCY_US);
+    Serial.println(" us -> Light-Sleep aus");
+    configurePower(false);
+    goodRun = 0;
+  } else if (!lightSleep && sleepAvailable && goodRun >= LATENCY_GOOD_RUN) {
+    Serial.println("Latenz wieder im Rahmen -> Light-Sleep an");
+    configurePower(true);
+    badRun = 0;
+  }
+}
+
 void setup() {
   // Debug Serial über USB
   Serial.begin(9600);
@@ -21,46 +126,87 @@ void setup() {
 
   // Kommunikation zum Teensy
   // Baudrate muss mit dem Teensy übereinstimmen!
-  TeensySerial.begin(115200, SERIAL_8N1, RX_PIN, TX_PIN);
+  TeensySerial.begin(TEENSY_BAUD, SERIAL_8N1, RX_PIN, TX_PIN);
 
   // Starte Bluetooth Tastatur
   bleKeyboard.begin();
+
+  pinMode(DUMP_BUTTON_PIN, INPUT_PULLUP);
+
+#if USE_LIGHT_SLEEP
+  // UART am Quarz statt am APB-Takt, damit die Baudrate beim Herunterregeln stimmt
+  uart_config_t uart;
+  memset(&uart, 0, sizeof(uart));
+  uart.baud_rate = TEENSY_BAUD;
+  uart.data_bits = UART_DATA_8_BITS;
+  uart.parity = UART_PARITY_DISABLE;
+  uart.stop_bits = UART_STOP_BITS_1;
+  uart.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+  uart.source_clk = UART_SCLK_XTAL;
+  uart_param_config(TEENSY_UART, &uart);
+
+  uart_set_wakeup_threshold(TEENSY_UART, UART_WAKE_THRESHOLD);
+  esp_sleep_enable_uart_wakeup(TEENSY_UART);
+#endif
+  configurePower(true);
 }
 
 void loop() {
-  // Nur Befehle verarbeiten, wenn Bluetooth verbunden ist
-  if (bleKeyboard.isConnected()) {
-    
-    if (TeensySerial.available()) {
-      char command = TeensySerial.read();
-
-      // Debug Ausgabe
-      Serial.print("Befehl empfangen: ");
-      Serial.println(command);
-
-      switch (command) {
-        case 'n': // 'n' für Next (Nächste Seite)
-          // Die meisten Musik-Apps reagieren auf Pfeil Rechts, Pfeil Runter oder PageDown
-          bleKeyboard.write(KEY_PAGE_DOWN);
-          // Alternativ: bleKeyboard.write(KEY_RIGHT_ARROW);
-          break;
-
-        case 'p': // 'p' für Previous (Vorherige Seite)
-          bleKeyboard.write(KEY_PAGE_UP);
-          // Alternativ: bleKeyboard.write(KEY_LEFT_ARROW);
-          break;
-          
-        default:
-          Serial.println("Unbekannter Befehl");
-          break;
-      }
-    }
-  } else {
-    // Optional: Eine LED blinken lassen, wenn nicht verbunden
-    static unsigned long lastPrint = 0;
-    if (millis() - lastPrint > 3000) {
-      Serial.println("Warte auf Bluetooth Verbindung...");
-      lastPrint = millis();
+  // Rückkanal zum Teensy, unabhängig von der Bluetooth-Verbindung
+  static bool buttonWasDown = false;
+  static unsigned long lastButton = 0;
+  bool buttonDown = digitalRead(DUMP_BUTTON_PIN) == LOW;
+  if (buttonDown && !buttonWasDown && millis() - lastButton > 500) {
+    TeensySerial.write('p');
+    Serial.println("Dump angefordert");
+    lastButton = millis();
+  }
+  buttonWasDown = buttonDown;
+
+  // Verbindungsstatus nur bei Änderung melden
+  static bool wasConnected = false;
+  bool connected = bleKeyboard.isConnected();
+  if (connected != wasConnected) {
+    Serial.println(connected ? "Bluetooth verbunden" : "Warte auf Bluetooth Verbindung...");
+    wasConnected = connected;
+  }
+
+  // Blockiert bis ein Byte kommt oder LOOP_TIMEOUT_MS vorbei sind; in der Zeit schläft der Chip.
+  // Direkt über den Treiber, TeensySerial.read() würde pollen.
+  uint8_t command;
+  if (uart_read_bytes(TEENSY_UART, &command, 1, pdMS_TO_TICKS(LOOP_TIMEOUT_MS)) != 1) return;
+  int64_t received = esp_timer_get_time();
+  if (preambleSeen == 0) firstByteUs = received;
+
+  if (command == WAKE_BYTE) {
+    preambleSeen++;
+    return;
+  }
+
+  // Debug Ausgabe
+  Serial.print("Befehl empfangen: ");
+  Serial.println((char)command);
+
+  // Nur Befehle ausführen, wenn Bluetooth verbunden ist
+  if (connected) {
+    switch (command) {
+      case 'n': // 'n' für Next (Nächste Seite)
+        // Die meisten Musik-Apps reagieren auf Pfeil Rechts, Pfeil Runter oder PageDown
+        bleKeyboard.write(KEY_PAGE_DOWN);
+        // Alternativ: bleKeyboard.write(KEY_RIGHT_ARROW);
+        recordLatency(esp_timer_get_time());
+        break;
+
+      case 'p': // 'p' für Previous (Vorherige Seite)
+        bleKeyboard.write(KEY_PAGE_UP);
+        // Alternativ: bleKeyboard.write(KEY_LEFT_ARROW);
+        recordLatency(esp_timer_get_time());
+        break;
+
+      default:
+        Serial.println("Unbekannter Befehl");
+        break;
     }
   }
-}
\ No newline at end of file
+  preambleSeen = 0;
+}
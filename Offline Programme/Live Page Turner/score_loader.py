@@ -6,10 +6,15 @@
 #
 # Teensy-Äquivalent: ScoreData.h wird dort direkt als C-Array eingebunden.
 # Hier parsen wir die gleiche Datei zur Laufzeit.
+#
+# Alternativ ein Partitur-Speicher (Verzeichnis mit index.spti, siehe
+# Score Pipeline/score_store.py): dann wird nichts geparst, die Chroma-Matrix
+# ist ein np.memmap auf dieselben Seiten, die auch host_daemon/host_server nutzen.
 # =============================================================================
 
 import numpy as np
 import re
+import struct
 from dataclasses import dataclass
 from pathlib import Path
 
@@ -24,11 +29,17 @@ class ScoreData:
     filepath: str                   # Quelldatei
 
 
-def load_score_data(filepath: str) -> ScoreData:
-    """ScoreData.h parsen und als ScoreData-Objekt zurückgeben."""
+def load_score_data(filepath: str, name: str = None) -> ScoreData:
+    """ScoreData.h parsen und als ScoreData-Objekt zurückgeben.
+
+    Ist filepath ein Partitur-Speicher (Verzeichnis oder index.spti), wird die
+    Partitur name (Standard: die erste) per load_score_store() eingeblendet.
+    """
     path = Path(filepath)
     if not path.exists():
         raise FileNotFoundError(f"ScoreData nicht gefunden: {filepath}")
+    if path.is_dir() or path.suffix == ".spti":
+        return load_score_store(str(path if path.is_dir() else path.parent), name)
 
     print(f"Lade {filepath}...")
     content = path.read_text()
@@ -38,10 +49,16 @@ def load_score_data(filepath: str) -> ScoreData:
     score_len = _parse_int(content, r'score_len\s*=\s*(\d+)')
     page_end_indices = _parse_int_array(content, 'page_end_indices')
 
-    # --- Chroma-Daten extrahieren ---
-    chroma = _parse_chroma(content)
+    # --- Chroma-Daten extrahieren (12, 24 oder 36 Bins) ---
+    match = re.search(r'SCORE_NUM_CHROMA\s+(\d+)', content)
+    num_chroma = int(match.group(1)) if match else 12
+    chroma = _parse_chroma(content, num_chroma)
 
     # --- Validierung ---
+    if re.search(r'SCORE_BEAT_SYNC\s+1', content):
+        print("WARNUNG: ScoreData.h liegt im Schlag-Raster (--beat-sync), "
+              "der Python-Tracker arbeitet nur im Frame-Raster.")
+
     if len(page_end_indices) != num_pages:
         print(f"WARNUNG: num_pages={num_pages}, aber {len(page_end_indices)} Indizes gefunden.")
 
@@ -61,6 +78,59 @@ def load_score_data(filepath: str) -> ScoreData:
     )
 
 
+# Layout wie lib/ODTW/ScoreStore.h (ScoreIndexHeader, ScoreIndexEntry, ScoreFileHeader)
+_INDEX_HEADER = struct.Struct("<4s3I48s")
+_INDEX_ENTRY = struct.Struct("<64sQQ4I")
+_FILE_HEADER = struct.Struct("<4s5I f I f 4I 3I 64s")
+_FLAG_BEAT_SYNC = 0x04
+
+
+def load_score_store(store_dir: str, name: str = None) -> ScoreData:
+    """Partitur aus einem Partitur-Speicher einblenden (ohne Kopie).
+
+    chroma ist eine transponierte Sicht (num_chroma, N) auf ein np.memmap der
+    Datendatei; Seiten werden erst beim Zugriff gelesen und mit anderen
+    Prozessen geteilt.
+    """
+    store = Path(store_dir)
+    raw = (store / "index.spti").read_bytes()
+    magic, version, count, _, data_file = _INDEX_HEADER.unpack_from(raw, 0)
+    if magic != b"SPTI" or version != 1:
+        raise ValueError(f"{store}: kein Partitur-Index (Version 1)")
+
+    entries = [_INDEX_ENTRY.unpack_from(raw, _INDEX_HEADER.size + i * _INDEX_ENTRY.size) for i in range(count)]
+    names = [e[0].rstrip(b"\0").decode("utf-8") for e in entries]
+    if not entries or (name is not None and name not in names):
+        raise ValueError(f"Partitur '{name}' nicht in {store} (vorhanden: {', '.join(names) or '-'})")
+    _, offset, size, _, _, _, _ = entries[names.index(name) if name else 0]
+
+    data_path = store / data_file.rstrip(b"\0").decode("ascii")
+    with open(data_path, "rb") as f:
+        f.seek(offset)
+        header = _FILE_HEADER.unpack(f.read(_FILE_HEADER.size))
+    (_, _, num_chroma, length, num_pages, flags, _, _, _,
+     chroma_offset, _, _, pages_offset, _, _, _, score_name) = header
+
+    score_name = score_name.rstrip(b"\0").decode("utf-8")
+    print(f"Lade Partitur {score_name} aus {store}...")
+    if flags & _FLAG_BEAT_SYNC:
+        print("WARNUNG: Partitur liegt im Schlag-Raster (--beat-sync), "
+              "der Python-Tracker arbeitet nur im Frame-Raster.")
+    rows = np.memmap(data_path, dtype="<f4", mode="r", offset=offset + chroma_offset, shape=(length, num_chroma))
+    pages = np.memmap(data_path, dtype="<i4", mode="r", offset=offset + pages_offset, shape=(num_pages,))
+    page_end_indices = [int(p) for p in pages]
+    print(f"  Seiten: {num_pages}, Seitengrenzen: {page_end_indices}")
+    print(f"  Frames: {length}, Chroma-Shape: {rows.T.shape}")
+
+    return ScoreData(
+        num_pages=num_pages,
+        page_end_indices=page_end_indices,
+        score_len=length,
+        chroma=rows.T,
+        filepath=str(data_path),
+    )
+
+
 def _parse_int(content: str, pattern: str) -> int:
     """Einzelnen Integer per Regex extrahieren."""
     match = re.search(pattern, content)
@@ -78,8 +148,8 @@ def _parse_int_array(content: str, var_name: str) -> list[int]:
     return [int(x.strip()) for x in match.group(1).split(',') if x.strip()]
 
 
-def _parse_chroma(content: str) -> np.ndarray:
-    """Chroma-Float-Array aus C-Syntax parsen. Gibt (12, N) zurück."""
+def _parse_chroma(content: str, num_chroma: int = 12) -> np.ndarray:
+    """Chroma-Float-Array aus C-Syntax parsen. Gibt (num_chroma, N) zurück."""
     # Alles ab "score_chroma" finden
     keyword = "score_chroma"
     start_pos = content.find(keyword)
@@ -88,7 +158,10 @@ def _parse_chroma(content: str) -> np.ndarray:
 
     content_chroma = content[start_pos:]
     array_start = content_chroma.find('{')
-    array_end = content_chroma.rfind('}')
+    # Nur bis zum Ende von score_chroma (danach kann score_onset[] folgen)
+    array_end = content_chroma.find('};')
+    if array_end == -1:
+        array_end = content_chroma.rfind('}')
     data_string = content_chroma[array_start:array_end + 1]
 
     # Bereinigen: f-Suffix, Klammern, Semikolons entfernen
@@ -105,9 +178,9 @@ def _parse_chroma(content: str) -> np.ndarray:
     if len(values) == 0:
         raise ValueError("Keine Chroma-Werte gefunden!")
 
-    if len(values) % 12 != 0:
-        print(f"WARNUNG: {len(values)} Werte nicht durch 12 teilbar. Schneide ab.")
-        values = values[:(len(values) // 12) * 12]
+    if len(values) % num_chroma != 0:
+        print(f"WARNUNG: {len(values)} Werte nicht durch {num_chroma} teilbar. Schneide ab.")
+        values = values[:(len(values) // num_chroma) * num_chroma]
 
-    # Shape (N, 12) → Transponieren zu (12, N)
-    return np.array(values, dtype=np.float32).reshape(-1, 12).T
+    # Shape (N, num_chroma) → Transponieren zu (num_chroma, N)
+    return np.array(values, dtype=np.float32).reshape(-1, num_chroma).T
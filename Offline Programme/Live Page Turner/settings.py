@@ -33,7 +33,7 @@ STEP_PENALTY = 0.0           # Diagonaler Schritt kostet nichts (Teensy: PENALTY
 PAGE_TURN_OFFSET = 10        # Frames VOR page_end_index auslösen (Teensy: PAGE_TURN_OFFSET = 10)
 
 # --- Start-Erkennung ---
-START_THRESHOLD_RMS = 0.01   # RMS-Schwelle zum Starten (Teensy: START_THRESHOLD = 1500, int16-Skala)
+START_THRESHOLD_RMS = 0.01   # RMS-Schwelle zum Starten (Teensy: START_THRESHOLD = 4.0, SNR über Rauschboden)
 
 # --- Musikalischer Kontext ---
 BPM = 40                     # Tempo des Stücks
@@ -43,7 +43,7 @@ BEATS_PER_MEASURE = 4        # Taktart (4/4)
 SMOOTHING_WINDOW = 1         # Moving Average für Chroma (1 = aus)
 
 # --- Dateipfade ---
-SCORE_DATA_PATH = "../ODTW_Python/data/ScoreData.h"
+SCORE_DATA_PATH = "../ODTW_Python/data/ScoreData.h"   # oder ein Partitur-Speicher (Verzeichnis mit index.spti)
 
 # --- GUI ---
 GUI_UPDATE_MS = 50           # GUI-Poll-Intervall in ms (20 Hz)
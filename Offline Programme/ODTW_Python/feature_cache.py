@@ -0,0 +1,355 @@
+# =============================================================================
+# feature_cache.py – Persistenter Feature-Cache für wiederholte Auswertungen
+# =============================================================================
+# Optimierung und Robustheitstests rechnen bei jedem Lauf die Chroma der Live-Aufnahmen neu, bevor
+# überhaupt DTW passiert. Der Cache legt die Features einmal auf der Platte ab und blendet sie bei
+# jedem weiteren Lauf per np.memmap ein (keine DSP, kein Parsen). float32-Dateien liefern die Chroma ohne
+# Kopie; bei uint8-Dateien (--quantize, 1/4 der Chroma) dequantisiert .chroma beim ersten Zugriff in eine
+# float32-Kopie. Die rohe Sicht bleibt über .stored und .scale erreichbar.
+#
+# Schlüssel (inhaltsadressiert): sha256 über den Inhalt der Audiodatei + Extraktor-Parameter + Format,
+# bei audiodsp zusätzlich über das host_features-Programm selbst (DSP-Code und Konstanten aus Settings.h
+# stecken in der Übersetzung, nicht alle in den Parametern). Umbenennen/Kopieren der WAV trifft denselben
+# Eintrag, jede Parameter-Änderung und jede neu übersetzte DSP erzeugt einen neuen.
+#
+# Extraktoren:
+#   audiodsp  DSP-Kette der Firmware (AGC -> FeatureStage), über host_features (env:native_features).
+#             Ein Frame pro FFT_SIZE Samples (~93 ms), mit Flags (aktiv/Pause), SNR und Onset.
+#   librosa   chroma_stft wie in test_robustness.py (Hop 512), Lautstärke = RMS.
+#
+# Dateiformat .sptf (Layout in "Smarter Page Turner/host/FeatureFile.h"): 128-Byte-Kopf, dann
+# flags uint8, volume/snr/onset float32 und chroma [frames][bins] als float32 oder uint8, jeder
+# Abschnitt auf 64 Byte ausgerichtet.
+#
+# Nutzung:
+#   from feature_cache import load_features
+#   feats = load_features("aufnahme.wav")                        # audiodsp
+#   feats = load_features("aufnahme.wav", extractor="librosa")   # wie bisher, nur gecacht
+#   feats.chroma  -> (bins, N) float32,  feats.volume / .snr / .onset / .flags -> (N,)
+#   feats.stored  -> (bins, N) wie in der Datei (float32 oder uint8), Wert = stored * scale bei uint8
+#
+#   python feature_cache.py build aufnahmen/*.wav [--extractor librosa] [--quantize]
+#   python feature_cache.py info aufnahme.wav|datei.sptf
+#   python feature_cache.py list
+#   python feature_cache.py clear
+#
+# Umgebungsvariablen: SPT_FEATURE_CACHE (Cache-Verzeichnis), SPT_FEATURE_TOOL (host_features-Programm)
+# =============================================================================
+
+import os
+import sys
+import struct
+import hashlib
+import argparse
+import subprocess
+import tempfile
+from dataclasses import dataclass
+from functools import cached_property
+from pathlib import Path
+
+import numpy as np
+
+_HERE = Path(__file__).resolve().parent
+CACHE_DIR = Path(os.environ.get("SPT_FEATURE_CACHE", _HERE.parent / "data" / "cache" / "features"))
+FEATURE_TOOL = Path(os.environ.get(
+    "SPT_FEATURE_TOOL",
+    _HERE.parent.parent / "Smarter Page Turner" / ".pio" / "build" / "native_features" / "program"))
+
+# Parameter der librosa-Extraktion; test_robustness.py rechnet ohne Cache mit denselben Konstanten
+LIBROSA_SAMPLE_RATE = 44100
+LIBROSA_N_FFT = 4096
+LIBROSA_HOP_LENGTH = 512
+
+# --- DATEIFORMAT (muss zu FeatureFile.h passen) ---
+FEATURE_MAGIC = b"SPTF"
+FEATURE_VERSION = 1
+FEATURE_ALIGN = 64
+DTYPE_F32 = 0
+DTYPE_U8 = 1
+_HEADER = struct.Struct("<4s4I f I f 5I 3I 64s")
+assert _HEADER.size == 128
+
+# Flags pro Frame (wie FeatureStage.h)
+FEATURE_ACTIVE = 0x01
+FEATURE_TRACK = 0x02
+
+
+@dataclass
+class LiveFeatures:
+    """Features einer Aufnahme. Arrays sind schreibgeschützte Sichten auf die Cache-Datei (außer .chroma
+    bei uint8-Dateien, siehe dort)."""
+    stored: np.ndarray          # (bins, N) Chroma wie abgelegt, float32 oder uint8
+    scale: float                # uint8: Wert = stored * scale; float32: 0
+    volume: np.ndarray          # (N,)
+    snr: np.ndarray
+    onset: np.ndarray
+    flags: np.ndarray           # (N,) uint8, FEATURE_ACTIVE / FEATURE_TRACK
+    sample_rate: float
+    frame_samples: int          # Samples pro Frame
+    params: str
+    path: Path
+
+    @property
+    def frames(self) -> int:
+        return self.flags.shape[0]
+
+    @cached_property
+    def chroma(self) -> np.ndarray:
+        """(bins, N) float32. float32-Dateien: die Sicht selbst; uint8: einmal dequantisierte Kopie."""
+        if self.stored.dtype == np.float32:
+            return self.stored
+        return self.stored.astype(np.float32) * np.float32(self.scale)
+
+
+# --- LESEN / SCHREIBEN ---
+
+def read_feature_file(path) -> LiveFeatures:
+    """Feature-Datei einblenden (np.memmap, nur lesend)."""
+    path = Path(path)
+    with open(path, "rb") as f:
+        head = f.read(_HEADER.size)
+    if len(head) < _HEADER.size:
+        raise ValueError(f"{path}: zu kurz für eine Feature-Datei")
+    (magic, version, bins, frames, dtype, rate, frame_samples, scale,
+     flags_off, volume_off, snr_off, onset_off, chroma_off, *_reserved, params) = _HEADER.unpack(head)
+    if magic != FEATURE_MAGIC or version != FEATURE_VERSION or dtype not in (DTYPE_F32, DTYPE_U8):
+        raise ValueError(f"{path}: keine Feature-Datei (Version {FEATURE_VERSION})")
+
+    def section(offset, dt, shape):
+        if frames == 0:
+            return np.zeros(shape, dtype=dt)
+        return np.memmap(path, dtype=dt, mode="r", offset=offset, shape=shape)
+
+    return LiveFeatures(
+        stored=section(chroma_off, np.float32 if dtype == DTYPE_F32 else np.uint8, (frames, bins)).T,
+        scale=float(scale) if dtype == DTYPE_U8 else 0.0,
+        volume=section(volume_off, np.float32, (frames,)),
+        snr=section(snr_off, np.float32, (frames,)),
+        onset=section(onset_off, np.float32, (frames,)),
+        flags=section(flags_off, np.uint8, (frames,)),
+        sample_rate=float(rate),
+        frame_samples=int(frame_samples),
+        params=params.split(b"\0", 1)[0].decode("ascii", "replace"),
+        path=path,
+    )
+
+
+def write_feature_file(path, chroma, volume, sample_rate, frame_samples, params,
+                       snr=None, onset=None, flags=None, quantize=False):
+    """chroma (bins, N) und Spuren (N,) als Feature-Datei schreiben (erst temporär, dann umbenennen)."""
+    path = Path(path)
+    chroma = np.ascontiguousarray(np.asarray(chroma, dtype=np.float32).T)   # (N, bins)
+    frames, bins = chroma.shape
+    zeros = np.zeros(frames, dtype=np.float32)
+    tracks = [np.asarray(v if v is not None else zeros, dtype=np.float32) for v in (volume, snr, onset)]
+    if flags is None:
+        flags = np.full(frames, FEATURE_ACTIVE | FEATURE_TRACK, dtype=np.uint8)
+    flags = np.asarray(flags, dtype=np.uint8)
+
+    scale = 0.0
+    if quantize:
+        peak = float(chroma.max()) if chroma.size else 0.0
+        scale = peak / 255.0 if peak > 0 else 1.0 / 255.0
+        chroma = np.clip(np.round(chroma / scale), 0, 255).astype(np.uint8)
+
+    def place(pos, nbytes):
+        at = -(-pos // FEATURE_ALIGN) * FEATURE_ALIGN
+        return at, at + nbytes
+
+    offsets = []
+    pos = _HEADER.size
+    for block in [flags] + tracks + [chroma]:
+        at, pos = place(pos, block.nbytes)
+        offsets.append(at)
+
+    head = _HEADER.pack(FEATURE_MAGIC, FEATURE_VERSION, bins, frames, DTYPE_U8 if quantize else DTYPE_F32,
+                        sample_rate, frame_samples, scale, *offsets, 0, 0, 0, params.encode("ascii")[:63])
+    path.parent.mkdir(parents=True, exist_ok=True)
+    fd, tmp = tempfile.mkstemp(dir=path.parent, suffix=".tmp")
+    try:
+        with os.fdopen(fd, "wb") as f:
+            f.write(head)
+            for at, block in zip(offsets, [flags] + tracks + [chroma]):
+                f.write(b"\0" * (at - f.tell()))
+                f.write(block.tobytes())
+        os.replace(tmp, path)
+    except BaseException:
+        os.unlink(tmp)
+        raise
+
+
+# --- SCHLÜSSEL ---
+
+_digests = {}
+
+
+def file_digest(path) -> str:
+    """sha256 des Dateiinhalts; pro Prozess nach (Pfad, Größe, mtime) gemerkt."""
+    path = Path(path).resolve()
+    st = path.stat()
+    memo = (str(path), st.st_size, st.st_mtime_ns)
+    if memo not in _digests:
+        h = hashlib.sha256()
+        with open(path, "rb") as f:
+            for block in iter(lambda: f.read(1 << 20), b""):
+                h.update(block)
+        _digests[memo] = h.hexdigest()
+    return _digests[memo]
+
+
+_tool_params = {}
+
+
+def extractor_params(extractor: str, tool=None, **options) -> str:
+    """Parameter-Zeichenkette eines Extraktors (geht in Datei und Schlüssel)."""
+    if extractor == "librosa":
+        import librosa
+        return (f"librosa/{librosa.__version__} sr={LIBROSA_SAMPLE_RATE} fft={LIBROSA_N_FFT} "
+                f"hop={LIBROSA_HOP_LENGTH} tuning=0")
+    if extractor != "audiodsp":
+        raise ValueError(f"Unbekannter Extraktor: {extractor}")
+    tool = Path(tool or FEATURE_TOOL)
+    args = _tool_args(**options)
+    memo = (str(tool), tuple(args))
+    if memo not in _tool_params:
+        if not tool.exists():
+            raise FileNotFoundError(f"{tool} fehlt (pio run -e native_features oder SPT_FEATURE_TOOL setzen)")
+        out = subprocess.run([str(tool), "--params", *args], capture_output=True, text=True, check=True)
+        _tool_params[memo] = out.stdout.strip()
+    return _tool_params[memo]
+
+
+def _tool_args(rate=None, resample=False, agc=True):
+    args = []
+    if rate:
+        args += ["--rate", str(rate)]
+    if resample:
+        args.append("--resample")
+    if not agc:
+        args.append("--no-agc")
+    return args
+
+
+def feature_key(audio_path, params: str, quantize: bool, tool=None) -> str:
+    """tool: host_features-Programm (nur audiodsp), sein Inhalt geht mit in den Schlüssel."""
+    h = hashlib.sha256()
+    h.update(file_digest(audio_path).encode())
+    h.update(b"\0" + params.encode())
+    if tool is not None:
+        h.update(b"\0" + file_digest(tool).encode())
+    h.update(b"\0u8" if quantize else b"\0f32")
+    return h.hexdigest()
+
+
+def cache_path(key: str, cache_dir=None) -> Path:
+    return Path(cache_dir or CACHE_DIR) / key[:2] / f"{key}.sptf"
+
+
+# --- EXTRAKTION ---
+
+def _extract_audiodsp(audio_path, out_path, tool, quantize, options):
+    out_path.parent.mkdir(parents=True, exist_ok=True)
+    fd, tmp = tempfile.mkstemp(dir=out_path.parent, suffix=".tmp")
+    os.close(fd)
+    try:
+        args = [str(tool or FEATURE_TOOL), *_tool_args(**options)]
+        if quantize:
+            args.append("--quantize")
+        subprocess.run([*args, str(audio_path), tmp], capture_output=True, text=True, check=True)
+        os.replace(tmp, out_path)
+    except BaseException:
+        if os.path.exists(tmp):
+            os.unlink(tmp)
+        raise
+
+
+def _extract_librosa(audio_path, out_path, params, quantize):
+    import librosa
+    y, sr = librosa.load(str(audio_path), sr=LIBROSA_SAMPLE_RATE, mono=True)
+    chroma = librosa.feature.chroma_stft(
+        y=y, sr=sr, n_fft=LIBROSA_N_FFT, hop_length=LIBROSA_HOP_LENGTH, tuning=0, n_chroma=12
+    )
+    volume = librosa.feature.rms(y=y, frame_length=LIBROSA_N_FFT, hop_length=LIBROSA_HOP_LENGTH)[0]
+    write_feature_file(out_path, chroma, volume[:chroma.shape[1]], sr, LIBROSA_HOP_LENGTH, params,
+                       quantize=quantize)
+
+
+def load_features(audio_path, extractor="audiodsp", quantize=False, cache_dir=None, refresh=False,
+                  tool=None, **options) -> LiveFeatures:
+    """Features einer Aufnahme aus dem Cache, beim ersten Mal extrahieren und ablegen.
+
+    options (nur audiodsp): rate=Hz (echte Aufnahmerate), resample=True, agc=False
+    """
+    params = extractor_params(extractor, tool, **options)
+    key_tool = (tool or FEATURE_TOOL) if extractor == "audiodsp" else None
+    path = cache_path(feature_key(audio_path, params, quantize, key_tool), cache_dir)
+    if refresh or not path.exists():
+        if extractor == "audiodsp":
+            _extract_audiodsp(audio_path, path, tool, quantize, options)
+        else:
+            _extract_librosa(audio_path, path, params, quantize)
+    return read_feature_file(path)
+
+
+# --- KOMMANDOZEILE ---
+
+def _describe(feats: LiveFeatures):
+    active = int(np.count_nonzero(feats.flags & FEATURE_ACTIVE))
+    seconds = feats.frames * feats.frame_samples / feats.sample_rate if feats.sample_rate else 0.0
+    return (f"{feats.frames} Frames ({seconds:.1f} s, {active} aktiv), {feats.stored.shape[0]} Bins, "
+            f"{feats.path.stat().st_size / 1024:.0f} KB  [{feats.params}]")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Feature-Cache für Live-Aufnahmen.")
+    sub = parser.add_subparsers(dest="command", required=True)
+    build = sub.add_parser("build", help="Features für Aufnahmen erzeugen (falls nicht im Cache)")
+    build.add_argument("audio", nargs="+")
+    build.add_argument("--extractor", choices=["audiodsp", "librosa"], default="audiodsp")
+    build.add_argument("--quantize", action="store_true", help="Chroma als uint8 ablegen")
+    build.add_argument("--refresh", action="store_true", help="Vorhandene Einträge neu rechnen")
+    build.add_argument("--rate", type=float, default=None, help="audiodsp: echte Aufnahmerate")
+    info = sub.add_parser("info", help="Eintrag einer Aufnahme oder einer .sptf-Datei anzeigen")
+    info.add_argument("file")
+    info.add_argument("--extractor", choices=["audiodsp", "librosa"], default="audiodsp")
+    info.add_argument("--quantize", action="store_true")
+    sub.add_parser("list", help="Cache-Inhalt anzeigen")
+    sub.add_parser("clear", help="Cache leeren")
+    args = parser.parse_args()
+
+    try:
+        if args.command == "build":
+            for audio in args.audio:
+                options = {"rate": args.rate} if args.extractor == "audiodsp" else {}
+                feats = load_features(audio, args.extractor, args.quantize, refresh=args.refresh, **options)
+                print(f"{audio}: {_describe(feats)}")
+        elif args.command == "info":
+            if args.file.endswith(".sptf"):
+                feats = read_feature_file(args.file)
+            else:
+                params = extractor_params(args.extractor)
+                key_tool = FEATURE_TOOL if args.extractor == "audiodsp" else None
+                path = cache_path(feature_key(args.file, params, args.quantize, key_tool))
+                if not path.exists():
+                    print(f"{args.file}: nicht im Cache ({path.name})")
+                    return
+                feats = read_feature_file(path)
+            print(f"{feats.path}: {_describe(feats)}")
+        else:
+            files = sorted(CACHE_DIR.glob("*/*.sptf")) if CACHE_DIR.exists() else []
+            total = sum(f.stat().st_size for f in files)
+            if args.command == "clear":
+                for f in files:
+                    f.unlink()
+                print(f"{CACHE_DIR}: {len(files)} Einträge gelöscht ({total / 1024:.0f} KB)")
+            else:
+                print(f"{CACHE_DIR}: {len(files)} Einträge, {total / 1024:.0f} KB")
+                for f in files:
+                    print(f"  {f.stem[:16]}  {_describe(read_feature_file(f))}")
+    except (FileNotFoundError, ValueError, subprocess.CalledProcessError) as e:
+        print(f"FEHLER: {e}")
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -8,6 +8,7 @@ Testet die Robustheit des Online-DTW-Algorithmus gegen:
 Features:
 - Lädt Audio von WAV (wie im echten Teensy)
 - Automatisches Speichern von .npy Dateien für Verifikation
+- Chroma der WAV wird im Feature-Cache abgelegt (feature_cache.py), Folgeläufe rechnen nicht neu
 - Debug-Analyse mit Tracking Position und Globalen Kosten
 
 Bsp: python3 test_robustness.py --recovery --jump 50 30
@@ -24,15 +25,16 @@ from scipy.ndimage import zoom
 from collections import deque
 from dtw_engine import StandardODTW, DebugODTW, load_score_chroma
 from recovery_odtw import RecoveryODTW
+from feature_cache import load_features, LIBROSA_SAMPLE_RATE, LIBROSA_N_FFT, LIBROSA_HOP_LENGTH
 
 # --- KONFIGURATION ---
 SCORE_FILE = "/Users/samuelgeffert/Desktop/GitHub/2.-Studienarbeit-Smarter-Page-Turner/Offline Programme/data/generated/Pachelbel_Musescore.npz"
 LIVE_WAV_FILE = "/Users/samuelgeffert/Desktop/GitHub/2.-Studienarbeit-Smarter-Page-Turner/Offline Programme/data/audio/Pachelbel-Live-35bpm.wav"
 NPY_OUTPUT_DIR = "../data/generated"  # NPY-Dateien werden hier gespeichert
 
-# Musikalische Parameter
-SAMPLE_RATE = 44100
-HOP_LENGTH = 512
+# Musikalische Parameter (Extraktion wie im Feature-Cache, sonst treffen Cache und Neuberechnung andere Frames)
+SAMPLE_RATE = LIBROSA_SAMPLE_RATE
+HOP_LENGTH = LIBROSA_HOP_LENGTH
 BPM = 40
 BEATS_PER_MEASURE = 4
 
@@ -64,20 +66,25 @@ def stretch_chroma(chroma, speed_factor):
     zoom_factor = 1 / speed_factor
     return zoom(chroma, (1, zoom_factor), order=1)
 
-def load_chroma_from_wav(wav_file, save_npy=True):
+def load_chroma_from_wav(wav_file, save_npy=True, use_cache=True):
     """
     Lädt Audio und extrahiert Chroma-Features.
+    Mit use_cache kommt die Chroma aus dem Feature-Cache (beim ersten Mal berechnet und abgelegt).
     Speichert optional als .npy für spätere Verwendung/Verifikation.
     """
     print(f"Lade WAV: {wav_file}...")
 
-    # Audio laden
-    y, sr = librosa.load(wav_file, sr=SAMPLE_RATE, mono=True)
+    if use_cache:
+        # Gleiche Parameter wie unten; nur lesend verwendet, daher direkt die Sicht auf den Cache
+        chroma_raw = load_features(wav_file, extractor="librosa").chroma
+    else:
+        # Audio laden
+        y, sr = librosa.load(wav_file, sr=SAMPLE_RATE, mono=True)
 
-    # Chroma berechnen
-    chroma_raw = librosa.feature.chroma_stft(
-        y=y, sr=sr, n_fft=4096, hop_length=HOP_LENGTH, tuning=0, n_chroma=12
-    )
+        # Chroma berechnen
+        chroma_raw = librosa.feature.chroma_stft(
+            y=y, sr=sr, n_fft=LIBROSA_N_FFT, hop_length=HOP_LENGTH, tuning=0, n_chroma=12
+        )
 
     # Optional: Als .npy speichern (für Verifikation mit audio_generator)
     if save_npy:
@@ -334,6 +341,8 @@ def main():
                         help="Rückwärtssprung simulieren: --jump 50 30 (von Takt 50 zu Takt 30)")
     parser.add_argument("--score", default=SCORE_FILE, help="Partitur (.npz)")
     parser.add_argument("--wav", default=LIVE_WAV_FILE, help="Live-Audio WAV")
+    parser.add_argument("--no-cache", action="store_true",
+                        help="Chroma neu berechnen statt aus dem Feature-Cache zu laden")
     args = parser.parse_args()
 
     # Referenz-Chroma laden
@@ -348,7 +357,7 @@ def main():
     print(f"\n=== ODTW Robustness Testing ({mode}) ===")
     print("Lade Live-Audio von WAV...")
     try:
-        live_base = load_chroma_from_wav(args.wav, save_npy=True)
+        live_base = load_chroma_from_wav(args.wav, save_npy=True, use_cache=not args.no_cache)
     except FileNotFoundError:
         print(f"Fehler: {args.wav} nicht gefunden!")
         return
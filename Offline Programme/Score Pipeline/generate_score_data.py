@@ -7,6 +7,12 @@
 #   python generate_score_data.py partitur.musicxml --bpm 40
 #   python generate_score_data.py partitur.mxl --bpm 40 --instrument piano
 #   python generate_score_data.py partitur.pdf --bpm 40   (braucht Audiveris)
+#   python generate_score_data.py partitur.musicxml --feature cens --header
+#       → zusätzlich <name>.h (ScoreData.h-Format) mit CENS-Features für den Teensy
+#   python generate_score_data.py partitur.musicxml --bpm 40 --beat-sync --header
+#       → ein Eintrag pro notiertem Schlag, Seitenenden in Schlägen (BeatAggregator auf dem Teensy)
+#   python generate_score_data.py partitur.musicxml --store ~/scores
+#       → zusätzlich in einen Partitur-Speicher für host_daemon/host_server (score_store.py)
 #
 # Benötigt: brew install fluidsynth + Soundfont in data/soundfonts/
 # =============================================================================
@@ -15,8 +21,8 @@ import sys
 import argparse
 from pathlib import Path
 
-from utils.chroma_builder import build_chroma
-from utils.score_writer import write_score_data
+from utils.chroma_builder import build_chroma, beat_sync, frames_per_beat, SAMPLE_RATE, HOP_LENGTH
+from utils.score_writer import write_score_data, write_score_header, score_to_bytes, write_score_store
 from utils.omr import convert_pdf
 
 OUTPUT_DIR = Path(__file__).parent.parent / "data" / "generated"
@@ -35,6 +41,18 @@ def main():
                         help="Instrument (violin, piano, cello, flute, ... Standard: violin)")
     parser.add_argument("--output", type=str, default=None,
                         help="Ausgabedatei (Standard: data/generated/<name>.npz)")
+    parser.add_argument("--feature", choices=["stft", "cens"], default="stft",
+                        help="Feature-Typ: stft (Standard) oder cens (muss zur Firmware passen)")
+    parser.add_argument("--bins", type=int, choices=[12, 24, 36], default=12,
+                        help="Chroma-Breite (muss NUM_CHROMA der Firmware entsprechen, Standard: 12)")
+    parser.add_argument("--beat-sync", action="store_true",
+                        help="Chroma pro notiertem Schlag mitteln (tempo-unabhängiges DTW-Raster)")
+    parser.add_argument("--header", action="store_true",
+                        help="Zusätzlich ScoreData.h für die Teensy-Firmware schreiben")
+    parser.add_argument("--symbol", type=str, default=None,
+                        help="Mit --header: Partitur für die Score-Bibliothek in namespace SYMBOL")
+    parser.add_argument("--store", type=str, default=None,
+                        help="Zusätzlich in diesen Partitur-Speicher eintragen (Name = Dateiname)")
     args = parser.parse_args()
 
     input_path = Path(args.input_file)
@@ -69,19 +87,40 @@ def main():
 
     print(f"\n[2/3] Synthetisiere Audio und berechne Chroma")
     try:
-        chroma, page_indices = build_chroma(
+        chroma, page_indices, onset = build_chroma(
             musicxml_path, args.bpm, args.instrument,
-            wav_output_path=str(wav_output_path)
+            wav_output_path=str(wav_output_path),
+            feature=args.feature,
+            n_chroma=args.bins
         )
     except Exception as e:
         print(f"FEHLER bei Chroma-Berechnung: {e}")
         sys.exit(1)
 
+    beat_frames = None
+    if args.beat_sync:
+        beat_frames = frames_per_beat(args.bpm)
+        chroma, onset, page_indices = beat_sync(chroma, onset, page_indices, beat_frames)
+
     # 3. ScoreData.npz speichern
 
     print(f"\n[3/3] Speichere {output_path}")
-    metadata = f"Generiert aus {input_path.name}, BPM: {args.bpm}, Instrument: {args.instrument}"
-    write_score_data(str(output_path), chroma, page_indices, metadata)
+    metadata = (f"Generiert aus {input_path.name}, BPM: {args.bpm}, "
+                f"Instrument: {args.instrument}, Feature: {args.feature}, Bins: {args.bins}"
+                f"{', Beat-Sync' if args.beat_sync else ''}")
+    write_score_data(str(output_path), chroma, page_indices, metadata, onset=onset,
+                     beat_frames=beat_frames)
+    if args.header:
+        write_score_header(str(output_path.with_suffix(".h")), chroma, page_indices,
+                           metadata, feature=args.feature, onset=onset,
+                           sample_rate=SAMPLE_RATE, hop_length=HOP_LENGTH,
+                           beat_frames=beat_frames, name=input_path.stem,
+                           symbol=args.symbol)
+    if args.store:
+        record = score_to_bytes(input_path.stem, chroma, page_indices, feature=args.feature,
+                                onset=onset, sample_rate=SAMPLE_RATE, hop_length=HOP_LENGTH,
+                                beat_frames=beat_frames)
+        write_score_store(args.store, {input_path.stem: record})
 
     print(f"\nFERTIG! {output_path}")
     print(f"  Frames: {chroma.shape[1]}, Seiten: {len(page_indices) + 1}")
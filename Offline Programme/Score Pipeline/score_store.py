@@ -0,0 +1,134 @@
+# =============================================================================
+# score_store.py – Partitur-Speicher für Host-Prozesse verwalten
+# =============================================================================
+# Ein Speicher ist ein Verzeichnis (index.spti + scores-<gen>.spts), das host_daemon und
+# host_server per mmap einblenden (lib/ODTW/ScoreStore.h) und score_loader.py per np.memmap.
+#
+# Nutzung:
+#   python score_store.py add  STORE ScoreData.h                 (Header der Firmware)
+#   python score_store.py add  STORE fiocco.h --name Fiocco      (Bibliotheks-Partitur, namespace)
+#   python score_store.py add  STORE Fiocco.npz --feature cens   (.npz aus generate_score_data.py)
+#   python score_store.py list STORE
+#   python score_store.py remove STORE Fiocco
+#
+# Direkt beim Erzeugen: generate_score_data.py partitur.musicxml --store STORE
+# =============================================================================
+
+import re
+import sys
+import argparse
+from pathlib import Path
+
+import numpy as np
+
+from utils.score_writer import (score_to_bytes, read_score_store, write_score_store,
+                                FLAG_CENS, FLAG_ONSET, FLAG_BEAT_SYNC)
+
+# Raster, wenn die Quelle keins angibt (wie chroma_builder.py / ScoreLibrary.h)
+DEFAULT_SAMPLE_RATE = 44100
+DEFAULT_HOP_LENGTH = 512
+
+
+def _header_value(content: str, define: str, const: str, default):
+    """#define SCORE_X wert (Haupt-Partitur) bzw. const ... x = wert; (namespace) lesen."""
+    if isinstance(default, str):
+        match = (re.search(rf'#define\s+{define}\s+"([^"]*)"', content) or
+                 re.search(rf'\b{const}\[\]\s*=\s*"([^"]*)"', content))
+        return match.group(1) if match else default
+    match = (re.search(rf'#define\s+{define}\s+(\S+)', content) or
+             re.search(rf'\b{const}\s*=\s*([^;]+);', content))
+    if not match:
+        return default
+    value = match.group(1).strip().rstrip("f")
+    if value in ("true", "false"):
+        return value == "true"
+    return type(default)(float(value))
+
+
+def _c_array(content: str, name: str) -> list[float]:
+    """Zahlen aus const ... name[]... = { ... }; (auch zweidimensional)."""
+    match = re.search(rf'\b{name}\s*\[[^=]*=\s*\{{(.*?)\}}\s*;', content, re.S)
+    if not match:
+        return []
+    return [float(v.rstrip("f")) for v in re.findall(r'-?\d+(?:\.\d+)?(?:e-?\d+)?f?', match.group(1))]
+
+
+def load_header(path: Path, name: str = None) -> dict:
+    """ScoreData.h (oder eine Bibliotheks-Partitur) in die Argumente für score_to_bytes()."""
+    content = path.read_text()
+    num_chroma = _header_value(content, "SCORE_NUM_CHROMA", "num_chroma", 12)
+    cens = _header_value(content, "SCORE_FEATURE_CENS", "feature_cens", 0)
+    beat = _header_value(content, "SCORE_BEAT_SYNC", "beat_sync", 0)
+    values = _c_array(content, "score_chroma")
+    if not values or len(values) % num_chroma:
+        raise ValueError(f"{path}: score_chroma fehlt oder passt nicht zu {num_chroma} Bins")
+    onset = _c_array(content, "score_onset")
+    return dict(
+        name=name or _header_value(content, "SCORE_NAME", "name", path.stem),
+        chroma=np.array(values, dtype=np.float32).reshape(-1, num_chroma).T,
+        page_end_indices=[int(v) for v in _c_array(content, "page_end_indices")],
+        feature="cens" if cens else "stft",
+        onset=np.array(onset, dtype=np.float32) if onset else None,
+        sample_rate=_header_value(content, "SCORE_SAMPLE_RATE", "sample_rate", float(DEFAULT_SAMPLE_RATE)),
+        hop_length=_header_value(content, "SCORE_HOP_LENGTH", "hop_length", DEFAULT_HOP_LENGTH),
+        beat_frames=_header_value(content, "SCORE_FRAMES_PER_BEAT", "frames_per_beat", 1.0) if beat else None,
+    )
+
+
+def load_npz(path: Path, name: str = None, feature: str = "stft") -> dict:
+    """.npz aus write_score_data(); Feature-Typ steht nicht darin und kommt von --feature."""
+    data = np.load(path)
+    return dict(
+        name=name or path.stem,
+        chroma=data["chroma"],
+        page_end_indices=[int(v) for v in data["page_end_indices"]],
+        feature=feature,
+        onset=data["onset"] if "onset" in data else None,
+        sample_rate=DEFAULT_SAMPLE_RATE,
+        hop_length=DEFAULT_HOP_LENGTH,
+        beat_frames=float(data["beat_frames"]) if "beat_frames" in data else None,
+    )
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Partitur-Speicher (ScoreStore) verwalten.")
+    sub = parser.add_subparsers(dest="command", required=True)
+    add = sub.add_parser("add", help="Partitur eintragen oder ersetzen")
+    add.add_argument("store", help="Verzeichnis des Speichers")
+    add.add_argument("source", help="ScoreData.h, Bibliotheks-Header oder .npz")
+    add.add_argument("--name", default=None, help="Name im Speicher (Standard: SCORE_NAME bzw. Dateiname)")
+    add.add_argument("--feature", choices=["stft", "cens"], default="stft",
+                     help="Nur für .npz: Feature-Typ der Chroma-Daten")
+    lst = sub.add_parser("list", help="Inhalt anzeigen")
+    lst.add_argument("store")
+    rem = sub.add_parser("remove", help="Partitur entfernen")
+    rem.add_argument("store")
+    rem.add_argument("name")
+    args = parser.parse_args()
+
+    try:
+        if args.command == "add":
+            source = Path(args.source)
+            if source.suffix == ".npz":
+                score = load_npz(source, args.name, args.feature)
+            else:
+                score = load_header(source, args.name)
+            name = score.pop("name")
+            write_score_store(args.store, {name: score_to_bytes(name, **score)})
+        elif args.command == "remove":
+            write_score_store(args.store, {}, remove=[args.name])
+        else:
+            data_file, entries = read_score_store(args.store)
+            print(f"{args.store}: {len(entries)} Partitur(en) in {data_file or '-'}")
+            for e in entries:
+                flags = [f for f, bit in (("cens", FLAG_CENS), ("onset", FLAG_ONSET), ("beat", FLAG_BEAT_SYNC))
+                         if e["flags"] & bit]
+                print(f"  {e['name']:<32} {e['len']:>6} Frames  {e['num_chroma']:>2} Bins  "
+                      f"{e['size'] / 1024:>7.0f} KB  {' '.join(flags)}")
+    except (FileNotFoundError, ValueError) as e:
+        print(f"FEHLER: {e}")
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -21,6 +21,15 @@ SAMPLE_RATE = 44100
 FFT_SIZE = 4096
 HOP_LENGTH = 512
 
+# CENS-Parameter (müssen mit CENS.h auf dem Teensy übereinstimmen)
+CENS_THRESHOLDS = (0.4, 0.2, 0.1, 0.05)
+CENS_SMOOTH_SECONDS = 0.37   # Teensy: CENS_SMOOTH_LEN = 4 Frames à 4096 Samples
+
+# Onset-Spur: Teensy verarbeitet Blöcke von FFT_SIZE Samples ohne Überlappung,
+# der Spectral Flux vergleicht also Frames im Abstand von FFT_SIZE Samples.
+LIVE_FRAME_SAMPLES = FFT_SIZE
+ONSET_MIN_BIN = 4            # Teensy: Bins 0-3 (< 40 Hz) zählen nicht
+
 # Schwellwert für stille Frames (Pausen): untere X% der RMS-Werte → Rauschen
 RMS_SILENCE_PERCENTILE = 3
 
@@ -42,7 +51,9 @@ os.environ["PATH"] += os.pathsep + "/opt/homebrew/bin"
 def build_chroma(musicxml_path: str, bpm: int, instrument: str = "violin",
                  sample_rate: int = SAMPLE_RATE,
                  hop_length: int = HOP_LENGTH,
-                 wav_output_path: str = None) -> tuple[np.ndarray, list[int]]:
+                 wav_output_path: str = None,
+                 feature: str = "stft",
+                 n_chroma: int = 12) -> tuple[np.ndarray, list[int], np.ndarray]:
     """MusicXML → MIDI → FluidSynth → Chroma-Matrix + Seitenumbruch-Indizes.
 
     Args:
@@ -52,11 +63,15 @@ def build_chroma(musicxml_path: str, bpm: int, instrument: str = "violin",
         sample_rate: Samplerate (muss mit Live-System übereinstimmen).
         hop_length: Hop-Length (muss mit Live-System übereinstimmen).
         wav_output_path: Optionaler Pfad zum Speichern der synthetisierten WAV.
+        feature: "stft" (L2-normalisiertes chroma_stft) oder "cens"
+            (quantisiert + geglättet, passend zu CENSStage auf dem Teensy).
+        n_chroma: Chroma-Breite 12, 24 oder 36 (muss NUM_CHROMA der Firmware entsprechen).
 
     Returns:
-        (chroma, page_end_indices):
-            chroma: Shape (12, N), L2-normalisiert.
+        (chroma, page_end_indices, onset):
+            chroma: Shape (n_chroma, N), L2-normalisiert.
             page_end_indices: Liste der Frame-Indizes an Seitenenden.
+            onset: Shape (N,), relativer Spectral Flux wie AudioDSP::getOnset().
     """
     print(f"Lade {musicxml_path}...")
     score = music21.converter.parse(musicxml_path)
@@ -74,10 +89,10 @@ def build_chroma(musicxml_path: str, bpm: int, instrument: str = "violin",
     _set_tempo_and_instrument(part, score, bpm, midi_program)
 
     # Frames-per-Beat für Seitenumbrüche
-    frames_per_beat = (60.0 / bpm) * (sample_rate / hop_length)
+    beat_frames = frames_per_beat(bpm, sample_rate, hop_length)
 
     # Interaktive Seitenumbrüche (VOR Audio-Synthese, damit man die Partitur noch sieht)
-    page_indices = _get_interactive_page_turns(score, frames_per_beat)
+    page_indices = _get_interactive_page_turns(score, beat_frames)
 
     # MIDI exportieren → FluidSynth → WAV → Chroma
     with tempfile.TemporaryDirectory() as tmpdir:
@@ -119,9 +134,14 @@ def build_chroma(musicxml_path: str, bpm: int, instrument: str = "violin",
             print(f"  WAV gespeichert: {wav_output_path}")
 
         chroma_raw = librosa.feature.chroma_stft(
-            y=y, sr=sr, n_fft=FFT_SIZE, hop_length=hop_length, n_chroma=12
+            y=y, sr=sr, n_fft=FFT_SIZE, hop_length=hop_length, n_chroma=n_chroma
         )
 
+        # Onset-Spur aus dem gleichen Magnitudenspektrum
+        magnitudes = np.abs(librosa.stft(y, n_fft=FFT_SIZE, hop_length=hop_length))
+        onset = compute_onset(magnitudes, max(1, LIVE_FRAME_SAMPLES // hop_length))
+        onset = onset[:chroma_raw.shape[1]]
+
         # RMS-Energie pro Frame berechnen
         rms = librosa.feature.rms(y=y, frame_length=FFT_SIZE, hop_length=hop_length)[0]
         rms = rms[:chroma_raw.shape[1]]
@@ -133,15 +153,119 @@ def build_chroma(musicxml_path: str, bpm: int, instrument: str = "violin",
     n_silent = np.sum(silent_frames)
     print(f"  {n_silent} stille Frames mit Rauschen ersetzt ({n_silent / len(rms) * 100:.1f}%)")
 
-    # L2-Normalisierung pro Frame
-    norms = np.linalg.norm(chroma_raw, axis=0, keepdims=True)
-    norms[norms == 0] = 1
-    chroma = chroma_raw / norms
+    if feature == "cens":
+        smooth_frames = max(1, int(round(CENS_SMOOTH_SECONDS * sample_rate / hop_length)))
+        print(f"  CENS: Quantisierung + Glättung über {smooth_frames} Frames")
+        chroma = chroma_to_cens(chroma_raw, smooth_frames)
+    else:
+        # L2-Normalisierung pro Frame
+        norms = np.linalg.norm(chroma_raw, axis=0, keepdims=True)
+        norms[norms == 0] = 1
+        chroma = chroma_raw / norms
 
     num_frames = chroma.shape[1]
     print(f"  {num_frames} Frames, {len(page_indices)} Seitengrenzen")
 
-    return chroma, page_indices
+    return chroma, page_indices, onset
+
+
+def frames_per_beat(bpm: float, sample_rate: int = SAMPLE_RATE,
+                    hop_length: int = HOP_LENGTH) -> float:
+    """Chroma-Frames pro notiertem Schlag (Viertel) beim Synthese-Tempo."""
+    return (60.0 / bpm) * (sample_rate / hop_length)
+
+
+def beat_sync(chroma: np.ndarray, onset: np.ndarray, page_indices: list[int],
+              beat_frames: float) -> tuple[np.ndarray, np.ndarray, list[int]]:
+    """Fasst Frames zu notierten Schlägen zusammen (Gegenstück zu BeatAggregator).
+
+    Chroma wird pro Schlag gemittelt und L2-normalisiert, die Onset-Spur
+    nimmt das Maximum im Schlag. Seitenenden werden in Schläge umgerechnet.
+
+    Args:
+        chroma: Shape (n_chroma, N) im Frame-Raster.
+        onset: Shape (N,).
+        page_indices: Seitenenden als Frame-Indizes.
+        beat_frames: Frames pro Schlag (frames_per_beat()).
+
+    Returns:
+        (chroma, onset, page_indices) im Schlag-Raster.
+    """
+    num_frames = chroma.shape[1]
+    num_beats = int(np.ceil(num_frames / beat_frames))
+    bounds = np.round(np.arange(num_beats + 1) * beat_frames).astype(int)
+    bounds[-1] = num_frames
+
+    beat_chroma = np.zeros((chroma.shape[0], num_beats), dtype=chroma.dtype)
+    beat_onset = np.zeros(num_beats, dtype=np.float32)
+    for b in range(num_beats):
+        lo, hi = bounds[b], max(bounds[b + 1], bounds[b] + 1)
+        beat_chroma[:, b] = chroma[:, lo:hi].mean(axis=1)
+        beat_onset[b] = onset[lo:hi].max()
+
+    norms = np.linalg.norm(beat_chroma, axis=0, keepdims=True)
+    norms[norms == 0] = 1
+    beat_pages = [int(i / beat_frames) for i in page_indices]
+    print(f"  Schlag-Raster: {num_frames} Frames -> {num_beats} Schläge ({beat_frames:.1f} Frames/Schlag)")
+    return beat_chroma / norms, beat_onset, beat_pages
+
+
+def compute_onset(magnitudes: np.ndarray, lag: int) -> np.ndarray:
+    """Relativer Spectral Flux, identisch zu AudioDSP::calculateMagnitudes().
+
+    onset[t] = sum(max(0, S[:, t] - S[:, t - lag])) / sum(S[:, t])
+
+    Args:
+        magnitudes: Betragsspektrum, Shape (FFT_SIZE/2 + 1, N).
+        lag: Abstand der verglichenen Frames (Live-Blocklänge / Hop-Length).
+
+    Returns:
+        Shape (N,), Werte in [0, 1].
+    """
+    S = magnitudes[ONSET_MIN_BIN:FFT_SIZE // 2, :]
+    previous = np.pad(S, ((0, 0), (lag, 0)))[:, :S.shape[1]]
+    flux = np.maximum(S - previous, 0.0).sum(axis=0)
+    total = S.sum(axis=0)
+    total[total == 0] = 1
+    return (flux / total).astype(np.float32)
+
+
+def chroma_to_cens(chroma_raw: np.ndarray, smooth_frames: int) -> np.ndarray:
+    """CENS-Features, identisch zur inkrementellen CENSStage auf dem Teensy.
+
+    Anders als librosa.feature.chroma_cens wird KAUSAL geglättet (nur
+    vergangene Frames), damit Live- und Partitur-Features die gleiche
+    Verzögerung haben.
+
+    Args:
+        chroma_raw: Shape (n_chroma, N), beliebig skaliert.
+        smooth_frames: Länge des Glättungsfensters in Frames.
+
+    Returns:
+        Shape (n_chroma, N), L2-normalisiert.
+    """
+    # 1. L1-Normalisierung
+    sums = chroma_raw.sum(axis=0, keepdims=True)
+    sums[sums == 0] = 1
+    chroma_l1 = chroma_raw / sums
+
+    # 2. Quantisierung: Anzahl überschrittener Schwellen (0..4)
+    quantized = np.zeros_like(chroma_l1)
+    for threshold in CENS_THRESHOLDS:
+        quantized += (chroma_l1 > threshold)
+
+    # 3. Kausale Glättung mit Hann-Gewichten (ältester Frame zuerst)
+    n = np.arange(1, smooth_frames + 1)
+    weights = 0.5 * (1.0 - np.cos(2.0 * np.pi * n / (smooth_frames + 1)))
+    padded = np.pad(quantized, ((0, 0), (smooth_frames - 1, 0)))
+    smoothed = np.zeros_like(quantized)
+    for i, w in enumerate(weights):
+        smoothed += w * padded[:, i:i + quantized.shape[1]]
+
+    # 4. L2-Normalisierung
+    norms = np.linalg.norm(smoothed, axis=0, keepdims=True)
+    norms[norms == 0] = 1
+    return smoothed / norms
 
 
 def _remove_grace_notes(part):
@@ -1,30 +1,287 @@
 # =============================================================================
-# score_writer.py – Speichert ScoreData als .npz (NumPy-Archiv)
+# score_writer.py – Speichert ScoreData als .npz (NumPy-Archiv), ScoreData.h
+#                   oder im Binärformat für den Partitur-Speicher (ScoreStore.h)
 # =============================================================================
 
+import os
+import struct
+import time
+from pathlib import Path
+
 import numpy as np
 
 
 def write_score_data(filepath: str, chroma: np.ndarray, page_end_indices: list[int],
-                     metadata: str = ""):
+                     metadata: str = "", onset: np.ndarray = None,
+                     beat_frames: float = None):
     """Speichert Chroma-Daten als .npz Datei.
 
     Enthält:
         - chroma: Shape (12, N) – L2-normalisierte Chroma-Vektoren
         - page_end_indices: Frame-Indizes der Seitenenden
         - metadata: Beschreibungstext
+        - onset: Shape (N,) – Onset-Spur (optional)
+        - beat_frames: Frames pro Schlag (nur im Schlag-Raster)
 
     Args:
         filepath: Ausgabepfad (z.B. "ScoreData.npz").
         chroma: Shape (12, N) – L2-normalisierte Chroma-Vektoren.
         page_end_indices: Frame-Indizes der Seitenenden.
         metadata: Optionaler Beschreibungstext.
+        onset: Optionale Onset-Spur (relativer Spectral Flux).
+        beat_frames: Frames pro Schlag, falls beat-synchron aggregiert.
     """
-    np.savez(filepath,
-             chroma=chroma,
-             page_end_indices=np.array(page_end_indices, dtype=np.int32),
-             metadata=np.array(metadata))
+    arrays = dict(chroma=chroma,
+                  page_end_indices=np.array(page_end_indices, dtype=np.int32),
+                  metadata=np.array(metadata))
+    if onset is not None:
+        arrays["onset"] = onset
+    if beat_frames is not None:
+        arrays["beat_frames"] = np.float32(beat_frames)
+    np.savez(filepath, **arrays)
 
     num_frames = chroma.shape[1]
     print(f"ScoreData gespeichert: {filepath}")
     print(f"  {num_frames} Frames, {len(page_end_indices)} Seitengrenzen")
+
+
+def write_score_header(filepath: str, chroma: np.ndarray, page_end_indices: list[int],
+                       metadata: str = "", feature: str = "stft",
+                       onset: np.ndarray = None,
+                       sample_rate: int = 44100, hop_length: int = 512,
+                       beat_frames: float = None, name: str = "ScoreData",
+                       symbol: str = None):
+    """Speichert Chroma-Daten als ScoreData.h für die Teensy-Firmware.
+
+    Gleiches Format wie lib/ODTW/ScoreData.h. Bei feature="cens" wird
+    SCORE_FEATURE_CENS gesetzt, damit die Firmware die CENS-Stufe aktiviert.
+    Mit onset wird score_onset[] geschrieben und SCORE_HAS_ONSET gesetzt.
+    SCORE_SAMPLE_RATE/SCORE_HOP_LENGTH legen das Frame-Raster fest, auf das
+    die Firmware ihre Live-Frames umrechnet. Mit beat_frames liegen die Daten
+    im Schlag-Raster (SCORE_BEAT_SYNC, ein Eintrag pro Schlag).
+
+    Mit symbol entsteht eine zusätzliche Partitur für die Score-Bibliothek
+    (lib/ODTW/ScoreLibrary.h): alles liegt in namespace <symbol>, die
+    Eigenschaften stehen als Konstanten statt als #define darin.
+
+    Args:
+        filepath: Ausgabepfad (z.B. "ScoreData.h").
+        chroma: Shape (n_chroma, N) – normalisierte Chroma-Vektoren (12, 24 oder 36 Bins).
+        page_end_indices: Frame-Indizes der Seitenenden.
+        metadata: Optionaler Beschreibungstext (als Kommentar).
+        feature: "stft" oder "cens".
+        onset: Optionale Onset-Spur, Shape (N,).
+        sample_rate: Samplerate der Synthese in Hz.
+        hop_length: Hop der Chroma-Berechnung in Samples.
+        beat_frames: Frames pro Schlag, falls beat-synchron aggregiert.
+        name: Anzeigename für den Shell-Befehl "score".
+        symbol: C++-Bezeichner für eine Bibliotheks-Partitur (z.B. "fiocco").
+    """
+    num_frames = chroma.shape[1]
+    with open(filepath, "w") as f:
+        f.write(f"// {metadata}\n")
+        if symbol:
+            guard = f"SCORE_{symbol.upper()}_H"
+            f.write(f"#ifndef {guard}\n#define {guard}\n\n")
+            f.write(f"namespace {symbol} {{\n\n")
+            f.write(f"const char name[] = \"{name}\";\n")
+            f.write(f"const int num_chroma = {chroma.shape[0]};\n")
+            f.write(f"const bool feature_cens = {'true' if feature == 'cens' else 'false'};\n")
+            f.write(f"const bool has_onset = {'false' if onset is None else 'true'};\n")
+            f.write(f"const bool beat_sync = {'false' if beat_frames is None else 'true'};\n\n")
+        else:
+            _write_score_defines(f, chroma, feature, onset, sample_rate, hop_length, beat_frames, name)
+        _write_score_arrays(f, chroma, page_end_indices, onset)
+        if symbol:
+            onset_ptr = "nullptr" if onset is None else "score_onset"
+            f.write(f"const float* const onset_track = {onset_ptr};\n\n")
+            f.write(f"}}  // namespace {symbol}\n\n")
+        f.write("#endif\n")
+
+    print(f"ScoreData.h gespeichert: {filepath}")
+
+
+def _write_score_defines(f, chroma, feature, onset, sample_rate, hop_length, beat_frames, name):
+    """#defines der Haupt-Partitur (steuern den Firmware-Pfad zur Compile-Zeit)."""
+    f.write("#ifndef SCORE_DATA_H\n#define SCORE_DATA_H\n\n")
+    f.write(f"#define SCORE_NAME \"{name}\"\n")
+    f.write(f"#define SCORE_NUM_CHROMA {chroma.shape[0]}\n")
+    f.write(f"#define SCORE_FEATURE_CENS {1 if feature == 'cens' else 0}\n")
+    f.write(f"#define SCORE_HAS_ONSET {0 if onset is None else 1}\n")
+    f.write(f"#define SCORE_SAMPLE_RATE {float(sample_rate):.1f}f\n")
+    f.write(f"#define SCORE_HOP_LENGTH {hop_length}\n")
+    if beat_frames is not None:
+        f.write("#define SCORE_BEAT_SYNC 1\n")
+        f.write(f"#define SCORE_FRAMES_PER_BEAT {beat_frames:.4f}f\n")
+    f.write("\n")
+
+
+def _write_score_arrays(f, chroma, page_end_indices, onset):
+    """Seitenenden, Chroma-Matrix und optionale Onset-Spur als C-Arrays."""
+    num_frames = chroma.shape[1]
+    f.write(f"const int num_pages = {len(page_end_indices)};\n")
+    arr_content = ", ".join(map(str, page_end_indices))
+    f.write(f"const int page_end_indices[] = {{ {arr_content} }};\n\n")
+    f.write(f"const int score_len = {num_frames};\n")
+    f.write(f"const float score_chroma[][{chroma.shape[0]}] = {{\n")
+    rows = []
+    for i in range(num_frames):
+        rows.append("  {" + ", ".join(f"{v:.4f}f" for v in chroma[:, i]) + "}")
+    f.write(",\n".join(rows))
+    f.write("\n};\n\n")
+    if onset is not None:
+        f.write("const float score_onset[] = {\n")
+        for start in range(0, num_frames, 12):
+            f.write("  " + ", ".join(f"{v:.4f}f" for v in onset[start:start + 12]))
+            f.write(",\n" if start + 12 < num_frames else "\n")
+        f.write("};\n\n")
+
+
+# =============================================================================
+# Binärformat + Partitur-Speicher (lib/ODTW/ScoreStore.h)
+# =============================================================================
+# Ein Speicher ist ein Verzeichnis mit index.spti und einer Datendatei scores-<gen>.spts.
+# Host-Prozesse blenden beides per mmap ein und teilen sich die Seiten. Layout und
+# Konstanten müssen zu ScoreStore.h passen (static_assert auf die Strukturgrößen dort).
+
+STORE_INDEX = "index.spti"
+STORE_VERSION = 1
+STORE_ALIGN = 64
+STORE_KEEP_GENERATIONS = 2   # Vorige Datendateien, die nach dem Umschalten liegen bleiben
+FLAG_CENS = 0x01
+FLAG_ONSET = 0x02
+FLAG_BEAT_SYNC = 0x04
+
+# ScoreFileHeader (128 Bytes), ScoreIndexHeader (64), ScoreIndexEntry (96)
+_FILE_HEADER = struct.Struct("<4s5I f I f 4I 3I 64s")
+_INDEX_HEADER = struct.Struct("<4s3I48s")
+_INDEX_ENTRY = struct.Struct("<64sQQ4I")
+
+
+def _align(n: int) -> int:
+    return (n + STORE_ALIGN - 1) // STORE_ALIGN * STORE_ALIGN
+
+
+def score_to_bytes(name: str, chroma: np.ndarray, page_end_indices: list[int],
+                   feature: str = "stft", onset: np.ndarray = None,
+                   sample_rate: int = 44100, hop_length: int = 512,
+                   beat_frames: float = None) -> bytes:
+    """Eine Partitur im Binärformat (ScoreFileHeader + Abschnitte, auf 64 Byte ausgerichtet).
+
+    Die Chroma-Matrix liegt zeilenweise (Frame für Frame) wie score_chroma[][N] in
+    ScoreData.h, dazu die Magnituden |chroma[i]|, die DTWTracker sonst beim Start rechnet.
+
+    Args:
+        name: Anzeigename (höchstens 63 Bytes UTF-8).
+        chroma: Shape (n_chroma, N).
+        page_end_indices, feature, onset, sample_rate, hop_length, beat_frames:
+            wie write_score_header().
+    """
+    rows = np.ascontiguousarray(chroma.T, dtype=np.float32)
+    num_frames, num_chroma = rows.shape
+    # float32 wie im Tracker: sqrt(Summe der Quadrate)
+    magnitudes = np.sqrt(np.einsum("ij,ij->i", rows, rows, dtype=np.float32)).astype(np.float32)
+    pages = np.asarray(page_end_indices, dtype="<i4")
+
+    flags = 0
+    if feature == "cens":
+        flags |= FLAG_CENS
+    if onset is not None:
+        flags |= FLAG_ONSET
+    if beat_frames is not None:
+        flags |= FLAG_BEAT_SYNC
+
+    chroma_offset = _align(_FILE_HEADER.size)
+    magnitude_offset = _align(chroma_offset + rows.nbytes)
+    onset_offset = _align(magnitude_offset + magnitudes.nbytes) if onset is not None else 0
+    pages_offset = _align((onset_offset or magnitude_offset) + num_frames * 4)
+    size = _align(pages_offset + pages.nbytes)
+
+    encoded = name.encode("utf-8")
+    if len(encoded) >= 64:
+        raise ValueError(f"Name zu lang (max. 63 Bytes): {name}")
+
+    out = bytearray(size)
+    _FILE_HEADER.pack_into(out, 0, b"SPTS", STORE_VERSION, num_chroma, num_frames, len(pages), flags,
+                           float(sample_rate), hop_length, float(beat_frames or 0.0),
+                           chroma_offset, magnitude_offset, onset_offset, pages_offset,
+                           0, 0, 0, encoded)
+    out[chroma_offset:chroma_offset + rows.nbytes] = rows.astype("<f4").tobytes()
+    out[magnitude_offset:magnitude_offset + magnitudes.nbytes] = magnitudes.astype("<f4").tobytes()
+    if onset is not None:
+        out[onset_offset:onset_offset + num_frames * 4] = np.asarray(onset, dtype="<f4").tobytes()
+    out[pages_offset:pages_offset + pages.nbytes] = pages.tobytes()
+    return bytes(out)
+
+
+def read_score_store(store_dir: str) -> tuple[str, list[dict]]:
+    """Index eines Speichers lesen: (Name der Datendatei, Einträge).
+
+    Einträge: dict mit name, offset, size, len, num_chroma, flags.
+    Ein fehlendes Verzeichnis oder fehlender Index gilt als leerer Speicher.
+    """
+    index_path = Path(store_dir) / STORE_INDEX
+    if not index_path.exists():
+        return "", []
+    raw = index_path.read_bytes()
+    magic, version, count, _, data_file = _INDEX_HEADER.unpack_from(raw, 0)
+    if magic != b"SPTI" or version != STORE_VERSION:
+        raise ValueError(f"{index_path}: kein Partitur-Index (Version {STORE_VERSION})")
+    entries = []
+    for i in range(count):
+        name, offset, size, length, num_chroma, flags, _ = _INDEX_ENTRY.unpack_from(
+            raw, _INDEX_HEADER.size + i * _INDEX_ENTRY.size)
+        entries.append(dict(name=name.rstrip(b"\0").decode("utf-8"), offset=offset, size=size,
+                            len=length, num_chroma=num_chroma, flags=flags))
+    return data_file.rstrip(b"\0").decode("ascii"), entries
+
+
+def write_score_store(store_dir: str, records: dict[str, bytes], remove: list[str] = ()):
+    """Partituren in einen Speicher eintragen (gleicher Name = ersetzen) bzw. entfernen.
+
+    Schreibt eine neue Datendatei unter neuem Namen und ersetzt dann index.spti atomar
+    per os.replace(). Laufende Prozesse behalten ihre Abbildung. Die letzten
+    STORE_KEEP_GENERATIONS Datendateien bleiben liegen, damit ein Leser, der einen
+    älteren Index schon gelesen, seine Datendatei aber noch nicht geöffnet hat, sie
+    noch findet (ScoreStore::open liest sonst den Index neu); ältere werden gelöscht.
+
+    Args:
+        store_dir: Verzeichnis des Speichers (wird angelegt).
+        records: Name -> score_to_bytes(...).
+        remove: Namen, die entfernt werden sollen.
+    """
+    store = Path(store_dir)
+    store.mkdir(parents=True, exist_ok=True)
+    old_data, entries = read_score_store(store_dir)
+
+    # Bestehende Partituren übernehmen, soweit nicht ersetzt oder entfernt
+    merged = {}
+    if old_data:
+        data = (store / old_data).read_bytes()
+        for e in entries:
+            merged[e["name"]] = data[e["offset"]:e["offset"] + e["size"]]
+    for name in remove:
+        merged.pop(name, None)
+    merged.update(records)
+
+    generation = time.strftime("%Y%m%d%H%M%S") + f"-{os.getpid()}"
+    data_file = f"scores-{generation}.spts"
+    index = bytearray(_INDEX_HEADER.pack(b"SPTI", STORE_VERSION, len(merged), 0, data_file.encode("ascii")))
+    offset = 0
+    with open(store / (data_file + ".tmp"), "wb") as f:
+        for name, record in merged.items():
+            _, _, num_chroma, length, _, flags = struct.unpack_from("<4s5I", record, 0)
+            index += _INDEX_ENTRY.pack(name.encode("utf-8"), offset, len(record), length, num_chroma, flags, 0)
+            f.write(record)
+            offset += len(record)
+    os.replace(store / (data_file + ".tmp"), store / data_file)
+    with open(store / (STORE_INDEX + ".tmp"), "wb") as f:
+        f.write(index)
+    os.replace(store / (STORE_INDEX + ".tmp"), store / STORE_INDEX)
+
+    previous = sorted((p for p in store.glob("scores-*.spts") if p.name != data_file),
+                      key=lambda p: p.stat().st_mtime_ns, reverse=True)
+    for old in previous[STORE_KEEP_GENERATIONS:]:
+        old.unlink(missing_ok=True)
+
+    print(f"Partitur-Speicher {store}: {len(merged)} Partitur(en), {offset / 1024:.0f} KB")
@@ -0,0 +1,87 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Host-Shim für Arduino.h: erlaubt es, AudioDSP und ODTW unverändert auf
+// Linux/macOS zu bauen (env:native_* in platformio.ini). Nur das, was die
+// Libraries wirklich benutzen. Serial -> stdout, Serial1 (ESP32) -> stdout mit Präfix.
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <chrono>
+#include <thread>
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+#define DMAMEM               // Teensy: RAM2/OCRAM (.dmabuffers), hier normaler Speicher
+
+using std::abs;
+
+class HostSerial {
+public:
+    explicit HostSerial(const char* prefix = "") : prefix(prefix) {}
+
+    void begin(unsigned long) {}
+    int available() { return 0; }
+    int read() { return -1; }
+    void flush() { fflush(stdout); }
+    explicit operator bool() const { return true; }
+
+    size_t write(uint8_t c) { emit("%c", (char)c); return 1; }
+    size_t write(const uint8_t* data, size_t len) { for (size_t i = 0; i < len; i++) write(data[i]); return len; }
+
+    void print(const char* s) { emit("%s", s); }
+    void print(char c) { emit("%c", c); }
+    void print(int v) { emit("%d", v); }
+    void print(unsigned int v) { emit("%u", v); }
+    void print(long v) { emit("%ld", v); }
+    void print(unsigned long v) { emit("%lu", v); }
+    void print(double v, int digits = 2) { emit("%.*f", digits, v); }
+
+    template <typename T> void println(T v) { print(v); print('\n'); }
+    void println(double v, int digits) { print(v, digits); print('\n'); }
+    void println() { print('\n'); }
+
+    bool quiet = false;      // Replay-Tools können die Ausgabe abschalten
+
+private:
+    const char* prefix;
+    bool lineStart = true;
+
+    template <typename... Args>
+    void emit(const char* fmt, Args... args) {
+        if (quiet) return;
+        if (lineStart && prefix[0]) fputs(prefix, stdout);
+        char buf[128];
+        snprintf(buf, sizeof(buf), fmt, args...);
+        fputs(buf, stdout);
+        lineStart = buf[0] && buf[strlen(buf) - 1] == '\n';
+    }
+};
+
+inline HostSerial Serial;
+inline HostSerial Serial1("[Serial1] ");
+
+inline uint64_t hostStartMicros() {
+    static const auto start = std::chrono::steady_clock::now();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+inline unsigned long micros() { return (unsigned long)hostStartMicros(); }
+inline unsigned long millis() { return (unsigned long)(hostStartMicros() / 1000); }
+inline void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+// Takt: PowerManager stellt ihn per set_arm_clock() um, auf dem Host nur als Zahl
+inline uint32_t F_CPU_ACTUAL = 600000000UL;
+inline uint32_t set_arm_clock(uint32_t frequency) { F_CPU_ACTUAL = frequency; return frequency; }
+
+inline void randomSeed(unsigned long seed) { srand((unsigned)seed); }
+inline long random(long max) { return max > 0 ? rand() % max : 0; }
+inline long random(long min, long max) { return max > min ? min + rand() % (max - min) : min; }
+
+#endif
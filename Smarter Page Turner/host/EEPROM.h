@@ -0,0 +1,36 @@
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+// Host-Shim für EEPROM.h: 4284 Bytes im RAM (Größe wie Teensy 4.1), gelöscht = 0xFF.
+// Inhalt geht beim Beenden verloren; für Tests reicht das.
+
+#include <stdint.h>
+#include <string.h>
+
+#define E2END 4283
+
+class HostEEPROM {
+public:
+    HostEEPROM() { memset(data, 0xFF, sizeof(data)); }
+
+    uint8_t read(int idx) const { return data[idx]; }
+    void write(int idx, uint8_t val) { data[idx] = val; writes++; }
+    void update(int idx, uint8_t val) { if (data[idx] != val) write(idx, val); }
+    uint16_t length() const { return E2END + 1; }
+
+    template <typename T> T& get(int idx, T& t) const { memcpy(&t, data + idx, sizeof(T)); return t; }
+    template <typename T> const T& put(int idx, const T& t) {
+        const uint8_t* p = (const uint8_t*)&t;
+        for (size_t i = 0; i < sizeof(T); i++) update(idx + (int)i, p[i]);
+        return t;
+    }
+
+    uint32_t writes = 0;     // Geschriebene Bytes (Verschleiß-Abschätzung in Tests)
+
+private:
+    uint8_t data[E2END + 1];
+};
+
+inline HostEEPROM EEPROM;
+
+#endif
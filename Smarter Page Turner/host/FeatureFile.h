@@ -0,0 +1,121 @@
+#ifndef HOST_FEATURE_FILE_H
+#define HOST_FEATURE_FILE_H
+
+// Feature-Datei für den Feature-Cache der Auswertung (ODTW_Python/feature_cache.py, host_features):
+// die Ausgabe der DSP-Kette einer Aufnahme, Frame für Frame, so abgelegt, dass Python sie per
+// np.memmap ohne Kopie einblenden kann. Little-endian, alle Abschnitte auf 64 Byte ausgerichtet:
+//   Kopf (128 B) | flags uint8[frames] | volume f32[frames] | snr f32[frames] | onset f32[frames] |
+//   chroma [frames][num_chroma] als f32 oder uint8 (Wert = q * chroma_scale)
+// Chroma ist die Ausgabe von AudioDSP (vor CENS), in Frames ohne FEATURE_ACTIVE steht 0.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#define FEATURE_FILE_VERSION 1
+#define FEATURE_FILE_ALIGN 64
+#define FEATURE_DSP_VERSION 1        // Erhöhen, wenn sich die Features bei gleichen Parametern ändern (Cache-Schlüssel)
+
+enum FeatureDtype : uint32_t {
+    FEATURE_DTYPE_F32 = 0,
+    FEATURE_DTYPE_U8 = 1
+};
+
+struct FeatureFileHeader {
+    char magic[4];              // "SPTF"
+    uint32_t version;
+    uint32_t num_chroma;
+    uint32_t frames;
+    uint32_t chroma_dtype;      // FeatureDtype
+    float sample_rate;          // Rate der Samples am DSP-Eingang
+    uint32_t frame_samples;     // Samples pro Frame (FFT_SIZE bzw. Hop)
+    float chroma_scale;         // Nur FEATURE_DTYPE_U8
+    uint32_t flags_offset;      // Offsets relativ zum Dateianfang
+    uint32_t volume_offset;
+    uint32_t snr_offset;
+    uint32_t onset_offset;
+    uint32_t chroma_offset;
+    uint32_t reserved[3];
+    char params[64];            // DSP-Parameter (Teil des Cache-Schlüssels), nullterminiert
+};
+static_assert(sizeof(FeatureFileHeader) == 128, "FeatureFileHeader: Layout muss zu feature_cache.py passen");
+
+// Sammelt die Frames einer Aufnahme und schreibt sie am Ende in einem Rutsch
+struct FeatureFileWriter {
+    int numChroma = 0;
+    std::vector<uint8_t> flags;
+    std::vector<float> volume, snr, onset, chroma;
+
+    void add(uint8_t f, float vol, float s, float on, const float* c) {
+        flags.push_back(f);
+        volume.push_back(vol);
+        snr.push_back(s);
+        onset.push_back(on);
+        for (int i = 0; i < numChroma; i++) chroma.push_back(c ? c[i] : 0.0f);
+    }
+
+    // quantize: Chroma als uint8 mit einem Maßstab für die ganze Datei (Maximum -> 255)
+    bool write(const char* path, float sampleRate, int frameSamples, const char* params, bool quantize) const {
+        FeatureFileHeader h;
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, "SPTF", 4);
+        h.version = FEATURE_FILE_VERSION;
+        h.num_chroma = numChroma;
+        h.frames = (uint32_t)flags.size();
+        h.chroma_dtype = quantize ? FEATURE_DTYPE_U8 : FEATURE_DTYPE_F32;
+        h.sample_rate = sampleRate;
+        h.frame_samples = frameSamples;
+        strncpy(h.params, params, sizeof(h.params) - 1);
+
+        uint32_t pos = sizeof(h);
+        h.flags_offset = place(pos, h.frames);
+        h.volume_offset = place(pos, h.frames * sizeof(float));
+        h.snr_offset = place(pos, h.frames * sizeof(float));
+        h.onset_offset = place(pos, h.frames * sizeof(float));
+        h.chroma_offset = place(pos, chroma.size() * (quantize ? 1 : sizeof(float)));
+
+        std::vector<uint8_t> q;
+        if (quantize) {
+            float peak = 0.0f;
+            for (float v : chroma) peak = v > peak ? v : peak;
+            h.chroma_scale = peak > 0.0f ? peak / 255.0f : 1.0f / 255.0f;
+            q.resize(chroma.size());
+            for (size_t i = 0; i < chroma.size(); i++) {
+                float v = roundf(chroma[i] / h.chroma_scale);
+                q[i] = (uint8_t)(v < 0.0f ? 0.0f : (v > 255.0f ? 255.0f : v));
+            }
+        }
+
+        FILE* f = fopen(path, "wb");
+        if (!f) return false;
+        bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+        ok = ok && section(f, h.flags_offset, flags.data(), flags.size());
+        ok = ok && section(f, h.volume_offset, volume.data(), volume.size() * sizeof(float));
+        ok = ok && section(f, h.snr_offset, snr.data(), snr.size() * sizeof(float));
+        ok = ok && section(f, h.onset_offset, onset.data(), onset.size() * sizeof(float));
+        if (quantize) ok = ok && section(f, h.chroma_offset, q.data(), q.size());
+        else ok = ok && section(f, h.chroma_offset, chroma.data(), chroma.size() * sizeof(float));
+        return (fclose(f) == 0) && ok;
+    }
+
+private:
+    // Nächsten ausgerichteten Offset vergeben
+    static uint32_t place(uint32_t& pos, size_t bytes) {
+        uint32_t at = (pos + FEATURE_FILE_ALIGN - 1) / FEATURE_FILE_ALIGN * FEATURE_FILE_ALIGN;
+        pos = at + (uint32_t)bytes;
+        return at;
+    }
+
+    // Bis offset mit Nullen auffüllen, dann die Daten
+    static bool section(FILE* f, uint32_t offset, const void* data, size_t bytes) {
+        static const uint8_t zeros[FEATURE_FILE_ALIGN] = {0};
+        long at = ftell(f);
+        if (at < 0 || (uint32_t)at > offset) return false;
+        if (offset > (uint32_t)at && fwrite(zeros, 1, offset - at, f) != offset - (uint32_t)at) return false;
+        return bytes == 0 || fwrite(data, 1, bytes, f) == bytes;
+    }
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef HOST_SD_H
+#define HOST_SD_H
+
+// Host-Shim für SD.h: Dateien landen im aktuellen Verzeichnis. Nur was CaptureWriter braucht.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#define BUILTIN_SDCARD 254
+#define FILE_READ 0
+#define FILE_WRITE 1
+#define FILE_WRITE_BEGIN 2
+
+class File {
+public:
+    File() = default;
+    explicit File(FILE* f) : f(f) {}
+
+    size_t write(const uint8_t* data, size_t len) { return f ? fwrite(data, 1, len, f) : 0; }
+    int read(void* data, size_t len) { return f ? (int)fread(data, 1, len, f) : -1; }
+    bool seek(uint64_t pos) { return f && fseek(f, (long)pos, SEEK_SET) == 0; }
+    uint64_t size() {
+        if (!f) return 0;
+        long pos = ftell(f);
+        fseek(f, 0, SEEK_END);
+        long end = ftell(f);
+        fseek(f, pos, SEEK_SET);
+        return (uint64_t)end;
+    }
+    void flush() { if (f) fflush(f); }
+    void close() {
+        if (f) fclose(f);
+        f = nullptr;
+    }
+    explicit operator bool() const { return f != nullptr; }
+
+private:
+    FILE* f = nullptr;
+};
+
+class SDClass {
+public:
+    bool begin(uint8_t) { return true; }
+    bool exists(const char* path) { return access(path, F_OK) == 0; }
+    bool remove(const char* path) { return ::remove(path) == 0; }
+    File open(const char* path, uint8_t mode = FILE_READ) {
+        // FILE_WRITE hängt an (wie auf dem Teensy), FILE_WRITE_BEGIN überschreibt ab Anfang
+        const char* m = (mode == FILE_READ) ? "rb" : (mode == FILE_WRITE) ? "ab+" : "wb+";
+        return File(fopen(path, m));
+    }
+};
+
+inline SDClass SD;
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef HOST_WAV_FILE_H
+#define HOST_WAV_FILE_H
+
+// WAV-Dateien für die Host-Programme (host_replay, host_server)
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+// Minimaler WAV-Leser: sucht "fmt " und "data", akzeptiert nur PCM16
+inline bool readWav(const char* path, std::vector<int16_t>& mono, float& rate) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+
+    char riff[12];
+    if (fread(riff, 1, 12, f) != 12 || memcmp(riff, "RIFF", 4) || memcmp(riff + 8, "WAVE", 4)) {
+        fclose(f);
+        return false;
+    }
+
+    int channels = 0, bits = 0;
+    char id[4];
+    uint32_t size;
+    while (fread(id, 1, 4, f) == 4 && fread(&size, 4, 1, f) == 1) {
+        if (!memcmp(id, "fmt ", 4)) {
+            uint8_t fmt[16];
+            if (size < 16 || fread(fmt, 1, 16, f) != 16) break;
+            channels = fmt[2] | (fmt[3] << 8);
+            rate = (float)(fmt[4] | (fmt[5] << 8) | (fmt[6] << 16) | ((uint32_t)fmt[7] << 24));
+            bits = fmt[14] | (fmt[15] << 8);
+            fseek(f, size - 16 + (size & 1), SEEK_CUR);
+        } else if (!memcmp(id, "data", 4)) {
+            if (bits != 16 || channels < 1) break;
+            std::vector<int16_t> raw(size / 2);
+            size_t n = fread(raw.data(), 2, raw.size(), f);
+            mono.resize(n / channels);
+            // Mehrkanalig -> erster Kanal (wie AudioInputI2S Kanal 0)
+            for (size_t i = 0; i < mono.size(); i++) mono[i] = raw[i * channels];
+            fclose(f);
+            return true;
+        } else {
+            fseek(f, size + (size & 1), SEEK_CUR);
+        }
+    }
+    fclose(f);
+    return false;
+}
+
+#endif
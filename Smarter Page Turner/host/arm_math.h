@@ -0,0 +1,78 @@
+#ifndef HOST_ARM_MATH_H
+#define HOST_ARM_MATH_H
+
+// Host-Shim für CMSIS-DSP: nur die Funktionen, die AudioDSP benutzt.
+// arm_rfft_fast_f32 liefert dasselbe gepackte Format wie auf dem Teensy:
+//   out[0] = Re(X0), out[1] = Re(X[N/2]), out[2k] = Re(Xk), out[2k+1] = Im(Xk)
+
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+
+typedef float float32_t;
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+
+struct arm_rfft_fast_instance_f32 {
+    uint16_t fftLenRFFT = 0;
+    std::vector<float> cosTable;
+    std::vector<float> sinTable;
+    std::vector<uint32_t> bitReverse;
+    std::vector<double> re, im;
+};
+
+inline int arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32* S, uint16_t fftLen) {
+    S->fftLenRFFT = fftLen;
+    S->cosTable.resize(fftLen / 2);
+    S->sinTable.resize(fftLen / 2);
+    for (uint32_t k = 0; k < fftLen / 2; k++) {
+        S->cosTable[k] = (float)cos(2.0 * M_PI * k / fftLen);
+        S->sinTable[k] = (float)sin(2.0 * M_PI * k / fftLen);
+    }
+    int bits = 0;
+    while ((1u << bits) < fftLen) bits++;
+    S->bitReverse.resize(fftLen);
+    for (uint32_t i = 0; i < fftLen; i++) {
+        uint32_t r = 0;
+        for (int b = 0; b < bits; b++) if (i & (1u << b)) r |= 1u << (bits - 1 - b);
+        S->bitReverse[i] = r;
+    }
+    S->re.resize(fftLen);
+    S->im.resize(fftLen);
+    return 0;
+}
+
+// Komplexe Radix-2 FFT über das reelle Signal (langsamer als CMSIS, aber exakt genug)
+inline void arm_rfft_fast_f32(arm_rfft_fast_instance_f32* S, float32_t* p, float32_t* pOut, uint8_t ifftFlag) {
+    (void)ifftFlag;
+    const uint32_t n = S->fftLenRFFT;
+    std::vector<double>& re = S->re;
+    std::vector<double>& im = S->im;
+    for (uint32_t i = 0; i < n; i++) {
+        re[S->bitReverse[i]] = p[i];
+        im[S->bitReverse[i]] = 0.0;
+    }
+    for (uint32_t size = 2; size <= n; size <<= 1) {
+        uint32_t half = size / 2;
+        uint32_t step = n / size;
+        for (uint32_t start = 0; start < n; start += size) {
+            for (uint32_t k = 0; k < half; k++) {
+                double wr = S->cosTable[k * step];
+                double wi = -S->sinTable[k * step];
+                uint32_t a = start + k, b = a + half;
+                double tr = re[b] * wr - im[b] * wi;
+                double ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr; im[b] = im[a] - ti;
+                re[a] += tr; im[a] += ti;
+            }
+        }
+    }
+    pOut[0] = (float)re[0];
+    pOut[1] = (float)re[n / 2];
+    for (uint32_t k = 1; k < n / 2; k++) {
+        pOut[2 * k] = (float)re[k];
+        pOut[2 * k + 1] = (float)im[k];
+    }
+}
+
+#endif
@@ -0,0 +1,55 @@
+#include "AGC.h"
+
+void BlockAGC::init(float sampleRate) {
+    // Zeitkonstanten -> Glättungsfaktor pro Block: 1 - exp(-T_block / tau)
+    float blockMs = 1000.0f * AGC_BLOCK_SIZE / sampleRate;
+    attackCoef = (int32_t)(32768.0f * (1.0f - expf(-blockMs / AGC_ATTACK_MS)));
+    releaseCoef = (int32_t)(32768.0f * (1.0f - expf(-blockMs / AGC_RELEASE_MS)));
+    if (releaseCoef < 1) releaseCoef = 1;
+
+    minGain = (int32_t)(AGC_MIN_GAIN * 32768.0f);
+    maxGain = (int32_t)(AGC_MAX_GAIN * 32768.0f);
+    reset();
+}
+
+void BlockAGC::reset() {
+    gain = 32768;
+    envelope = 0;
+}
+
+float BlockAGC::getGainDb() const {
+    return 20.0f * log10f(gain / 32768.0f);
+}
+
+void BlockAGC::process(int16_t* block, int length) {
+    // 1. Spitzenwert des Eingangsblocks
+    int32_t peak = 0;
+    for (int i = 0; i < length; i++) {
+        int32_t a = block[i] < 0 ? -(int32_t)block[i] : block[i];
+        if (a > peak) peak = a;
+    }
+
+    // 2. Hüllkurve mit Attack/Release (Q15-Koeffizient)
+    int32_t coef = (peak > envelope) ? attackCoef : releaseCoef;
+    envelope += ((peak - envelope) * coef) >> 15;
+
+    // 3. Ziel-Verstärkung; in Pausen einfrieren, sonst wird Rauschen hochgezogen
+    int32_t target = gain;
+    if (envelope >= AGC_GATE_LEVEL) {
+        target = ((int32_t)AGC_TARGET_LEVEL << 15) / envelope;
+        if (target < minGain) target = minGain;
+        if (target > maxGain) target = maxGain;
+    }
+
+    // 4. Verstärkung über den Block rampen und anwenden (mit Sättigung)
+    int32_t stepQ = (target - gain) / length;
+    int32_t g = gain;
+    for (int i = 0; i < length; i++) {
+        g += stepQ;
+        int32_t y = (int32_t)(((int64_t)block[i] * g) >> 15);
+        if (y > 32767) y = 32767;
+        else if (y < -32768) y = -32768;
+        block[i] = (int16_t)y;
+    }
+    gain = target;
+}
@@ -0,0 +1,40 @@
+#ifndef AGC_H
+#define AGC_H
+
+#include <Arduino.h>
+
+// Konfiguration (Pegel als int16-Spitzenwert, Verstärkung als Q15: 32768 = 1.0)
+#define AGC_BLOCK_SIZE 128        // Blockgröße der AudioRecordQueue
+#define AGC_TARGET_LEVEL 8192     // Ziel-Spitzenpegel ~ -12 dBFS, Reserve für Transienten
+#define AGC_GATE_LEVEL 300        // Darunter (Pause/Rauschen) wird die Verstärkung eingefroren
+#define AGC_MAX_GAIN 16.0f        // +24 dB für leise Instrumente / großen Abstand
+#define AGC_MIN_GAIN 0.25f        // -12 dB für sehr laute Quellen direkt am Mikrofon
+#define AGC_ATTACK_MS 5.0f        // Hüllkurve steigt schnell (Anschlag nicht übersteuern)
+#define AGC_RELEASE_MS 800.0f     // ... und fällt langsam (kein Pumpen zwischen Noten)
+
+// Blockweise automatische Verstärkungsregelung vor der FFT, komplett in Festkomma.
+// Pro 128er-Block: Spitzenwert -> Hüllkurve (Attack/Release) -> Ziel-Verstärkung,
+// die innerhalb des Blocks linear angefahren wird (keine Sprünge an Blockgrenzen).
+// Kosten: 1 Multiplikation + Sättigung pro Sample, 1 Division pro Block.
+class BlockAGC {
+public:
+    void init(float sampleRate);
+    void reset();
+
+    // Regelt den Block in place
+    void process(int16_t* block, int length);
+
+    float getGain() const { return gain / 32768.0f; }
+    float getGainDb() const;
+    int16_t getEnvelope() const { return (int16_t)envelope; }
+
+private:
+    int32_t gain = 32768;         // Aktuelle Verstärkung, Q15
+    int32_t envelope = 0;         // Spitzenpegel-Hüllkurve, int16-Skala
+    int32_t attackCoef = 0;       // Q15, pro Block
+    int32_t releaseCoef = 0;      // Q15, pro Block
+    int32_t minGain = 0;          // Q15
+    int32_t maxGain = 0;          // Q15
+};
+
+#endif
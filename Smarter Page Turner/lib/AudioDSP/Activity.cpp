@@ -0,0 +1,63 @@
+#include "Activity.h"
+
+void ActivityDetector::reset() {
+    state = SILENT;
+    hangover = 0;
+    pending = false;
+    noiseLevel = VAD_NOISE_INIT;
+    lastVolume = 0.0f;
+}
+
+float ActivityDetector::measure(const int16_t* audioData, int length) {
+    int32_t sum = 0;
+    for (int i = 0; i < length; i++) sum += abs(audioData[i]);
+    return (float)sum / length;
+}
+
+bool ActivityDetector::gate(float volume) {
+    // Hysterese: Einschalten erst über VAD_ON_FACTOR, Ausschalten erst unter VAD_OFF_FACTOR
+    float threshold = (state == SILENT) ? VAD_ON_FACTOR * noiseLevel : VAD_OFF_FACTOR * noiseLevel;
+    if (threshold < VAD_MIN_LEVEL) threshold = VAD_MIN_LEVEL;
+
+    lastVolume = volume;
+    if (volume > threshold) {
+        // Laut genug -> FFT nötig, Entscheidung fällt in confirm()
+        pending = true;
+        return true;
+    }
+
+    pending = false;
+    trackNoise(volume, state == SILENT);
+    advance(false);
+    return state != SILENT;
+}
+
+bool ActivityDetector::confirm(float flatness) {
+    // Hangover-Frame: Zustand wurde schon in gate() fortgeschrieben
+    if (!pending) return state != SILENT;
+
+    pending = false;
+    bool voiced = flatness <= VAD_MAX_FLATNESS;
+    // Lautes Rauschen (Lüftung, Publikum) darf den Rauschpegel anheben
+    if (!voiced) trackNoise(lastVolume, true);
+    advance(voiced);
+    return state != SILENT;
+}
+
+// Minimum Statistics auf Frame-Ebene: fallen immer, steigen nur bei Stille/Rauschen
+void ActivityDetector::trackNoise(float volume, bool allowRise) {
+    float diff = volume - noiseLevel;
+    if (diff < 0.0f) noiseLevel += VAD_NOISE_FALL * diff;
+    else if (allowRise) noiseLevel += VAD_NOISE_RISE * diff;
+}
+
+void ActivityDetector::advance(bool voiced) {
+    if (voiced) {
+        state = ACTIVE;
+        hangover = VAD_HANGOVER_FRAMES;
+    } else if (state != SILENT) {
+        // Kurze Lücken (Bogenwechsel, Atmen) überbrücken, erst danach pausieren
+        hangover--;
+        state = (hangover > 0) ? HANGOVER : SILENT;
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef ACTIVITY_H
+#define ACTIVITY_H
+
+#include <Arduino.h>
+
+// Konfiguration (Lautstärke = mittlerer Absolutwert der int16-Samples)
+// Die Schwellen sind relativ zum gelernten Rauschpegel, damit Mikrofon-Gain und Raum egal sind.
+#define VAD_ON_FACTOR 3.0f       // Ab 3x Rauschpegel gilt ein Frame als "gespielt"
+#define VAD_OFF_FACTOR 1.8f      // Solange aktiv, reicht 1.8x (Hysterese)
+#define VAD_MIN_LEVEL 200.0f     // Absolute Untergrenze für die Einschaltschwelle
+#define VAD_NOISE_INIT 250.0f    // Startwert Rauschpegel
+#define VAD_NOISE_FALL 0.3f      // Rauschpegel folgt leiseren Frames schnell
+#define VAD_NOISE_RISE 0.02f     // ... und lauteren nur in Pausen, langsam
+#define VAD_HANGOVER_FRAMES 4    // ~370 ms bei 4096 Samples pro Frame
+#define VAD_MAX_FLATNESS 0.45f   // Flacheres Spektrum = Rauschen, kein Ton
+
+// Aktivitätserkennung (Voice Activity Detection) zwischen Audio-Erfassung und dsp.process().
+// Stille Frames werden nur über die Lautstärke erkannt (ohne FFT), laute Frames
+// werden nach der FFT über die Spectral Flatness bestätigt.
+class ActivityDetector {
+public:
+    enum State { SILENT, ACTIVE, HANGOVER };
+
+    void reset();
+
+    // Lautstärke des Frames (mittlerer Absolutwert), billig und ohne FFT
+    float measure(const int16_t* audioData, int length);
+
+    // true -> DSP + DTW für diesen Frame ausführen
+    // false -> Pause, nur der Warte-Zustand im Tracker läuft weiter
+    bool gate(float volume);
+
+    // Nach dsp.process(): rauschartige Frames zählen wie leise Frames.
+    // true -> Frame an den Tracker weitergeben
+    bool confirm(float flatness);
+
+    State getState() const { return state; }
+    float getNoiseLevel() const { return noiseLevel; }
+    bool isActive() const { return state != SILENT; }
+
+private:
+    State state = SILENT;
+    int hangover = 0;
+    bool pending = false; // Frame war laut, wartet auf Bestätigung durch confirm()
+    float noiseLevel = VAD_NOISE_INIT;
+    float lastVolume = 0.0f;
+
+    void advance(bool voiced);
+    void trackNoise(float volume, bool allowRise);
+};
+
+#endif
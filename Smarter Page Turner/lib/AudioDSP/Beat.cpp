@@ -0,0 +1,50 @@
+#include "Beat.h"
+
+void BeatAggregator::init(float framesPerBeat) {
+    minFrames = (int)(BEAT_MIN_FRACTION * framesPerBeat + 0.5f);
+    maxFrames = (int)(BEAT_MAX_FRACTION * framesPerBeat + 0.5f);
+    if (minFrames < 1) minFrames = 1;
+    if (maxFrames < minFrames) maxFrames = minFrames;
+    reset();
+}
+
+void BeatAggregator::reset() {
+    memset(sum, 0, sizeof(sum));
+    maxOnset = 0.0f;
+    onsetMean = 0.0f;
+    length = 0;
+    lastLength = 0;
+}
+
+bool BeatAggregator::push(const float* chroma, float onset, float* beatChroma, float& beatOnset) {
+    // Einsatz = Spitze über dem gleitenden Mittel (adaptiv, unabhängig vom Instrument)
+    bool isOnset = onset > BEAT_ONSET_MIN && onset > BEAT_ONSET_FACTOR * onsetMean;
+    onsetMean = BEAT_ONSET_DECAY * onsetMean + (1.0f - BEAT_ONSET_DECAY) * onset;
+
+    // Der Einsatz-Frame gehört schon zum neuen Segment
+    bool done = false;
+    if ((isOnset && length >= minFrames) || length >= maxFrames) {
+        emit(beatChroma, beatOnset);
+        done = true;
+    }
+
+    for (int k = 0; k < NUM_CHROMA; k++) sum[k] += chroma[k];
+    if (onset > maxOnset) maxOnset = onset;
+    length++;
+    return done;
+}
+
+void BeatAggregator::emit(float* beatChroma, float& beatOnset) {
+    // Mittelwert -> L2 (Division durch die Länge kürzt sich weg)
+    float norm = 0.0f;
+    for (int k = 0; k < NUM_CHROMA; k++) norm += sum[k] * sum[k];
+    norm = sqrtf(norm);
+    float inv = (norm > 1e-9f) ? 1.0f / norm : 0.0f;
+    for (int k = 0; k < NUM_CHROMA; k++) beatChroma[k] = sum[k] * inv;
+    beatOnset = maxOnset;
+
+    lastLength = length;
+    memset(sum, 0, sizeof(sum));
+    maxOnset = 0.0f;
+    length = 0;
+}
@@ -0,0 +1,41 @@
+#ifndef BEAT_H
+#define BEAT_H
+
+#include <Arduino.h>
+#include "Chroma.h"
+
+// Konfiguration
+#define BEAT_ONSET_FACTOR 1.8f    // Einsatz, wenn Onset 1.8x über dem gleitenden Mittel liegt
+#define BEAT_ONSET_MIN 0.08f      // ... und absolut über diesem Wert (relativer Flux, 0..1)
+#define BEAT_ONSET_DECAY 0.9f     // Glättung des Onset-Mittels pro Frame
+#define BEAT_MIN_FRACTION 0.5f    // Segment frühestens nach 0.5 erwarteten Schlägen schließen
+#define BEAT_MAX_FRACTION 1.5f    // ... und spätestens nach 1.5 (kein Einsatz gefunden)
+
+// Schlag-synchrone Aggregation der Live-Chroma (Gegenstück zu --beat-sync im Score Pipeline).
+// Sammelt Chroma-Vektoren zwischen zwei erkannten Einsätzen und gibt pro Segment einen
+// gemittelten, L2-normalisierten Vektor aus. Der DTW läuft dann im Schlag-Raster der Partitur:
+// ~16x weniger Zellen pro Sekunde bei 40 BPM, und Tempoabweichungen ändern nur die Segmentlänge.
+class BeatAggregator {
+public:
+    // framesPerBeat: erwartete Live-Frames pro Partitur-Schlag (DTWTracker::live_frames_per_beat)
+    void init(float framesPerBeat);
+    void reset();
+
+    // true -> Segment abgeschlossen, beatChroma/beatOnset enthalten das Segment davor
+    bool push(const float* chroma, float onset, float* beatChroma, float& beatOnset);
+
+    int getSegmentLength() const { return lastLength; }
+
+private:
+    float sum[NUM_CHROMA];
+    float maxOnset = 0.0f;
+    float onsetMean = 0.0f;
+    int length = 0;
+    int lastLength = 0;
+    int minFrames = 1;
+    int maxFrames = 1;
+
+    void emit(float* beatChroma, float& beatOnset);
+};
+
+#endif
@@ -0,0 +1,55 @@
+#include "CENS.h"
+
+static const float CENS_THRESHOLDS[CENS_NUM_LEVELS] = { 0.4f, 0.2f, 0.1f, 0.05f };
+
+void CENSStage::init() {
+    // Hann-Fenster ohne die Null-Endpunkte (wie librosa: hann(N + 2)[1:-1])
+    for (int i = 0; i < CENS_SMOOTH_LEN; i++) {
+        weights[i] = 0.5f * (1.0f - cosf(2.0f * PI * (i + 1) / (CENS_SMOOTH_LEN + 1)));
+    }
+    reset();
+}
+
+void CENSStage::reset() {
+    memset(ring, 0, sizeof(ring));
+    head = 0;
+}
+
+void CENSStage::process(float* chroma, bool smooth) {
+    // 1. L1-Normalisierung
+    float sum = 0.0f;
+    for (int k = 0; k < NUM_CHROMA; k++) sum += chroma[k];
+    float invSum = (sum > 1e-9f) ? 1.0f / sum : 0.0f;
+
+    // 2. Quantisierung -> neuester Eintrag im Ringpuffer
+    float* slot = ring[head];
+    for (int k = 0; k < NUM_CHROMA; k++) {
+        float value = chroma[k] * invSum;
+        float level = 0.0f;
+        for (int t = 0; t < CENS_NUM_LEVELS; t++) {
+            if (value > CENS_THRESHOLDS[t]) level += 1.0f;
+        }
+        slot[k] = level;
+    }
+    head = (head + 1) % CENS_SMOOTH_LEN;
+
+    // 3. Glättung: ältester Frame bekommt weights[0], neuester weights[LEN-1]
+    if (smooth) {
+        for (int k = 0; k < NUM_CHROMA; k++) chroma[k] = 0.0f;
+        for (int i = 0; i < CENS_SMOOTH_LEN; i++) {
+            const float* frame = ring[(head + i) % CENS_SMOOTH_LEN];
+            float w = weights[i];
+            for (int k = 0; k < NUM_CHROMA; k++) chroma[k] += w * frame[k];
+        }
+    } else {
+        for (int k = 0; k < NUM_CHROMA; k++) chroma[k] = slot[k];
+    }
+
+    // 4. L2-Normalisierung
+    float dot = 0.0f;
+    for (int k = 0; k < NUM_CHROMA; k++) dot += chroma[k] * chroma[k];
+    if (dot > 1e-12f) {
+        float inv = 1.0f / sqrtf(dot);
+        for (int k = 0; k < NUM_CHROMA; k++) chroma[k] *= inv;
+    }
+}
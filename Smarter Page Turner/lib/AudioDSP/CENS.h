@@ -0,0 +1,32 @@
+#ifndef CENS_H
+#define CENS_H
+
+#include <Arduino.h>
+#include "Chroma.h"
+
+// Konfiguration (muss zu CENS_SMOOTH_SECONDS in chroma_builder.py passen)
+#define CENS_SMOOTH_LEN 4        // Glättung über 4 Frames (~370 ms bei 4096 Samples pro Frame)
+#define CENS_NUM_LEVELS 4
+
+// CENS (Chroma Energy Normalized Statistics) nach Müller & Ewert, inkrementell:
+//   1. L1-Normalisierung
+//   2. Quantisierung über logarithmisch gestaffelte Schwellen (0.05 .. 0.4) -> 0..4
+//   3. Kausale Glättung über einen Ringpuffer mit Hann-Gewichten
+//   4. L2-Normalisierung (gleicher Feature-Raum wie die Partitur)
+// Fester Speicher: CENS_SMOOTH_LEN Chroma-Vektoren.
+class CENSStage {
+public:
+    void init();
+    void reset();
+    // Wandelt den Chroma-Vektor in-place in einen CENS-Vektor um.
+    // smooth = false (Degradation): nur Schritt 3 entfällt, der Vektor bleibt quantisiert und
+    // L2-normiert (Feature-Raum der Partitur), der Ring läuft weiter und ist beim Zurückschalten aktuell.
+    void process(float* chroma, bool smooth = true);
+
+private:
+    float ring[CENS_SMOOTH_LEN][NUM_CHROMA];
+    float weights[CENS_SMOOTH_LEN];
+    int head = 0;
+};
+
+#endif
@@ -1,10 +1,15 @@
 #include "Chroma.h"
 
+static_assert(NUM_CHROMA == 12 || NUM_CHROMA == 24 || NUM_CHROMA == 36,
+              "NUM_CHROMA muss 12, 24 oder 36 sein");
+
 AudioDSP::AudioDSP() {
     // Konstruktor
 }
 
-void AudioDSP::init() {
+void AudioDSP::init(float rate) {
+    sampleRate = rate;
+
     // Initialisiere RFFT Struktur für 1024 Punkte
     arm_rfft_fast_init_f32(&rfft_instance, FFT_SIZE);
     
@@ -12,10 +17,132 @@ void AudioDSP::init() {
     for (int i = 0; i < FFT_SIZE; i++) {
         window[i] = 0.5f * (1.0f - cosf(2.0f * PI * i / (FFT_SIZE - 1)));
     }
+
+    for (int i = 0; i < FFT_SIZE / 2; i++) {
+        noiseFloor[i] = NOISE_FLOOR_INIT;
+        prevMagnitudes[i] = 0.0f;
+    }
+
+    // Formel: MIDI Note Number = 69 + 12 * log2(freq / 440)
+    // Einmalig pro Bin, ab hier keine Logarithmen mehr pro Frame
+    binPitch[0] = 0.0f;
+    for (int i = 1; i < FFT_SIZE / 2; i++) {
+        binPitch[i] = 69.0f + 12.0f * log2f(getFrequency(i) / A4_REFERENCE_HZ);
+    }
+
+    // Harmonische: Peak bei f ist auch Kandidat für den Grundton f/h
+    for (int h = 0; h < HPCP_HARMONICS; h++) {
+        harmonicShift[h] = 12.0f * log2f((float)(h + 1));
+        harmonicWeight[h] = powf(HPCP_HARMONIC_DECAY, (float)h);
+    }
+
+    memset(tuningHist, 0, sizeof(tuningHist));
+    tuningOffset = 0.0f;
+    tuningFrames = 0;
+    rebuildChromaTable();
+}
+
+// Chroma-Klasse und Gewicht pro Bin aus binPitch und der aktuellen Verstimmung.
+// Nur Subtraktion und Runden -> billig genug für jede Stimmungs-Änderung.
+// Bin 0 = C (MIDI 60 * Bins pro Halbton ist durch NUM_CHROMA teilbar).
+void AudioDSP::rebuildChromaTable() {
+    for (int i = 0; i < FFT_SIZE / 2; i++) {
+        float position = (binPitch[i] - tuningOffset) * CHROMA_BINS_PER_SEMITONE;
+        float nearest = roundf(position);
+        int chromaIndex = (int)nearest % NUM_CHROMA;
+        if (chromaIndex < 0) chromaIndex += NUM_CHROMA;
+
+        binChroma[i] = (uint8_t)chromaIndex;
+        // Bins zwischen zwei Chroma-Bins sind mehrdeutig -> schwächer gewichten
+        binWeight[i] = 1.0f - fabsf(position - nearest);
+    }
+}
+
+// Lokale Maxima über dem Noise Gate, parabolisch interpoliert.
+// Einmal pro Frame, genutzt von der Stimmungs-Schätzung und dem HPCP-Modus.
+// Bei mehr als HPCP_MAX_PEAKS Maxima bleiben die stärksten (nicht die tiefsten):
+// ist die Liste voll, ersetzt ein stärkerer Peak den schwächsten. Reihenfolge egal.
+void AudioDSP::findPeaks(float* fftMagnitudes) {
+    numPeaks = 0;
+    int weakest = 0;
+    for (int i = PEAK_MIN_BIN; i < PEAK_MAX_BIN; i++) {
+        float a = fftMagnitudes[i - 1];
+        float m = fftMagnitudes[i];
+        float c = fftMagnitudes[i + 1];
+        if (m <= a || m < c || m < NOISE_GATE_FACTOR * noiseFloor[i]) continue;
+
+        // Parabolische Interpolation: Peak liegt bei i + delta
+        float denom = a - 2.0f * m + c;
+        float delta = (denom < -1e-9f) ? 0.5f * (a - c) / denom : 0.0f;
+        float magnitude = m - 0.25f * (a - c) * delta;
+
+        int slot = numPeaks;
+        if (numPeaks == HPCP_MAX_PEAKS) {
+            if (magnitude <= peakMagnitude[weakest]) continue;
+            slot = weakest;
+        }
+
+        // d(pitch)/d(bin) = 12 / (ln2 * bin)
+        peakPitch[slot] = binPitch[i] + delta * (17.312340f / i);
+        peakMagnitude[slot] = magnitude;
+        peakBin[slot] = (int16_t)i;
+
+        if (numPeaks < HPCP_MAX_PEAKS) {
+            numPeaks++;
+            if (numPeaks < HPCP_MAX_PEAKS) continue;
+        }
+        // Liste (gerade) voll: schwächsten Eintrag neu bestimmen
+        weakest = 0;
+        for (int p = 1; p < HPCP_MAX_PEAKS; p++) {
+            if (peakMagnitude[p] < peakMagnitude[weakest]) weakest = p;
+        }
+    }
+}
+
+// Inkrementelle Stimmungs-Schätzung aus den spektralen Peaks.
+// Jeder Peak liefert seine Abweichung vom nächsten Halbton, gewichtet mit
+// seiner Magnitude. Das Histogramm vergisst alte Frames exponentiell.
+void AudioDSP::updateTuning() {
+    float decay = (tuningFrames < TUNING_LEARN_FRAMES) ? TUNING_DECAY_LEARN : TUNING_DECAY_TRACK;
+    for (int b = 0; b < TUNING_HIST_BINS; b++) tuningHist[b] *= decay;
+
+    bool anyPeak = false;
+    for (int p = 0; p < numPeaks; p++) {
+        // Tiefe Peaks sind zu grob aufgelöst für Cent-genaue Abweichungen
+        if (peakBin[p] < TUNING_MIN_BIN) continue;
+
+        float pitch = peakPitch[p];
+        float deviation = pitch - roundf(pitch); // [-0.5, 0.5]
+        int b = (int)((deviation + 0.5f) * TUNING_HIST_BINS);
+        if (b >= TUNING_HIST_BINS) b = TUNING_HIST_BINS - 1;
+        tuningHist[b] += peakMagnitude[p];
+        anyPeak = true;
+    }
+    if (!anyPeak) return;
+    tuningFrames++;
+
+    // Maximum suchen und mit den (zyklischen) Nachbarn verfeinern
+    int best = 0;
+    for (int b = 1; b < TUNING_HIST_BINS; b++) {
+        if (tuningHist[b] > tuningHist[best]) best = b;
+    }
+    float left = tuningHist[(best + TUNING_HIST_BINS - 1) % TUNING_HIST_BINS];
+    float right = tuningHist[(best + 1) % TUNING_HIST_BINS];
+    float denom = left - 2.0f * tuningHist[best] + right;
+    float refine = (denom < -1e-9f) ? 0.5f * (left - right) / denom : 0.0f;
+
+    float estimate = ((best + 0.5f + refine) / TUNING_HIST_BINS) - 0.5f;
+    if (estimate > 0.5f) estimate -= 1.0f;
+    if (estimate < -0.5f) estimate += 1.0f;
+
+    if (fabsf(estimate - tuningOffset) > TUNING_UPDATE_STEP) {
+        tuningOffset = estimate;
+        rebuildChromaTable();
+    }
 }
 
 float AudioDSP::getFrequency(int binIndex) {
-    return (float)binIndex * SAMPLE_RATE / FFT_SIZE;
+    return (float)binIndex * sampleRate / FFT_SIZE;
 }
 
 // Mapping von Frequenz zu Chroma (Noten C bis H)
@@ -24,25 +151,48 @@ void AudioDSP::calculateChroma(float* fftMagnitudes, float* chromaOut) {
     memset(chromaOut, 0, sizeof(float) * NUM_CHROMA);
 
     // Wir ignorieren sehr tiefe Frequenzen (unter 50Hz -> ca Bin 2)
-    // und sehr hohe (über 4000Hz), da dort Musikinformation oft irrelevant ist für Page Turning
     for (int i = 2; i < FFT_SIZE / 2; i++) {
-        float freq = getFrequency(i);
         float magnitude = fftMagnitudes[i];
 
-        if (magnitude < 10.0f) continue; // Noise Gate
+        if (magnitude < NOISE_GATE_FACTOR * noiseFloor[i]) continue; // Adaptives Noise Gate
+
+        // Addiere Magnitude zum entsprechenden Chroma Bin (Tabelle aus rebuildChromaTable)
+        chromaOut[binChroma[i]] += magnitude * binWeight[i];
+    }
+
+    normalizeChroma(chromaOut);
+}
+
+// HPCP (Harmonic Pitch Class Profile): nur die gefundenen Peaks gehen ins Chroma.
+// Jeder Peak wird auf die beiden benachbarten Chroma-Bins verteilt (linear nach Abstand)
+// und zusätzlich mit abnehmendem Gewicht als Harmonische von f/2, f/3, f/4 gezählt.
+// Statt ~2000 Bins werden so nur einige Dutzend Peaks verarbeitet.
+void AudioDSP::calculatePeakChroma(float* chromaOut) {
+    memset(chromaOut, 0, sizeof(float) * NUM_CHROMA);
 
-        // Formel: MIDI Note Number = 69 + 12 * log2(freq / 440)
-        // Wir nehmen Rest 12, um die Chroma Klasse (0-11) zu bekommen
-        if (freq > 0) {
-            float midiNote = 69 + 12 * log2f(freq / 440.0f);
-            int chromaIndex = (int(round(midiNote)) % 12);
-            if (chromaIndex < 0) chromaIndex += 12;
+    for (int p = 0; p < numPeaks; p++) {
+        float pitch = peakPitch[p] - tuningOffset;
+        float magnitude = peakMagnitude[p];
 
-            // Addiere Magnitude zum entsprechenden Chroma Bin
-            chromaOut[chromaIndex] += magnitude;
+        for (int h = 0; h < HPCP_HARMONICS; h++) {
+            float position = (pitch - harmonicShift[h]) * CHROMA_BINS_PER_SEMITONE;
+            float lower = floorf(position);
+            float frac = position - lower;
+
+            int index = (int)lower % NUM_CHROMA;
+            if (index < 0) index += NUM_CHROMA;
+            int next = (index + 1 == NUM_CHROMA) ? 0 : index + 1;
+
+            float contribution = magnitude * harmonicWeight[h];
+            chromaOut[index] += contribution * (1.0f - frac);
+            chromaOut[next] += contribution * frac;
         }
     }
-    
+
+    normalizeChroma(chromaOut);
+}
+
+void AudioDSP::normalizeChroma(float* chromaOut) {
     // Optional: Normalisierung des Vektors (Wichtig für spätere KI/DTW)
     float maxVal = 0.0f;
     for(int i=0; i<NUM_CHROMA; i++) {
@@ -53,7 +203,69 @@ void AudioDSP::calculateChroma(float* fftMagnitudes, float* chromaOut) {
     }
 }
 
-void AudioDSP::process(int16_t* audioData, float* chromaOutput) {
+// Schnelle log2-Näherung (Exponent + Polynom für die Mantisse), Fehler < 0.01
+static inline float fastLog2(float x) {
+    union { float f; uint32_t i; } u = { x };
+    float exponent = (float)((int)((u.i >> 23) & 255) - 128);
+    u.i = (u.i & 0x007FFFFF) | 0x3F800000; // Mantisse auf [1, 2) normieren
+    return exponent + (-0.34484843f * u.f + 2.02466578f) * u.f - 0.67487759f;
+}
+
+// Spectral Flatness = geometrisches Mittel / arithmetisches Mittel
+// Tonale Frames (Geige, Klavier) liegen nahe 0, Rauschen (Rascheln, Lüftung) nahe 1.
+float AudioDSP::calculateFlatness(float* fftMagnitudes) {
+    float logSum = 0.0f;
+    float linSum = 0.0f;
+    const int count = FFT_SIZE / 2 - 2;
+
+    for (int i = 2; i < FFT_SIZE / 2; i++) {
+        float magnitude = fftMagnitudes[i] + 1e-6f;
+        logSum += fastLog2(magnitude);
+        linSum += magnitude;
+    }
+
+    float arithMean = linSum / count;
+    if (arithMean < 1e-6f) return 1.0f;
+    return exp2f(logSum / count) / arithMean;
+}
+
+// Betrag und Rauschboden in EINEM Durchlauf über das FFT-Ergebnis (ersetzt arm_cmplx_mag_f32).
+// Minimum Statistics light: unter dem Boden folgt er schnell, darüber steigt er nur langsam.
+// Dadurch bleiben gehaltene Töne über dem Boden, Raum- und Mikrofonrauschen wird gelernt.
+// Im selben Durchlauf: Spectral Flux (halbweg-gleichgerichtete Differenz zum vorherigen Frame).
+void AudioDSP::calculateMagnitudes() {
+    float signalSum = 0.0f;
+    float floorSum = 0.0f;
+    float fluxSum = 0.0f;
+
+    // 4-fach ausgerollt: hält die FPU-Pipeline des M7 voll (sqrt + 2 MACs pro Bin)
+    for (int i = 0; i < FFT_SIZE / 2; i += 4) {
+        for (int k = i; k < i + 4; k++) {
+            float re = fftOutput[2 * k];
+            float im = fftOutput[2 * k + 1];
+            float magnitude = sqrtf(re * re + im * im);
+            float diff = magnitude - noiseFloor[k];
+            noiseFloor[k] += (diff < 0.0f ? NOISE_FLOOR_FALL : NOISE_FLOOR_RISE) * diff;
+            magnitudes[k] = magnitude;
+        }
+        // Bin 0-3 (DC/Nyquist-Packing, < 40 Hz) zählen nicht zu SNR und Flux
+        if (i >= 4) {
+            for (int k = i; k < i + 4; k++) {
+                float rise = magnitudes[k] - prevMagnitudes[k];
+                fluxSum += (rise > 0.0f) ? rise : 0.0f;
+                prevMagnitudes[k] = magnitudes[k];
+            }
+            signalSum += magnitudes[i] + magnitudes[i + 1] + magnitudes[i + 2] + magnitudes[i + 3];
+            floorSum += noiseFloor[i] + noiseFloor[i + 1] + noiseFloor[i + 2] + noiseFloor[i + 3];
+        }
+    }
+
+    snr = (floorSum > 1e-6f) ? signalSum / floorSum : 0.0f;
+    // Relativ zur Gesamtenergie -> unabhängig von Lautstärke und Mikrofon-Gain
+    onset = (signalSum > 1e-6f) ? fluxSum / signalSum : 0.0f;
+}
+
+void AudioDSP::transform(int16_t* audioData) {
     // 1. Convert Int16 zu Float und Windowing
     for (int i = 0; i < FFT_SIZE; i++) {
         fftInput[i] = (float)audioData[i] * window[i];
@@ -64,12 +276,27 @@ void AudioDSP::process(int16_t* audioData, float* chromaOutput) {
     // Output ist komplex: [Real0, Img0, Real1, Img1 ...]
     arm_rfft_fast_f32(&rfft_instance, fftInput, fftOutput, 0);
 
-    // 3. Magnitude berechnen (Betrag der komplexen Zahl)
-    // Wir nutzen fftInput als temporären Puffer für Magnituden um Speicher zu sparen
-    // arm_cmplx_mag_f32 schreibt die Magnituden in den Output Buffer
-    float32_t magnitudes[FFT_SIZE/2];
-    arm_cmplx_mag_f32(fftOutput, magnitudes, FFT_SIZE / 2);
+    // 3. Magnitude + Rauschboden berechnen
+    calculateMagnitudes();
+}
+
+void AudioDSP::updateNoiseFloor(int16_t* audioData) {
+    transform(audioData);
+}
+
+void AudioDSP::process(int16_t* audioData, float* chromaOutput) {
+    // 1.-3. Window, FFT, Magnitude + Rauschboden
+    transform(audioData);
+
+    // 4. Peaks suchen, Stimmung nachführen, dann Chroma berechnen
+    findPeaks(magnitudes);
+    updateTuning();
+    if (mode == CHROMA_MODE_PEAKS) {
+        calculatePeakChroma(chromaOutput);
+    } else {
+        calculateChroma(magnitudes, chromaOutput);
+    }
 
-    // 4. Chroma berechnen
-    calculateChroma(magnitudes, chromaOutput);
+    // 5. Flachheit für die Aktivitätserkennung (Ton vs. Rauschen)
+    flatness = calculateFlatness(magnitudes);
 }
\ No newline at end of file
@@ -6,27 +6,109 @@
 
 // Konfiguration
 #define FFT_SIZE 4096
-#define SAMPLE_RATE 44100
-#define NUM_CHROMA 12
+#define SAMPLE_RATE 44100        // Nominal; die echte Rate wird an init() übergeben
+#ifndef NUM_CHROMA
+#define NUM_CHROMA 12        // 12, 24 oder 36 Bins (1, 1/2 oder 1/3 Halbton), per -D NUM_CHROMA=36
+#endif
+#define CHROMA_BINS_PER_SEMITONE (NUM_CHROMA / 12)
+
+// Adaptiver Rauschboden pro FFT-Bin (ersetzt das feste Noise Gate)
+#define NOISE_FLOOR_INIT 10.0f   // Startwert = altes festes Gate
+#define NOISE_FLOOR_FALL 0.3f    // Boden folgt leiseren Bins schnell
+#define NOISE_FLOOR_RISE 0.01f   // ... und lauteren nur langsam (~9 s Zeitkonstante)
+#define NOISE_GATE_FACTOR 2.0f   // Bin zählt erst ab 2x Rauschboden (+6 dB)
+
+// Stimmungs-Schätzung (Kammerton). Ganze Halbtöne (Barock A=415) über A4_REFERENCE_HZ einstellen,
+// der Schätzer verfolgt nur die Abweichung innerhalb von +/- 50 Cent.
+#define A4_REFERENCE_HZ 440.0f
+#define TUNING_HIST_BINS 20      // Histogramm der Peak-Abweichungen, 5 Cent pro Bin
+#define TUNING_LEARN_FRAMES 32   // ~3 s schnelles Lernen, danach nur langsames Nachführen
+#define TUNING_DECAY_LEARN 0.9f
+#define TUNING_DECAY_TRACK 0.995f
+#define TUNING_UPDATE_STEP 0.02f // Tabelle neu gewichten ab 2 Cent Änderung
+#define TUNING_MIN_BIN 20        // ~215 Hz: darunter ist die Bin-Auflösung zu grob
+
+// Peak-Picking (HPCP-Modus): nur lokale Maxima statt aller ~2000 Bins
+#define PEAK_MIN_BIN 8           // ~86 Hz
+#define PEAK_MAX_BIN 465         // ~5 kHz
+#define HPCP_MAX_PEAKS 48
+#define HPCP_HARMONICS 4         // Peak zählt auch für f/2, f/3, f/4 (Grundton-Kandidaten)
+#define HPCP_HARMONIC_DECAY 0.6f // Gewicht pro höherer Harmonischer
+
+// Chroma-Berechnung: alle Bins über dem Gate oder nur Peaks (HPCP)
+enum ChromaMode { CHROMA_MODE_BINS, CHROMA_MODE_PEAKS };
+#ifndef CHROMA_MODE_DEFAULT
+#define CHROMA_MODE_DEFAULT CHROMA_MODE_BINS
+#endif
 
 class AudioDSP {
 public:
     AudioDSP();
-    void init();
+    // sampleRate: tatsächliche Rate der Samples (Teensy: AUDIO_SAMPLE_RATE_EXACT = 44117.647 Hz).
+    // Bin-Frequenzen und die Chroma-Tabelle werden daraus abgeleitet.
+    void init(float sampleRate = SAMPLE_RATE);
+    float getSampleRate() const { return sampleRate; }
     // Führt FFT durch und berechnet Chroma
     void process(int16_t* audioData, float* chromaOutput);
+    // Spektrale Flachheit des letzten Frames (0 = tonal, 1 = Rauschen)
+    float getFlatness() const { return flatness; }
+    // Verhältnis Spektrum / Rauschboden des letzten Frames (für die Start-Erkennung)
+    float getSnr() const { return snr; }
+    // Onset-Stärke (relativer Spectral Flux) des letzten Frames: 0 = gehaltener Ton, ~1 = neuer Einsatz
+    float getOnset() const { return onset; }
+    // Geschätzte Verstimmung gegenüber A4_REFERENCE_HZ in Cent
+    float getTuningCents() const { return tuningOffset * 100.0f; }
+    // Umschalten zwischen Bin- und Peak-Modus (z.B. bei Überlast zur Laufzeit)
+    void setMode(ChromaMode newMode) { mode = newMode; }
+    ChromaMode getMode() const { return mode; }
+    int getPeakCount() const { return numPeaks; }
+    // Nur FFT + Rauschboden nachführen (z.B. gelegentlich in Pausen), ohne Chroma
+    void updateNoiseFloor(int16_t* audioData);
 
 private:
     // Puffer für FFT Berechnungen (Complex Buffer braucht 2x Größe)
     float32_t fftInput[FFT_SIZE * 2];
     float32_t fftOutput[FFT_SIZE];
     float32_t window[FFT_SIZE];
+    float32_t magnitudes[FFT_SIZE / 2];
+    float32_t noiseFloor[FFT_SIZE / 2];
+    float32_t prevMagnitudes[FFT_SIZE / 2]; // Vorheriger Frame für den Spectral Flux
+
+    // Bin -> Chroma Tabelle (einmalig log2 in init(), danach nur Addition/Runden)
+    float binPitch[FFT_SIZE / 2];      // MIDI-Tonhöhe relativ zu A4_REFERENCE_HZ
+    uint8_t binChroma[FFT_SIZE / 2];   // Chroma-Klasse nach Stimmungs-Korrektur
+    float binWeight[FFT_SIZE / 2];     // 1.0 auf dem Halbton, 0.5 genau dazwischen
+
+    // Peaks des aktuellen Frames (einmal gesucht, für Stimmung und HPCP genutzt)
+    float peakPitch[HPCP_MAX_PEAKS];   // Interpolierte Tonhöhe, noch ohne Stimmungs-Korrektur
+    float peakMagnitude[HPCP_MAX_PEAKS];
+    int16_t peakBin[HPCP_MAX_PEAKS];
+    int numPeaks = 0;
+    float harmonicShift[HPCP_HARMONICS];  // 12 * log2(h) in Halbtönen
+    float harmonicWeight[HPCP_HARMONICS];
+    ChromaMode mode = CHROMA_MODE_DEFAULT;
+
+    float tuningHist[TUNING_HIST_BINS];
+    float tuningOffset = 0.0f;         // Angewendete Abweichung in Halbtönen
+    int tuningFrames = 0;
     
     // ARM Math Instanzen
     arm_rfft_fast_instance_f32 rfft_instance;
+
+    float sampleRate = SAMPLE_RATE;
+    float flatness = 1.0f;
+    float snr = 0.0f;
+    float onset = 0.0f;
     
-    void applyWindow(int16_t* input);
+    void transform(int16_t* audioData);
+    void calculateMagnitudes();
+    void rebuildChromaTable();
+    void findPeaks(float* fftMagnitudes);
+    void updateTuning();
     void calculateChroma(float* fftMagnitudes, float* chromaOut);
+    void calculatePeakChroma(float* chromaOut);
+    void normalizeChroma(float* chromaOut);
+    float calculateFlatness(float* fftMagnitudes);
     float getFrequency(int binIndex);
 };
 
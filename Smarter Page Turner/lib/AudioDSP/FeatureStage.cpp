@@ -0,0 +1,63 @@
+#include "FeatureStage.h"
+
+void FeatureStage::init(float sampleRate) {
+    dsp.init(sampleRate);
+    reset();
+}
+
+void FeatureStage::reset() {
+    activity.reset();
+    fill = 0;
+    silentFrames = 0;
+}
+
+int FeatureStage::push(const int16_t* samples, int count, FeatureQueue& out) {
+    int frames = 0;
+    for (int i = 0; i < count; i++) {
+        buffer[fill++] = samples[i];
+        if (fill >= FFT_SIZE) {
+            // Rest des Blocks bleibt erhalten und beginnt den nächsten Frame
+            FeatureFrame f;
+            process(f);
+            f.produced = (uint32_t)micros();
+            out.push(f);
+            fill = 0;
+            frames++;
+        }
+    }
+    return frames;
+}
+
+void FeatureStage::process(FeatureFrame& f) {
+    uint32_t start = micros();
+    dsp.setMode((ChromaMode)requestedMode.load(std::memory_order_relaxed));
+
+    f.seq = seq++;
+    f.millis = millis();
+    f.flags = 0;
+    f.flatness = 0.0f;
+    f.snr = 0.0f;
+    f.onset = 0.0f;
+
+    // Berechnung nur bei Aktivität, in Pausen ruht die FFT
+    f.volume = activity.measure(buffer, FFT_SIZE);
+    bool tracked = false;
+    if (activity.gate(f.volume)) {
+        dsp.process(buffer, f.chroma);
+        f.flatness = dsp.getFlatness();
+        f.snr = dsp.getSnr();
+        f.onset = dsp.getOnset();
+        f.flags |= FEATURE_ACTIVE;
+        if (activity.confirm(f.flatness)) {
+            f.flags |= FEATURE_TRACK;
+            tracked = true;
+        }
+    }
+    if (!tracked) {
+        // Rauschboden auch in längeren Pausen gelegentlich nachführen
+        if (++silentFrames % NOISE_PROBE_INTERVAL == 0) dsp.updateNoiseFloor(buffer);
+    } else {
+        silentFrames = 0;
+    }
+    f.dspMicros = (uint32_t)micros() - start;
+}
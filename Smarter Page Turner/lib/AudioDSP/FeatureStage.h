@@ -0,0 +1,66 @@
+#ifndef FEATURE_STAGE_H
+#define FEATURE_STAGE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "Chroma.h"
+#include "Activity.h"
+#include "SpscQueue.h"
+
+// Konfiguration
+#define FEATURE_QUEUE_FRAMES 8       // ~750 ms Puffer zwischen DSP-Stufe und Tracker
+#define NOISE_PROBE_INTERVAL 8       // In Pausen 1 FFT alle 8 Frames, um den Rauschboden nachzuführen
+
+// Flags eines FeatureFrame
+#define FEATURE_ACTIVE 0x01          // Aktivitätserkennung offen, dsp.process() lief, chroma gültig
+#define FEATURE_TRACK 0x02           // Von der Flatness als Musik bestätigt -> DTW-Schritt, sonst Pause
+
+// Ergebnis der DSP-Stufe für einen Frame (FFT_SIZE Samples)
+struct FeatureFrame {
+    uint32_t seq;             // Laufende Nummer, Lücken = verworfene Frames
+    uint32_t millis;          // Zeitstempel beim Fertigstellen
+    uint32_t produced;        // micros() beim Einreihen -> Wartezeit in der Queue
+    uint32_t dspMicros;       // Rechenzeit der DSP-Stufe (zählt im Scheduler-Budget mit)
+    uint8_t flags;
+    float volume;
+    float flatness;           // 0, wenn nicht FEATURE_ACTIVE
+    float snr;
+    float onset;
+    float chroma[NUM_CHROMA];
+};
+
+typedef SpscQueue<FeatureFrame, FEATURE_QUEUE_FRAMES> FeatureQueue;
+
+// Erzeuger-Stufe der Pipeline: Samples -> Frame-Puffer -> Aktivität -> FFT/Chroma -> FeatureQueue.
+// Läuft entweder in loop() (nach der AudioRecordQueue) oder direkt im Audio-Update-Interrupt;
+// Tracker und Ausgabe holen die Frames als Verbraucher aus der Queue. Alles, was die Stufe braucht,
+// gehört ihr (DSP, Aktivitätserkennung, Puffer); vom Verbraucher kommt nur der Chroma-Modus.
+class FeatureStage {
+public:
+    // sampleRate: Rate der Samples, die push() bekommt (nach einem evtl. Resampler)
+    void init(float sampleRate);
+    void reset();
+
+    // Samples anhängen; jeder volle Frame wird gerechnet und in out eingereiht.
+    // Rückgabe: Zahl der fertigen Frames (auch die, die wegen voller Queue verworfen wurden)
+    int push(const int16_t* samples, int count, FeatureQueue& out);
+
+    // Degradation vom Verbraucher (anderer Kontext), gilt ab dem nächsten Frame
+    void requestMode(ChromaMode m) { requestedMode.store(m, std::memory_order_relaxed); }
+
+    uint32_t getFrames() const { return seq; }
+
+    AudioDSP dsp;
+    ActivityDetector activity;
+
+private:
+    int16_t buffer[FFT_SIZE];
+    int fill = 0;
+    int silentFrames = 0;
+    uint32_t seq = 0;
+    std::atomic<int> requestedMode{CHROMA_MODE_DEFAULT};
+
+    void process(FeatureFrame& f);
+};
+
+#endif
@@ -0,0 +1,76 @@
+#include "Resampler.h"
+
+static_assert(RESAMPLER_PHASES == 32, "Phasen-Index nutzt die oberen 5 Bit des Bruchteils");
+
+void PolyphaseResampler::init(float inputRate, float outputRate) {
+    double ratio = (double)inputRate / (double)outputRate;
+    step = (uint64_t)(ratio * 4294967296.0);
+
+    // Beim Heruntertakten Grenzfrequenz absenken (Anti-Aliasing), sonst knapp unter Nyquist
+    double cutoff = 0.45 * (ratio > 1.0 ? 1.0 / ratio : 1.0);
+    const double center = (RESAMPLER_TAPS - 1) / 2.0;
+
+    for (int p = 0; p <= RESAMPLER_PHASES; p++) {
+        double frac = (double)p / RESAMPLER_PHASES;
+        double sum = 0.0;
+        for (int k = 0; k < RESAMPLER_TAPS; k++) {
+            double x = k - center - frac;
+            double sinc = (fabs(x) < 1e-9) ? 2.0 * cutoff : sin(2.0 * PI * cutoff * x) / (PI * x);
+            // Blackman-Fenster über die Filterlänge (um frac verschoben)
+            double w = (k - frac + 1.0) / (RESAMPLER_TAPS + 1.0);
+            double window = 0.42 - 0.5 * cos(2.0 * PI * w) + 0.08 * cos(4.0 * PI * w);
+            table[p][k] = (float)(sinc * window);
+            sum += sinc * window;
+        }
+        // Jede Phase auf Verstärkung 1 normieren
+        for (int k = 0; k < RESAMPLER_TAPS; k++) table[p][k] = (float)(table[p][k] / sum);
+    }
+    reset();
+}
+
+void PolyphaseResampler::reset() {
+    // Mit Stille vorfüllen, damit sofort Ausgabe entsteht
+    historyLen = RESAMPLER_TAPS - 1;
+    for (int i = 0; i < historyLen; i++) history[i] = 0.0f;
+    position = 0;
+}
+
+int PolyphaseResampler::process(const int16_t* input, int count, int16_t* output, int maxOutput) {
+    // maxOutput zu klein -> Rückstau; nie über den Puffer hinaus schreiben
+    int space = (RESAMPLER_TAPS - 1 + RESAMPLER_MAX_BLOCK) - historyLen;
+    if (count > space) count = space;
+    for (int i = 0; i < count; i++) history[historyLen + i] = (float)input[i];
+    historyLen += count;
+
+    int produced = 0;
+    while (produced < maxOutput) {
+        uint32_t index = (uint32_t)(position >> 32);
+        if (index + RESAMPLER_TAPS > (uint32_t)historyLen) break;
+
+        // Obere Bits des Bruchteils -> Phase, Rest -> Interpolation zwischen zwei Phasen
+        uint32_t fraction = (uint32_t)position;
+        uint32_t phase = fraction >> (32 - 5);           // RESAMPLER_PHASES = 32 = 2^5
+        float alpha = (float)(fraction & 0x07FFFFFF) * (1.0f / 134217728.0f);
+
+        const float* h0 = table[phase];
+        const float* h1 = table[phase + 1];
+        const float* x = &history[index];
+        float acc = 0.0f;
+        for (int k = 0; k < RESAMPLER_TAPS; k++) {
+            acc += x[k] * (h0[k] + alpha * (h1[k] - h0[k]));
+        }
+
+        if (acc > 32767.0f) acc = 32767.0f;
+        if (acc < -32768.0f) acc = -32768.0f;
+        output[produced++] = (int16_t)lrintf(acc);
+        position += step;
+    }
+
+    // Verbrauchte Samples verwerfen, Rest (mind. TAPS - 1) nach vorne schieben
+    uint32_t consumed = (uint32_t)(position >> 32);
+    if (consumed > (uint32_t)historyLen) consumed = historyLen;
+    memmove(history, history + consumed, (historyLen - consumed) * sizeof(float));
+    historyLen -= consumed;
+    position -= (uint64_t)consumed << 32;
+    return produced;
+}
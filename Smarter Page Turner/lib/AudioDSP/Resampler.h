@@ -0,0 +1,32 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <Arduino.h>
+
+// Konfiguration
+#define RESAMPLER_TAPS 16          // Filterlänge pro Phase
+#define RESAMPLER_PHASES 32        // Phasen der Polyphasen-Tabelle (dazwischen linear interpoliert)
+#define RESAMPLER_MAX_BLOCK 128    // Größte Eingabe pro process() (= Audio-Block des Teensy)
+
+// Polyphasen-Resampler für beliebige Verhältnisse nahe 1, z.B. 44117.647 Hz (Teensy)
+// -> 44100 Hz (Partitur). Windowed-Sinc (Blackman) in RESAMPLER_PHASES Phasen,
+// Zeitposition als 32.32 Festkomma -> keine Drift, bitgleich auf Teensy und Host.
+// Latenz: RESAMPLER_TAPS / 2 Samples.
+class PolyphaseResampler {
+public:
+    void init(float inputRate, float outputRate);
+    void reset();
+
+    // Liefert die Anzahl geschriebener Samples (bei Verhältnis ~1: count - 1 .. count + 1).
+    // maxOutput sollte >= count + 2 sein, sonst staut sich Eingabe im Verlauf.
+    int process(const int16_t* input, int count, int16_t* output, int maxOutput);
+
+private:
+    float table[RESAMPLER_PHASES + 1][RESAMPLER_TAPS];
+    float history[RESAMPLER_TAPS - 1 + RESAMPLER_MAX_BLOCK];
+    int historyLen = 0;           // Gültige Samples in history
+    uint64_t position = 0;        // Lesezeitpunkt relativ zu history[0], 32.32 Festkomma
+    uint64_t step = 0;            // inputRate / outputRate, 32.32 Festkomma
+};
+
+#endif
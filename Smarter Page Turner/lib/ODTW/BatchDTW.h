@@ -0,0 +1,756 @@
+#ifndef BATCH_DTW_H
+#define BATCH_DTW_H
+
+#include <Arduino.h>
+#include <float.h>
+#include <stdint.h>
+#include <string.h>
+#include "Settings.h"
+#include "Config.h"
+#include "Distance.h"
+#include "Beat.h"
+
+// Batch-Tracker: N Aufführungen derselben Partitur gemeinsam (Auswertung vieler Aufnahmen,
+// host_batch). Rechnet dasselbe wie N unabhängige DTWTracker::update(), Bit für Bit, aber:
+//   - Die Aufführungen liegen in Kacheln zu BATCH_LANES Spuren. Kostenspalten im SoA-Layout
+//     [Partitur-Frame][Spur]: eine Zeile sind BATCH_LANES floats nebeneinander.
+//   - Pro Partitur-Frame wird der Chroma-Vektor einmal geladen und gegen alle Spuren der Kachel
+//     gerechnet, eine Spur pro Vektor-Element (BatchFloat). Keine Sprünge in der Zellen-Schleife:
+//     Auswahl per Maske statt if.
+//   - Eine Kachel rechnet über die Vereinigung der Fenster ihrer Spuren (disjunkte Bereiche, Lücken
+//     dazwischen kosten nichts); Zellen außerhalb des eigenen Fensters werden maskiert. Ruhende Spuren
+//     kopieren nur ihr altes Fenster, beendete fallen ganz heraus. Rechnet in einem Bereich nur eine
+//     Spur, läuft er skalar mit chromaDot wie DTWTracker statt mit einem fast leeren Vektor.
+//   - Laufen die Aufführungen auseinander (Tempo, späterer Einsatz), werden die Spuren nach Position neu
+//     auf die Kacheln verteilt, wenn das laut Kostenmodell genug Zellen spart (BATCH_REGROUP_GAIN).
+//   - Offline (alle Eingaben liegen vor) muss nicht jede Aufführung in jedem Takt einen Frame bekommen:
+//     pace() hält Aufführungen an, die in der Partitur zu weit vorne liegen, bis die langsamen aufholen.
+// Unterschiede zu DTWTracker: fester Radius (kein FrameScheduler), keine Ausgabe auf Serial/Serial1
+// (Seitenwechsel nur in BatchLane::next_page_idx), keine Checkpoints/Keyframes.
+
+// Spuren pro Kachel = eine Zeile der Kostenspalten = ein Vektorregister (per -D überschreibbar)
+#ifndef BATCH_LANES
+#if defined(__AVX512F__)
+#define BATCH_LANES 16
+#elif defined(__AVX__)
+#define BATCH_LANES 8
+#else
+#define BATCH_LANES 4                // SSE2 / NEON: 128 Bit
+#endif
+#endif
+#define BATCH_REGROUP_GAIN 4         // Neu verteilen, wenn die sortierte Verteilung mind. 1/4 der Zellen spart
+
+// Eine Zeile der Kostenspalten: BATCH_LANES Spuren. GCC/Clang-Vektortypen, der Compiler setzt sie auf
+// SSE/AVX (Host) bzw. NEON um, auf Zielen ohne SIMD auf skalare Befehle
+typedef float BatchFloat __attribute__((vector_size(BATCH_LANES * sizeof(float))));
+typedef int32_t BatchInt __attribute__((vector_size(BATCH_LANES * sizeof(int32_t))));
+
+// Eingabe einer Aufführung für einen Frame
+enum BatchInput : uint8_t {
+    BATCH_NONE = 0,                  // Nichts (z.B. Schlag-Raster: Segment noch nicht fertig, Aufnahme zu Ende)
+    BATCH_UPDATE,                    // wie DTWTracker::update()
+    BATCH_REST                       // wie DTWTracker::rest()
+};
+
+// Zustand einer Aufführung, Felder wie in DTWTracker
+struct BatchLane {
+    int current_position = 0;
+    int next_page_idx = 0;
+    bool finished = false;
+    bool running = false;
+    int rest_frames = 0;
+    float tempo = 1.0f;
+    float cost = 0.0f;
+    float confidence = 0.0f;
+
+    float advance_acc = 0.0f;
+    int last_start = 0;
+    int last_end = 0;
+    int tile = 0;                    // Lage der Kostenspalte
+    int slot = 0;
+};
+
+class BatchTracker {
+public:
+    TrackerConfig cfg = defaultTrackerConfig();
+    const ScoreView* score = nullptr;
+    float frames_per_update = 1.0f;
+    int radius = DTW_RADIUS;
+
+    // Statistik: nutzbare Zellen (Fenster der aktiven Spuren) gegen gerechnete Zellen (Kachel x Spuren)
+    uint64_t usefulCells = 0;
+    uint64_t computedCells = 0;
+    uint32_t regroups = 0;
+
+    BatchTracker() {}
+    BatchTracker(const BatchTracker&) = delete;
+    BatchTracker& operator=(const BatchTracker&) = delete;
+    ~BatchTracker() { release(); }
+
+    // n Aufführungen gegen view. Das Zeitraster kommt von setFrameClock() (vor dem ersten update())
+    void init(const ScoreView* view, int n, const TrackerConfig& c) {
+        release();
+        score = view;
+        cfg = c;
+        lanes = n;
+        tiles = (n + BATCH_LANES - 1) / BATCH_LANES;
+        lane = new BatchLane[n];
+        order = new int[n];
+        work = new LaneWork[n];
+        tile = new Tile[tiles];
+        setFrameClock(SCORE_SAMPLE_RATE, FFT_SIZE);
+
+        if (score->magnitudes) {
+            magnitudes = score->magnitudes;
+        } else {
+            own_magnitudes = new float[score->len];
+            for (int i = 0; i < score->len; i++) {
+                own_magnitudes[i] = sqrt(chromaDot<NUM_CHROMA>(score->chroma[i], score->chroma[i]));
+            }
+            magnitudes = own_magnitudes;
+        }
+    }
+
+    // Wie DTWTracker::setFrameClock(); legt auch Radius und Spalten-Rand fest, danach beginnen alle von vorne
+    void setFrameClock(float live_sample_rate, int live_frame_samples) {
+#if SCORE_BEAT_SYNC
+        (void)live_sample_rate;
+        (void)live_frame_samples;
+        frames_per_update = 1.0f;
+#else
+        float live_seconds = live_frame_samples / live_sample_rate;
+        float score_seconds = SCORE_HOP_LENGTH / SCORE_SAMPLE_RATE;
+        frames_per_update = live_seconds / score_seconds;
+#endif
+        // Vorschub pro Update höchstens max_step (Bresenham, im Schlag-Raster mal Segmentlänge), Skip das Doppelte
+#if SCORE_BEAT_SYNC
+        max_step = (int)(frames_per_update * BEAT_MAX_FRACTION) + 1;
+#else
+        max_step = (int)frames_per_update + 1;
+#endif
+        pad = 2 * max_step;
+        int min_r = 2 * (int)ceilf(frames_per_update) + 2;
+        radius = cfg.radius < min_r ? min_r : cfg.radius;
+        allocate();
+        reset();
+    }
+
+    void reset() {
+        for (int i = 0; i < lanes; i++) {
+            lane[i] = BatchLane();
+            lane[i].tile = i / BATCH_LANES;
+            lane[i].slot = i % BATCH_LANES;
+        }
+        int rows = pad + score->len;
+        for (int t = 0; t < tiles; t++) {
+            for (int k = 0; k < rows * BATCH_LANES; k++) {
+                tile[t].prev[k] = FLT_MAX;
+                tile[t].curr[k] = FLT_MAX;
+            }
+            for (int s = 0; s < BATCH_LANES; s++) {
+                int i = t * BATCH_LANES + s;
+                tile[t].occupant[s] = (i < lanes) ? i : -1;
+                if (i < lanes) tile[t].prev[row(0) + s] = 0.0f;
+            }
+        }
+        usefulCells = computedCells = 0;
+        lastUseful = lastComputed = 0;
+        regroups = 0;
+    }
+
+    int size() const { return lanes; }
+    const BatchLane& get(int i) const { return lane[i]; }
+
+    // Offline-Takt: welche Aufführungen im nächsten update() ihren nächsten Frame bekommen. BATCH_NONE ist
+    // für eine Spur ein leerer Takt, jede darf also in ihrem eigenen Tempo durch ihre Frames gehen.
+    // Angehalten wird, wer mehr als einen Radius vor der langsamsten noch offenen Aufführung liegt; die
+    // Fenster einer Kachel bleiben so übereinander, auch bei verschiedenem Tempo oder Einsatz.
+    // pending[i] = Aufführung i hat noch Frames; go[i] = 1: Frame einspeisen, 0: aussetzen (BATCH_NONE)
+    void pace(const uint8_t* pending, uint8_t* go) const {
+        int slowest = score->len;
+        for (int i = 0; i < lanes; i++) {
+            if (pending[i] && !lane[i].finished && lane[i].current_position < slowest) slowest = lane[i].current_position;
+        }
+        for (int i = 0; i < lanes; i++) {
+            go[i] = pending[i] && (lane[i].finished || lane[i].current_position <= slowest + radius);
+        }
+    }
+
+    // Ein Frame für alle Aufführungen. live: n x NUM_CHROMA (zeilenweise), snr/onset: n Werte,
+    // input: n x BatchInput. onset darf nullptr sein (ohne Onset-Spur), advance auch (überall 1.0,
+    // sonst Segmentlänge in Schlägen wie bei DTWTracker::update, höchstens BEAT_MAX_FRACTION)
+    void update(const float* live, const float* snr, const float* onset, const uint8_t* input,
+                const float* advance = nullptr) {
+        uint64_t usefulBefore = usefulCells, computedBefore = computedCells;
+
+        // --- VORBEREITUNG PRO SPUR (wie der Anfang von DTWTracker::update) ---
+        for (int i = 0; i < lanes; i++) {
+            BatchLane& l = lane[i];
+            LaneWork& w = work[i];
+            w.active = false;
+            if (input[i] == BATCH_REST) {
+                if (l.running && !l.finished) l.rest_frames++;
+                continue;
+            }
+            if (input[i] != BATCH_UPDATE || l.finished) continue;
+            if (!l.running) {
+                if (snr[i] > cfg.start_threshold) l.running = true;
+                else continue;
+            }
+            const float* v = live + (size_t)i * NUM_CHROMA;
+            w.live = v;
+            w.onset = onset ? onset[i] : 0.0f;
+            float live_mag = sqrt(chromaDot<NUM_CHROMA>(v, v));
+            w.live_ok = live_mag > 1e-9;
+            w.inv_live_mag = w.live_ok ? (1.0f / live_mag) : 0.0f;
+
+            w.nominal = frames_per_update * (advance ? advance[i] : 1.0f);
+            l.advance_acc += w.nominal;
+            int step_off = (int)l.advance_acc;
+            l.advance_acc -= step_off;
+            w.step_off = step_off;
+            w.skip_off = (step_off > 0) ? 2 * step_off : 1;
+
+            w.start = l.current_position - radius;
+            w.end = l.current_position + radius;
+            if (w.start < 0) w.start = 0;
+            if (w.end >= score->len) w.end = score->len - 1;
+            w.active = true;
+            usefulCells += w.end - w.start + 1;
+        }
+
+        if (needsRegroup()) regroup();
+
+        for (int t = 0; t < tiles; t++) updateTile(tile[t]);
+        lastUseful = usefulCells - usefulBefore;
+        lastComputed = computedCells - computedBefore;
+
+        // --- NACHBEREITUNG PRO SPUR (Tempo, Position, Seitenwechsel) ---
+        for (int i = 0; i < lanes; i++) {
+            LaneWork& w = work[i];
+            if (!w.active || w.best < 0) continue;
+            BatchLane& l = lane[i];
+            l.cost = w.min_val;
+            l.confidence = (w.rival < FLT_MAX) ? w.rival / (w.rival + 1.0f) : 1.0f;
+            l.last_start = w.start;
+            l.last_end = w.end;
+            if (w.nominal > 0.0f) {
+                float ratio = (w.best - l.current_position) / w.nominal;
+                l.tempo += TEMPO_SMOOTH * (ratio - l.tempo);
+            }
+            l.current_position = w.best;
+            checkPageTurn(l);
+            // Beendete Spuren rechnen nicht mehr mit, ihre Spalte wird gleich gelöscht
+            if (l.finished) {
+                for (int j = l.last_start; j <= l.last_end; j++) tile[l.tile].prev[row(j) + l.slot] = FLT_MAX;
+            }
+        }
+    }
+
+private:
+    struct Tile {
+        float* prev = nullptr;       // (pad + len) x BATCH_LANES
+        float* curr = nullptr;
+        int occupant[BATCH_LANES];   // Aufführung pro Spur, -1 = leer
+    };
+
+    // Zwischenwerte eines Updates pro Aufführung
+    struct LaneWork {
+        bool active;
+        bool live_ok;
+        int step_off;
+        int skip_off;
+        float nominal;
+        int start;
+        int end;
+        const float* live;
+        float onset;
+        float inv_live_mag;
+        int best;
+        float min_val;
+        float rival;
+    };
+
+    int lanes = 0;
+    int tiles = 0;
+    int max_step = 2;
+    int pad = 4;                     // Zeilen vor Frame 0 (immer FLT_MAX) statt "j >= step_off"
+    uint64_t lastUseful = 0;         // Zellen des letzten Updates (Vorprüfung fürs Umverteilen)
+    uint64_t lastComputed = 0;
+    BatchLane* lane = nullptr;
+    LaneWork* work = nullptr;
+    Tile* tile = nullptr;
+    int* order = nullptr;            // Spuren nach key() sortiert (needsRegroup -> regroup)
+    float* scratch = nullptr;        // Fenster beim Umverteilen
+    const float* magnitudes = nullptr;
+    float* own_magnitudes = nullptr;
+
+    int row(int j) const { return (pad + j) * BATCH_LANES; }
+
+    // Spalten sind nur auf float ausgerichtet (new[]) -> memcpy statt Zeiger-Cast (movups/vld1)
+    static BatchFloat load(const float* p) {
+        BatchFloat v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+    static void store(float* p, BatchFloat v) { memcpy(p, &v, sizeof(v)); }
+    static BatchFloat splat(float x) { return BatchFloat{} + x; }
+    static BatchInt splatInt(int32_t x) { return BatchInt{} + x; }
+
+    void allocate() {
+        int rows = pad + score->len;
+        for (int t = 0; t < tiles; t++) {
+            delete[] tile[t].prev;
+            delete[] tile[t].curr;
+            tile[t].prev = new float[rows * BATCH_LANES];
+            tile[t].curr = new float[rows * BATCH_LANES];
+        }
+        delete[] scratch;
+        scratch = new float[(size_t)lanes * (2 * radius + 1)];
+    }
+
+    void release() {
+        for (int t = 0; t < tiles; t++) {
+            delete[] tile[t].prev;
+            delete[] tile[t].curr;
+        }
+        delete[] tile;
+        delete[] lane;
+        delete[] work;
+        delete[] order;
+        delete[] scratch;
+        delete[] own_magnitudes;
+        tile = nullptr;
+        lane = nullptr;
+        work = nullptr;
+        order = nullptr;
+        scratch = nullptr;
+        own_magnitudes = nullptr;
+        lanes = tiles = 0;
+    }
+
+    // Fenster einer Spur in diesem Update: aktiv = neues Fenster, sonst bleibt die alte Spalte stehen
+    void window(int i, int& lo, int& hi) const {
+        if (work[i].active) {
+            lo = work[i].start;
+            hi = work[i].end;
+        } else {
+            lo = lane[i].last_start;
+            hi = lane[i].last_end;
+        }
+    }
+
+    // Sortierschlüssel beim Umverteilen: Fensteranfang, beendete Spuren ans Ende (sie rechnen nicht mehr)
+    int key(int i) const {
+        if (lane[i].finished) return score->len;
+        int lo, hi;
+        window(i, lo, hi);
+        return lo;
+    }
+
+    // Bereiche lo/hi[0..n) nach Anfang sortieren und überlappende bzw. angrenzende zusammenfassen.
+    // Rückgabe: Zahl der disjunkten Bereiche
+    static int merge(int* lo, int* hi, int n) {
+        for (int a = 1; a < n; a++) {
+            int l = lo[a], h = hi[a], b = a;
+            for (; b > 0 && lo[b - 1] > l; b--) {
+                lo[b] = lo[b - 1];
+                hi[b] = hi[b - 1];
+            }
+            lo[b] = l;
+            hi[b] = h;
+        }
+        int m = 0;
+        for (int a = 0; a < n; a++) {
+            if (m > 0 && lo[a] <= hi[m - 1] + 1) {
+                if (hi[a] > hi[m - 1]) hi[m - 1] = hi[a];
+            } else {
+                lo[m] = lo[a];
+                hi[m] = hi[a];
+                m++;
+            }
+        }
+        return m;
+    }
+
+    // Zeilen, die Spuren members[0..n) (-1 = leer) in diesem Update rechnen: die Fenster der aktiven
+    // Spuren und die alten Fenster der ruhenden (nur kopiert). Beendete Spuren brauchen ihre Spalte nicht
+    // mehr. where[s] = Bereich von members[s] (-1 = keiner), shared[r] = aktive Spuren in Bereich r.
+    // Rückgabe: Zahl der disjunkten Bereiche
+    int runs(const int* members, int n, int* lo, int* hi, int* where, int* shared) const {
+        int wlo[BATCH_LANES], whi[BATCH_LANES];
+        int m = 0;
+        for (int s = 0; s < n; s++) {
+            int i = members[s];
+            where[s] = -1;
+            if (i < 0 || lane[i].finished) continue;
+            window(i, wlo[s], whi[s]);
+            lo[m] = wlo[s];
+            hi[m] = whi[s];
+            m++;
+        }
+        int count = merge(lo, hi, m);
+        for (int r = 0; r < count; r++) shared[r] = 0;
+        for (int s = 0; s < n; s++) {
+            int i = members[s];
+            if (i < 0 || lane[i].finished) continue;
+            int r = 0;
+            while (whi[s] > hi[r]) r++;
+            where[s] = r;
+            if (work[i].active) shared[r]++;
+        }
+        return count;
+    }
+
+    // Kostenmodell für updateTile(): Zellen eines Updates der Spuren members[0..n). Bereiche mehrerer
+    // aktiver Spuren kosten eine Zeile pro Spur der Kachel, die übrigen eine Zelle pro Zeile (skalar)
+    uint64_t cost(const int* members, int n) const {
+        int lo[BATCH_LANES], hi[BATCH_LANES], where[BATCH_LANES], shared[BATCH_LANES];
+        int count = runs(members, n, lo, hi, where, shared);
+        uint64_t cells = 0;
+        bool any = false;
+        for (int r = 0; r < count; r++) {
+            cells += (uint64_t)(hi[r] - lo[r] + 1) * (shared[r] > 1 ? BATCH_LANES : 1);
+            any |= shared[r] > 0;
+        }
+        return any ? cells : 0;
+    }
+
+    // Umverteilen, wenn die nach Position sortierte Verteilung mindestens 1/BATCH_REGROUP_GAIN der Zellen
+    // der jetzigen spart. Vorprüfung: keine Verteilung rechnet weniger als die nutzbaren Zellen; war der
+    // Verschnitt im letzten Update kleiner als dieser Anteil, bleibt es beim Alten, ohne zu sortieren.
+    // Liegen die Aufführungen weit auseinander, rechnet jede ohnehin skalar und Sortieren bringt nichts.
+    // Hinterlässt die sortierte Reihenfolge in order für regroup().
+    bool needsRegroup() {
+        if (lastComputed * (BATCH_REGROUP_GAIN - 1) < lastUseful * BATCH_REGROUP_GAIN) return false;
+        uint64_t now = 0, sorted = 0;
+        for (int t = 0; t < tiles; t++) now += cost(tile[t].occupant, BATCH_LANES);
+
+        for (int i = 0; i < lanes; i++) order[i] = i;
+        // Einfügen: die Reihenfolge ändert sich zwischen zwei Updates nur wenig
+        for (int a = 1; a < lanes; a++) {
+            int i = order[a];
+            int k = key(i);
+            int b = a;
+            for (; b > 0 && key(order[b - 1]) > k; b--) order[b] = order[b - 1];
+            order[b] = i;
+        }
+        for (int a = 0; a < lanes; a += BATCH_LANES) {
+            sorted += cost(order + a, lanes - a < BATCH_LANES ? lanes - a : BATCH_LANES);
+        }
+        return sorted * BATCH_REGROUP_GAIN <= now * (BATCH_REGROUP_GAIN - 1);
+    }
+
+    // Spuren in der Reihenfolge von order (von needsRegroup sortiert) auf die Kacheln verteilen.
+    // Verschoben wird nur prev im letzten Fenster jeder Spur (curr ist zwischen Updates überall FLT_MAX).
+    void regroup() {
+        regroups++;
+        const int width = 2 * radius + 1;
+        for (int a = 0; a < lanes; a++) {
+            int i = order[a];
+            BatchLane& l = lane[i];
+            if (l.tile == a / BATCH_LANES && l.slot == a % BATCH_LANES) continue;
+            Tile& from = tile[l.tile];
+            for (int j = l.last_start; j <= l.last_end; j++) {
+                scratch[(size_t)i * width + (j - l.last_start)] = from.prev[row(j) + l.slot];
+                from.prev[row(j) + l.slot] = FLT_MAX;
+            }
+        }
+        for (int a = 0; a < lanes; a++) {
+            int i = order[a];
+            BatchLane& l = lane[i];
+            int t = a / BATCH_LANES, s = a % BATCH_LANES;
+            if (l.tile == t && l.slot == s) continue;
+            for (int j = l.last_start; j <= l.last_end; j++) {
+                tile[t].prev[row(j) + s] = scratch[(size_t)i * width + (j - l.last_start)];
+            }
+            l.tile = t;
+            l.slot = s;
+        }
+        for (int a = 0; a < tiles * BATCH_LANES; a++) {
+            tile[a / BATCH_LANES].occupant[a % BATCH_LANES] = (a < lanes) ? order[a] : -1;
+        }
+    }
+
+    // Ein Update einer Kachel. Bereiche mit höchstens einer aktiven Spur laufen skalar (updateSolo für
+    // die aktive, ruhende verschieben ihr Fenster nach curr), nur Bereiche mehrerer aktiver Spuren als
+    // Vektor (updateShared). Die übrigen Spuren haben in einem Bereich nur FLT_MAX (curr ist zwischen
+    // Updates überall FLT_MAX), ihr Vektor-Ergebnis wäre dasselbe.
+    // prev ist nur im letzten Fenster jeder Spur endlich; jeder Pfad löscht es, sobald er es gelesen hat
+    // (solange die Zeilen noch im Cache liegen), nach dem Tausch ist curr wieder überall FLT_MAX.
+    void updateTile(Tile& t) {
+        int runLo[BATCH_LANES], runHi[BATCH_LANES], where[BATCH_LANES], shared[BATCH_LANES];
+        int n = runs(t.occupant, BATCH_LANES, runLo, runHi, where, shared);
+        bool any = false, vector = false;
+        for (int r = 0; r < n; r++) {
+            any |= shared[r] > 0;
+            vector |= shared[r] > 1;
+        }
+        if (!any) return;
+
+        uint64_t cells = 0;
+        for (int r = 0; r < n; r++) {
+            if (shared[r] > 1) continue;
+            cells += runHi[r] - runLo[r] + 1;
+            for (int s = 0; s < BATCH_LANES; s++) {
+                if (where[s] != r) continue;
+                const BatchLane& l = lane[t.occupant[s]];
+                if (work[t.occupant[s]].active) {
+                    updateSolo(t, s);
+                    continue;
+                }
+                for (int j = l.last_start; j <= l.last_end; j++) {
+                    t.curr[row(j) + s] = t.prev[row(j) + s];
+                    t.prev[row(j) + s] = FLT_MAX;
+                }
+            }
+        }
+        if (vector) cells += updateShared(t, runLo, runHi, where, shared, n);
+        computedCells += cells;
+
+        // --- SWAP ---
+        float* temp = t.prev;
+        t.prev = t.curr;
+        t.curr = temp;
+    }
+
+    // Vektor-Pfad: alle Bereiche r mit shared[r] > 1, eine Spur pro Vektor-Element. Rückgabe: Zellen
+    uint64_t updateShared(Tile& t, const int* runLo, const int* runHi, const int* where, const int* shared, int n) {
+        // --- SPUR-VEKTOREN (SoA) ---
+        // Masken: -1 = wahr, 0 = falsch (wie das Ergebnis eines Vektor-Vergleichs)
+        const BatchFloat inf = splat(FLT_MAX);
+        const BatchFloat one = splat(1.0f);
+        BatchFloat live[NUM_CHROMA];
+        BatchFloat inv_live, live_onset;
+        BatchInt w_start, w_end, skip_off, active, keep, live_ok, step_off;
+        // Vorschub der Vektor-Spuren: meist gleich, sonst Auswahl per Maske über step_min..step_max
+        int step_min = max_step, step_max = 0;
+        for (int s = 0; s < BATCH_LANES; s++) {
+            int i = t.occupant[s];
+            if (i < 0 || !work[i].active || shared[where[s]] < 2) continue;
+            if (work[i].step_off < step_min) step_min = work[i].step_off;
+            if (work[i].step_off > step_max) step_max = work[i].step_off;
+        }
+        if (step_max < step_min) step_max = step_min;
+        for (int s = 0; s < BATCH_LANES; s++) {
+            int i = t.occupant[s];
+            bool a = i >= 0 && work[i].active && shared[where[s]] > 1;
+            active[s] = a ? -1 : 0;
+            keep[s] = (i >= 0 && !work[i].active && !lane[i].finished) ? -1 : 0;
+            live_ok[s] = (a && work[i].live_ok) ? -1 : 0;
+            step_off[s] = a ? work[i].step_off : step_min;
+            skip_off[s] = a ? work[i].skip_off : 0;
+            inv_live[s] = a ? work[i].inv_live_mag : 0.0f;
+            live_onset[s] = a ? work[i].onset : 0.0f;
+            w_start[s] = a ? work[i].start : 1;
+            w_end[s] = a ? work[i].end : 0;
+            for (int c = 0; c < NUM_CHROMA; c++) live[c][s] = a ? work[i].live[c] : 0.0f;
+        }
+        BatchFloat min_val = inf;
+        BatchInt best = splatInt(-1);
+
+        const float pen_wait = cfg.penalty_wait;
+        const float pen_step = cfg.penalty_step;
+        const float pen_skip = cfg.penalty_skip;
+        const float (*chroma)[NUM_CHROMA] = score->chroma;
+#if SCORE_HAS_ONSET
+        const float onset_weight = cfg.onset_weight;
+        const float* onset_track = score->onset;
+#endif
+        (void)live_onset;
+        const int skip_min = (step_min > 0) ? 2 * step_min : 1;
+
+        // --- SCHNELLE SCHLEIFE: ein Partitur-Frame, alle Spuren ---
+        // Jede Zeile von prev/curr ist genau ein BatchFloat. Alles ohne Sprünge: FLT_MAX + Strafe bzw.
+        // FLT_MAX + dist bleibt durch die Rundung FLT_MAX, Zellen außerhalb des Fensters werden maskiert.
+        uint64_t rows = 0;
+        for (int r = 0; r < n; r++) {
+            if (shared[r] < 2) continue;
+            rows += runHi[r] - runLo[r] + 1;
+            for (int j = runLo[r]; j <= runHi[r]; j++) {
+                const float* sc = chroma[j];
+                const float score_mag = magnitudes[j];
+                const float inv_score_mag = 1.0f / score_mag;
+
+                // Gleiche Akkumulatoren und Reihenfolge wie chromaDot<NUM_CHROMA> -> identische Ergebnisse
+                BatchFloat acc0 = splat(0.0f), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+                for (int q = 0; q < NUM_CHROMA / 4; q++) {
+                    acc0 += live[4 * q] * sc[4 * q];
+                    acc1 += live[4 * q + 1] * sc[4 * q + 1];
+                    acc2 += live[4 * q + 2] * sc[4 * q + 2];
+                    acc3 += live[4 * q + 3] * sc[4 * q + 3];
+                }
+                BatchFloat dot = (acc0 + acc1) + (acc2 + acc3);
+                BatchFloat sim = dot * inv_live * inv_score_mag;
+                sim = sim > one ? one : sim;
+                BatchInt ok = score_mag > 1e-9 ? live_ok : splatInt(0);
+                BatchFloat dist = ok ? one - sim : one;
+#if SCORE_HAS_ONSET
+                BatchFloat onset_diff = live_onset - onset_track[j];
+                onset_diff = onset_diff < 0.0f ? -onset_diff : onset_diff;
+                dist = (1.0f - onset_weight) * dist + onset_weight * onset_diff;
+#endif
+
+                BatchFloat wait = load(t.prev + row(j));
+                BatchFloat cost_step = load(t.prev + row(j - step_min));
+                BatchFloat cost_skip = load(t.prev + row(j - skip_min));
+                for (int k = step_min + 1; k <= step_max; k++) {
+                    BatchInt sel = step_off == k;
+                    cost_step = sel ? load(t.prev + row(j - k)) : cost_step;
+                    cost_skip = sel ? load(t.prev + row(j - 2 * k)) : cost_skip;
+                }
+                cost_step += pen_step;
+                cost_skip += pen_skip;
+                BatchFloat min_prev = wait + pen_wait;
+                min_prev = cost_step < min_prev ? cost_step : min_prev;
+                min_prev = cost_skip < min_prev ? cost_skip : min_prev;
+                BatchFloat v = dist + min_prev;
+
+                BatchInt jv = splatInt(j);
+                BatchInt inside = (jv >= w_start) & (jv <= w_end);
+                // Ruhende Spuren behalten ihre Spalte (Kopie), aktive rechnen nur im eigenen Fenster,
+                // beendete und leere Spuren bleiben FLT_MAX
+                store(t.curr + row(j), active ? (inside ? v : inf) : (keep ? wait : inf));
+                BatchInt better = inside & (v < min_val);
+                min_val = better ? v : min_val;
+                best = better ? jv : best;
+            }
+        }
+
+        // --- PATH LOSS CHECK ---
+        // Pfad verloren: Spalte bleibt wie sie war, kein Schritt (wie DTWTracker)
+        BatchInt lost = active & (best < 0);
+        for (int s = 0; s < BATCH_LANES; s++) {
+            if (!lost[s]) continue;
+            const BatchLane& l = lane[t.occupant[s]];
+            for (int j = l.last_start; j <= l.last_end; j++) t.curr[row(j) + s] = t.prev[row(j) + s];
+        }
+
+        // --- NORMALISIERUNG + KONKURRENT ---
+        BatchInt norm = active & ~lost;
+        BatchFloat rival = inf;
+        for (int r = 0; r < n; r++) {
+            if (shared[r] < 2) continue;
+            for (int j = runLo[r]; j <= runHi[r]; j++) {
+                BatchFloat c = load(t.curr + row(j));
+                BatchInt finite = norm & (c < inf);
+                BatchFloat v = c - min_val;
+                store(t.curr + row(j), finite ? v : c);
+                BatchInt d = splatInt(j) - best;
+                BatchInt far = (d > skip_off) | (d < -skip_off);
+                BatchInt closer = finite & far & (v < rival);
+                rival = closer ? v : rival;
+            }
+        }
+
+        // prev löschen: ganze Zeilen über die letzten Fenster der Spuren jedes Bereichs (alles gelesen,
+        // Lücken dazwischen sind ohnehin FLT_MAX)
+        for (int r = 0; r < n; r++) {
+            if (shared[r] < 2) continue;
+            int lo = score->len, hi = -1;
+            for (int s = 0; s < BATCH_LANES; s++) {
+                if (where[s] != r) continue;
+                const BatchLane& l = lane[t.occupant[s]];
+                if (l.last_start < lo) lo = l.last_start;
+                if (l.last_end > hi) hi = l.last_end;
+            }
+            for (int k = row(lo); k < row(hi + 1); k++) t.prev[k] = FLT_MAX;
+        }
+
+        for (int s = 0; s < BATCH_LANES; s++) {
+            if (!active[s]) continue;
+            LaneWork& w = work[t.occupant[s]];
+            w.best = best[s];
+            w.min_val = min_val[s];
+            w.rival = rival[s];
+        }
+        return rows * BATCH_LANES;
+    }
+
+    // Skalarer Pfad für die einzige aktive Spur eines Bereichs: dieselbe Rechnung wie DTWTracker::update()
+    // (chromaDot, gleiche Reihenfolge), auf Spalte s der Kachel
+    void updateSolo(Tile& t, int s) {
+        LaneWork& w = work[t.occupant[s]];
+        const float pen_wait = cfg.penalty_wait;
+        const float pen_step = cfg.penalty_step;
+        const float pen_skip = cfg.penalty_skip;
+        const float (*chroma)[NUM_CHROMA] = score->chroma;
+#if SCORE_HAS_ONSET
+        const float onset_weight = cfg.onset_weight;
+        const float* onset_track = score->onset;
+#endif
+        const int step_off = w.step_off;
+        const int skip_off = w.skip_off;
+        const float* prev = t.prev + s;
+        float* curr = t.curr + s;
+
+        float min_val = FLT_MAX;
+        int best = -1;
+        for (int j = w.start; j <= w.end; j++) {
+            float dot = chromaDot<NUM_CHROMA>(w.live, chroma[j]);
+            float score_mag = magnitudes[j];
+            float dist = 1.0f;
+            if (w.live_ok && score_mag > 1e-9) {
+                float sim = dot * w.inv_live_mag * (1.0f / score_mag);
+                if (sim > 1.0f) sim = 1.0f;
+                dist = 1.0f - sim;
+            }
+#if SCORE_HAS_ONSET
+            float onset_diff = w.onset - onset_track[j];
+            if (onset_diff < 0.0f) onset_diff = -onset_diff;
+            dist = (1.0f - onset_weight) * dist + onset_weight * onset_diff;
+#endif
+
+            // Zeilen vor Frame 0 (pad) sind FLT_MAX, das ersetzt "j >= step_off"
+            float cost_wait = prev[row(j)];
+            if (cost_wait < FLT_MAX) cost_wait += pen_wait;
+            float cost_step = FLT_MAX;
+            if (prev[row(j - step_off)] < FLT_MAX) cost_step = prev[row(j - step_off)] + pen_step;
+            float cost_skip = FLT_MAX;
+            if (prev[row(j - skip_off)] < FLT_MAX) cost_skip = prev[row(j - skip_off)] + pen_skip;
+
+            float min_prev = cost_wait;
+            if (cost_step < min_prev) min_prev = cost_step;
+            if (cost_skip < min_prev) min_prev = cost_skip;
+
+            if (min_prev >= FLT_MAX) {
+                curr[row(j)] = FLT_MAX;
+            } else {
+                curr[row(j)] = dist + min_prev;
+                if (curr[row(j)] < min_val) {
+                    min_val = curr[row(j)];
+                    best = j;
+                }
+            }
+        }
+
+        const BatchLane& l = lane[t.occupant[s]];
+        float rival = FLT_MAX;
+        if (best < 0) {
+            // Pfad verloren: Spalte bleibt wie sie war (wie im Vektor-Pfad)
+            for (int j = l.last_start; j <= l.last_end; j++) curr[row(j)] = prev[row(j)];
+        } else {
+            for (int j = w.start; j <= w.end; j++) {
+                if (curr[row(j)] < FLT_MAX) {
+                    curr[row(j)] -= min_val;
+                    int d = j - best;
+                    if ((d > skip_off || d < -skip_off) && curr[row(j)] < rival) rival = curr[row(j)];
+                }
+            }
+        }
+        for (int j = l.last_start; j <= l.last_end; j++) t.prev[row(j) + s] = FLT_MAX;
+        w.best = best;
+        w.min_val = min_val;
+        w.rival = rival;
+    }
+
+    void checkPageTurn(BatchLane& l) {
+        if (l.next_page_idx < score->num_pages) {
+            if (l.current_position >= score->page_ends[l.next_page_idx] - cfg.page_turn_offset) l.next_page_idx++;
+        } else {
+            if (l.current_position >= score->len - 5) l.finished = true;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include "Config.h"
+
+// Konfiguration
+#define CHECKPOINT_CELLS 64        // Gesicherte Kostenzellen um die Position (+/- 32 Frames)
+#define CHECKPOINT_INF 255         // Quantisierter Wert für "unerreichbar" (FLT_MAX)
+#define KEYFRAME_CELLS (2 * CONFIG_MAX_RADIUS + 1)   // Größtmögliches DTW-Fenster
+
+// Kompakter Tracker-Zustand für den Wiederanlauf nach Reset/Brown-out.
+// Die Kostenspalte wird nur im Kern des Fensters gesichert und auf 8 Bit quantisiert
+// (relativ zum Spalten-Minimum, das nach der Normalisierung 0 ist). Das reicht, damit der
+// Pfad nach dem Neustart an gleicher Stelle mit gleicher Präferenz weiterläuft.
+struct TrackerCheckpoint {
+    int32_t position;
+    int32_t window_start;          // Partitur-Index von cells[0]
+    float cost_scale;              // Kosten = cells[i] * cost_scale
+    float tempo;                   // Geschätztes Tempo relativ zur Partitur (1.0 = wie generiert)
+    uint32_t score_hash;           // scoreFingerprint() beim Sichern: neu übersetzte Partitur -> verwerfen
+    uint16_t next_page_idx;
+    uint8_t score_index;
+    uint8_t running;
+    uint8_t cells[CHECKPOINT_CELLS];
+};
+
+// FNV-1a über Länge, Seitenenden und Chroma einer Partitur. Der Slot (score_index) allein reicht nicht:
+// nach dem Flashen einer geänderten Partitur im selben Slot wäre jede Position im Bereich "gültig"
+inline uint32_t scoreFingerprint(const ScoreView& s) {
+    uint32_t h = 2166136261u;
+    auto mix = [&h](const void* data, size_t size) {
+        const uint8_t* p = (const uint8_t*)data;
+        for (size_t i = 0; i < size; i++) h = (h ^ p[i]) * 16777619u;
+    };
+    mix(&s.len, sizeof(s.len));
+    mix(&s.num_pages, sizeof(s.num_pages));
+    mix(s.page_ends, s.num_pages * sizeof(int));
+    mix(s.chroma, (size_t)s.len * NUM_CHROMA * sizeof(float));
+    return h;
+}
+
+// Vollständiger Tracker-Zustand für den Flight-Recorder (Recorder.h). Anders als der Checkpoint
+// verlustfrei: das ganze letzte Fenster in float plus Zeitraster-Akkumulator, damit ein Replay
+// ab diesem Keyframe bitgenau dieselben Entscheidungen trifft. Außerhalb des Fensters ist
+// prev_col immer FLT_MAX, das muss nicht gesichert werden.
+struct TrackerKeyframe {
+    uint32_t frame;                // Recorder-Frame, vor dessen update() der Zustand galt
+    int32_t position;
+    int32_t window_start;          // prev_col[window_start..window_end] = cells[...]
+    int32_t window_end;
+    int32_t rest_frames;
+    float tempo;
+    float advance_acc;
+    uint16_t next_page_idx;
+    uint8_t running;
+    uint8_t finished;
+    float cells[KEYFRAME_CELLS];
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stdint.h>
+#include <string.h>
+#include "Settings.h"
+#include "ScoreLibrary.h"
+
+#if SCORE_BEAT_SYNC
+#define DTW_RADIUS CALC_RADIUS_BEATS
+#define DTW_PAGE_OFFSET PAGE_TURN_OFFSET_BEATS
+#define SCORE_UNIT_HOPS SCORE_FRAMES_PER_BEAT
+#elif SCORE_FEATURE_CENS
+#define DTW_RADIUS CALC_RADIUS_CENS
+#define DTW_PAGE_OFFSET PAGE_TURN_OFFSET
+#define SCORE_UNIT_HOPS 1.0f
+#else
+#define DTW_RADIUS CALC_RADIUS
+#define DTW_PAGE_OFFSET PAGE_TURN_OFFSET
+#define SCORE_UNIT_HOPS 1.0f
+#endif
+
+#define CONFIG_MAX_RADIUS 400    // Obergrenze für "set radius" (Kosten linear im Radius)
+
+// Laufzeit-Parameter des Trackers. Die Makros in Settings.h sind nur noch die Standardwerte;
+// geändert wird über die Serial-Shell ("set penalty_wait 1.5"), gespeichert per "save" im EEPROM.
+// Klein und zusammenhängend, damit DTWTracker::update() einen Schnappschuss in Register laden kann.
+struct TrackerConfig {
+    float penalty_wait;
+    float penalty_step;
+    float penalty_skip;
+    float onset_weight;
+    float start_threshold;
+    int16_t radius;
+    int16_t page_turn_offset;
+    uint8_t score_index;
+    uint8_t reserved[3];
+};
+
+inline TrackerConfig defaultTrackerConfig() {
+    TrackerConfig c;
+    memset(&c, 0, sizeof(c));
+    c.penalty_wait = PENALTY_WAIT;
+    c.penalty_step = PENALTY_STEP;
+    c.penalty_skip = PENALTY_SKIP;
+    c.onset_weight = ONSET_WEIGHT;
+    c.start_threshold = START_THRESHOLD;
+    c.radius = DTW_RADIUS;
+    c.page_turn_offset = DTW_PAGE_OFFSET;
+    c.score_index = 0;
+    return c;
+}
+
+// Namens-Tabelle für get/set (genau eines von f/i gesetzt)
+struct ConfigParam {
+    const char* name;
+    float TrackerConfig::* f;
+    int16_t TrackerConfig::* i;
+    float min;
+    float max;
+};
+
+static const ConfigParam config_params[] = {
+    { "penalty_wait",     &TrackerConfig::penalty_wait,     nullptr, 0.0f, 10.0f },
+    { "penalty_step",     &TrackerConfig::penalty_step,     nullptr, 0.0f, 10.0f },
+    { "penalty_skip",     &TrackerConfig::penalty_skip,     nullptr, 0.0f, 10.0f },
+    { "onset_weight",     &TrackerConfig::onset_weight,     nullptr, 0.0f, 1.0f },
+    { "start_threshold",  &TrackerConfig::start_threshold,  nullptr, 1.0f, 1000.0f },
+    { "radius",           nullptr, &TrackerConfig::radius,           2.0f, CONFIG_MAX_RADIUS },
+    { "page_turn_offset", nullptr, &TrackerConfig::page_turn_offset, 0.0f, 1000.0f },
+};
+static const int config_param_count = sizeof(config_params) / sizeof(config_params[0]);
+
+inline const ConfigParam* findConfigParam(const char* name) {
+    for (int i = 0; i < config_param_count; i++) {
+        if (strcmp(config_params[i].name, name) == 0) return &config_params[i];
+    }
+    return nullptr;
+}
+
+inline float configGet(const TrackerConfig& c, const ConfigParam& p) {
+    return p.f ? c.*(p.f) : (float)(c.*(p.i));
+}
+
+// false -> Wert außerhalb des erlaubten Bereichs, Config bleibt unverändert
+inline bool configSet(TrackerConfig& c, const ConfigParam& p, float value) {
+    if (value < p.min || value > p.max) return false;
+    if (p.f) c.*(p.f) = value;
+    else c.*(p.i) = (int16_t)value;
+    return true;
+}
+
+#endif
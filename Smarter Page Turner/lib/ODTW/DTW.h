@@ -4,7 +4,9 @@
 #include <Arduino.h>
 #include <float.h> 
 #include "Settings.h"
-#include "ScoreData.h"
+#include "Config.h"
+#include "Checkpoint.h"
+#include "Distance.h"
 
 class DTWTracker {
 public:
@@ -12,55 +14,159 @@ public:
     int next_page_idx = 0;    
     bool finished = false;
     bool running = false;
+    int rest_frames = 0;      // Frames, in denen die Aktivitätserkennung pausiert hat
+    float tempo = 1.0f;       // Geglätteter Vorschub / nominaler Vorschub (1.0 = Partitur-Tempo)
+    float cost = 0.0f;        // Kosten des besten Pfads im letzten update() (vor der Normalisierung)
+    float confidence = 0.0f;  // Abstand zum besten Konkurrenz-Pfad, 0..1 (0 = mehrdeutig)
 
-    float* prev_col;
-    float* curr_col;
+    // Partitur-Frames pro Live-Frame, aus den echten Sampleraten abgeleitet (setFrameClock)
+    float frames_per_update = 1.0f;
+    // Live-Frames pro Partitur-Schlag (nur SCORE_BEAT_SYNC, für BeatAggregator::init)
+    float live_frames_per_beat = 0.0f;
+    // Suchradius zur Laufzeit (der FrameScheduler verkleinert ihn bei Überlast, max. cfg.radius)
+    int radius = DTW_RADIUS;
+
+    // Laufzeit-Parameter (Serial-Shell) und aktive Partitur
+    TrackerConfig cfg = defaultTrackerConfig();
+    const ScoreView* score = &score_library[0];
+    uint32_t score_hash = 0;     // scoreFingerprint(*score), prüft Checkpoints beim Wiederanlauf
+
+    float* prev_col = nullptr;
+    float* curr_col = nullptr;
     
     // NEU: Cache für die Längen der Vektoren
-    float* score_magnitudes; 
+    // Zeigt auf own_magnitudes oder auf die vorberechneten Werte der Partitur (ScoreView::magnitudes)
+    const float* score_magnitudes = nullptr; 
+    float* own_magnitudes = nullptr;
 
     void init() {
+        setFrameClock(SCORE_SAMPLE_RATE, FFT_SIZE);
+        setScore(&score_library[cfg.score_index < score_library_size ? cfg.score_index : 0]);
+    }
+
+    // Partitur wechseln: Spalten neu anlegen, Magnituden neu berechnen (oder aus der Partitur übernehmen),
+    // von vorne beginnen
+    void setScore(const ScoreView* view) {
+        score = view;
         if (prev_col) delete[] prev_col;
         if (curr_col) delete[] curr_col;
-        if (score_magnitudes) delete[] score_magnitudes;
-
-        prev_col = new float[score_len];
-        curr_col = new float[score_len];
-        score_magnitudes = new float[score_len];
-
-        // --- PRE-CALCULATION ---
-        // Wir berechnen die Länge (Magnitude) aller Vektoren der Partitur VORHER.
-        // Das spart 800 Wurzelberechnungen pro Sekunde!
-        Serial.println("Pre-Calculating Score Magnitudes...");
-        for (int i = 0; i < score_len; i++) {
-            float dot = 0.0f;
-            for (int k = 0; k < NUM_CHROMA; k++) {
-                dot += score_chroma[i][k] * score_chroma[i][k];
+        if (own_magnitudes) delete[] own_magnitudes;
+        own_magnitudes = nullptr;
+
+        prev_col = new float[score->len];
+        curr_col = new float[score->len];
+        score_hash = scoreFingerprint(*score);
+
+        if (score->magnitudes) {
+            // Aus dem ScoreStore: eingeblendet und zwischen Prozessen geteilt
+            score_magnitudes = score->magnitudes;
+        } else {
+            own_magnitudes = new float[score->len];
+
+            // --- PRE-CALCULATION ---
+            // Wir berechnen die Länge (Magnitude) aller Vektoren der Partitur VORHER.
+            // Das spart 800 Wurzelberechnungen pro Sekunde!
+            Serial.println("Pre-Calculating Score Magnitudes...");
+            for (int i = 0; i < score->len; i++) {
+                float dot = chromaDot<NUM_CHROMA>(score->chroma[i], score->chroma[i]);
+                own_magnitudes[i] = sqrt(dot);
             }
-            score_magnitudes[i] = sqrt(dot);
+            score_magnitudes = own_magnitudes;
         }
 
         reset();
     }
 
+    // Neue Parameter übernehmen (zwischen zwei Frames, nie während update())
+    void setConfig(const TrackerConfig& c) {
+        cfg = c;
+        setRadius(cfg.radius);
+    }
+
+    // Live-Zeitraster: live_frame_samples Samples bei live_sample_rate pro update().
+    // Teensy: 4096 Samples bei 44117.647 Hz gegen Partitur-Hop 512 bei 44100 Hz
+    // -> 8.0027 Partitur-Frames pro Update. Ohne diese Umrechnung läuft der Tracker davon.
+    // Im Schlag-Raster ist jedes update() ein Schlag-Segment -> Vorschub 1 Schlag pro erwarteter
+    // Segmentlänge; die tatsächliche Länge kommt über advance in update().
+    void setFrameClock(float live_sample_rate, int live_frame_samples) {
+        float live_seconds = live_frame_samples / live_sample_rate;
+        float score_seconds = SCORE_HOP_LENGTH / SCORE_SAMPLE_RATE;
+#if SCORE_BEAT_SYNC
+        frames_per_update = 1.0f;
+        live_frames_per_beat = SCORE_FRAMES_PER_BEAT * score_seconds / live_seconds;
+#else
+        frames_per_update = live_seconds / score_seconds;
+#endif
+    }
+
+    // Sekunden Partitur-Zeit für einen Index (Frame bzw. Schlag, z.B. für Ausgaben)
+    float frameToSeconds(int frame) const {
+        return frame * SCORE_UNIT_HOPS * (SCORE_HOP_LENGTH / SCORE_SAMPLE_RATE);
+    }
+
     void reset() {
         current_position = 0;
         next_page_idx = 0;
         finished = false;
         running = false;
+        rest_frames = 0;
+        tempo = 1.0f;
+        cost = 0.0f;
+        confidence = 0.0f;
+        advance_acc = 0.0f;
+        last_start = 0;
+        last_end = 0;
 
-        for (int i = 0; i < score_len; i++) {
+        for (int i = 0; i < score->len; i++) {
             prev_col[i] = FLT_MAX;
             curr_col[i] = FLT_MAX;
         }
         prev_col[0] = 0.0f;
     }
 
-    void update(float* live_chroma, float volume) {
+    // Position von Hand setzen (z.B. Probe ab Takt X): Pfad startet neu bei frame
+    void seek(int frame) {
+        if (frame < 0) frame = 0;
+        if (frame >= score->len) frame = score->len - 1;
+        for (int i = 0; i < score->len; i++) {
+            prev_col[i] = FLT_MAX;
+            curr_col[i] = FLT_MAX;
+        }
+        prev_col[frame] = 0.0f;
+        last_start = frame;
+        last_end = frame;
+        advance_acc = 0.0f;
+        current_position = frame;
+        finished = false;
+        // Bereits vergangene Seiten nicht nochmal blättern
+        next_page_idx = 0;
+        while (next_page_idx < score->num_pages &&
+               frame >= score->page_ends[next_page_idx] - cfg.page_turn_offset) next_page_idx++;
+    }
+
+    // snr: Spektrum / Rauschboden aus AudioDSP::getSnr(), unabhängig von Mikrofon-Gain und Raum
+    // live_onset: AudioDSP::getOnset(), verankert den Pfad bei Tonwiederholungen und langen Tönen
+    // advance: nominaler Vorschub in Vielfachen von frames_per_update (Schlag-Raster: Segmentlänge
+    // durch live_frames_per_beat, TrackStage::advance; sonst 1)
+    void update(float* live_chroma, float snr, float live_onset = 0.0f, float advance = 1.0f) {
         if (finished) return;
 
+        // --- PARAMETER-SCHNAPPSCHUSS ---
+        // Lokale Kopien landen in Registern; die Zellen-Schleife liest nie aus cfg/score
+        const float pen_wait = cfg.penalty_wait;
+        const float pen_step = cfg.penalty_step;
+        const float pen_skip = cfg.penalty_skip;
+        const float (*chroma)[NUM_CHROMA] = score->chroma;
+        const int len = score->len;
+#if SCORE_HAS_ONSET
+        const float onset_weight = cfg.onset_weight;
+        const float* onset_track = score->onset;
+#else
+        (void)live_onset;
+#endif
+
         if (!running) {
-            if (volume > START_THRESHOLD) {
+            if (snr > cfg.start_threshold) {
                 running = true;
                 Serial.println(">>> START DTW <<<");
             } else {
@@ -69,19 +175,24 @@ public:
         }
 
         // --- OPTIMIERUNG TEIL 2: Live Magnitude nur 1x berechnen ---
-        float live_dot = 0.0f;
-        for (int k = 0; k < NUM_CHROMA; k++) {
-            live_dot += live_chroma[k] * live_chroma[k];
-        }
+        float live_dot = chromaDot<NUM_CHROMA>(live_chroma, live_chroma);
         float live_mag = sqrt(live_dot);
         // Vorberechnung der Division (Multiplikation ist schneller)
         float inv_live_mag = (live_mag > 1e-9) ? (1.0f / live_mag) : 0.0f;
 
+        // --- ZEITRASTER ---
+        // Nominaler Vorschub in Partitur-Frames für diesen Live-Frame (Bresenham über den Bruchteil)
+        const float nominal = frames_per_update * advance;
+        advance_acc += nominal;
+        int step_off = (int)advance_acc;
+        advance_acc -= step_off;
+        int skip_off = (step_off > 0) ? 2 * step_off : 1;
+
         // Windowing
-        int start_idx = current_position - CALC_RADIUS;
-        int end_idx = current_position + CALC_RADIUS;
+        int start_idx = current_position - radius;
+        int end_idx = current_position + radius;
         if (start_idx < 0) start_idx = 0;
-        if (end_idx >= score_len) end_idx = score_len - 1;
+        if (end_idx >= len) end_idx = len - 1;
 
         float min_val_in_col = FLT_MAX;
         int best_idx_in_col = -1;
@@ -91,10 +202,7 @@ public:
             
             // 1. Distanz (Optimiert)
             // Wir machen hier KEIN sqrt mehr! Wir nutzen die vorberechneten Werte.
-            float dot = 0.0f;
-            for (int k = 0; k < NUM_CHROMA; k++) {
-                dot += live_chroma[k] * score_chroma[j][k];
-            }
+            float dot = chromaDot<NUM_CHROMA>(live_chroma, chroma[j]);
             
             float score_mag = score_magnitudes[j];
             float dist = 1.0f;
@@ -107,15 +215,22 @@ public:
                 dist = 1.0f - sim;
             }
 
+#if SCORE_HAS_ONSET
+            // Onset-Term: Einsätze im Live-Signal sollen auf Einsätze der Partitur fallen
+            float onset_diff = live_onset - onset_track[j];
+            if (onset_diff < 0.0f) onset_diff = -onset_diff;
+            dist = (1.0f - onset_weight) * dist + onset_weight * onset_diff;
+#endif
+
             // 2. Kosten (Wie vorher)
             float cost_wait = prev_col[j];
-            if (cost_wait < FLT_MAX) cost_wait += PENALTY_WAIT;
+            if (cost_wait < FLT_MAX) cost_wait += pen_wait;
 
             float cost_step = FLT_MAX;
-            if (j > 0 && prev_col[j-1] < FLT_MAX) cost_step = prev_col[j-1] + PENALTY_STEP;
+            if (j >= step_off && prev_col[j-step_off] < FLT_MAX) cost_step = prev_col[j-step_off] + pen_step;
 
             float cost_skip = FLT_MAX;
-            if (j > 1 && prev_col[j-2] < FLT_MAX) cost_skip = prev_col[j-2] + PENALTY_SKIP;
+            if (j >= skip_off && prev_col[j-skip_off] < FLT_MAX) cost_skip = prev_col[j-skip_off] + pen_skip;
 
             // 3. Minimum
             float min_prev = cost_wait;
@@ -141,31 +256,156 @@ public:
         }
 
         // --- NORMALISIERUNG ---
+        // Nebenbei: bester Konkurrent außerhalb der Skip-Nachbarschaft -> Konfidenz
+        float rival = FLT_MAX;
         for (int j = start_idx; j <= end_idx; j++) {
-            if (curr_col[j] < FLT_MAX) curr_col[j] -= min_val_in_col;
+            if (curr_col[j] < FLT_MAX) {
+                curr_col[j] -= min_val_in_col;
+                int d = j - best_idx_in_col;
+                if ((d > skip_off || d < -skip_off) && curr_col[j] < rival) rival = curr_col[j];
+            }
         }
+        cost = min_val_in_col;
+        confidence = (rival < FLT_MAX) ? rival / (rival + 1.0f) : 1.0f;
 
         // --- SWAP ---
+        // Der alte prev_col enthält nur Werte aus dem Fenster des letzten Updates -> genau das löschen
         float* temp = prev_col;
         prev_col = curr_col;
         curr_col = temp;
-        for (int j = start_idx; j <= end_idx; j++) curr_col[j] = FLT_MAX;
+        for (int j = last_start; j <= last_end; j++) curr_col[j] = FLT_MAX;
+        last_start = start_idx;
+        last_end = end_idx;
+
+        // Tempo-Schätzung: tatsächlicher gegen nominalen Vorschub
+        if (nominal > 0.0f) {
+            float ratio = (best_idx_in_col - current_position) / nominal;
+            tempo += TEMPO_SMOOTH * (ratio - tempo);
+        }
 
         current_position = best_idx_in_col;
         checkPageTurn();
     }
 
+    // --- CHECKPOINT ---
+    // Zustand sichern: Position, Seite, Tempo und CHECKPOINT_CELLS quantisierte Kostenzellen
+    void saveCheckpoint(TrackerCheckpoint& cp) const {
+        int start = current_position - CHECKPOINT_CELLS / 2;
+        if (start > score->len - CHECKPOINT_CELLS) start = score->len - CHECKPOINT_CELLS;
+        if (start < 0) start = 0;
+
+        float max_cost = 0.0f;
+        for (int i = 0; i < CHECKPOINT_CELLS && start + i < score->len; i++) {
+            float c = prev_col[start + i];
+            if (c < FLT_MAX && c > max_cost) max_cost = c;
+        }
+        float scale = (max_cost > 0.0f) ? max_cost / (CHECKPOINT_INF - 1) : 1.0f;
+
+        memset(&cp, 0, sizeof(cp));
+        cp.position = current_position;
+        cp.window_start = start;
+        cp.cost_scale = scale;
+        cp.tempo = tempo;
+        cp.next_page_idx = next_page_idx;
+        cp.score_index = cfg.score_index;
+        cp.score_hash = score_hash;
+        cp.running = running;
+        for (int i = 0; i < CHECKPOINT_CELLS; i++) {
+            float c = (start + i < score->len) ? prev_col[start + i] : FLT_MAX;
+            cp.cells[i] = (c < FLT_MAX) ? (uint8_t)(c / scale + 0.5f) : CHECKPOINT_INF;
+        }
+    }
+
+    // Zustand wiederherstellen; false, wenn der Checkpoint nicht zur aktiven Partitur passt
+    bool restoreCheckpoint(const TrackerCheckpoint& cp) {
+        if (cp.score_index != cfg.score_index || cp.score_hash != score_hash) return false;
+        if (cp.position < 0 || cp.position >= score->len) return false;
+        if (cp.window_start < 0 || cp.next_page_idx > score->num_pages) return false;
+
+        reset();
+        prev_col[0] = FLT_MAX;
+        int end = cp.window_start;
+        for (int i = 0; i < CHECKPOINT_CELLS && cp.window_start + i < score->len; i++) {
+            end = cp.window_start + i;
+            prev_col[end] = (cp.cells[i] == CHECKPOINT_INF) ? FLT_MAX : cp.cells[i] * cp.cost_scale;
+        }
+        last_start = cp.window_start;
+        last_end = end;
+        current_position = cp.position;
+        next_page_idx = cp.next_page_idx;
+        tempo = cp.tempo;
+        running = cp.running;
+        return true;
+    }
+
+    // --- KEYFRAME (Flight-Recorder) ---
+    void saveKeyframe(TrackerKeyframe& kf) const {
+        kf.position = current_position;
+        kf.window_start = last_start;
+        kf.window_end = last_end;
+        kf.rest_frames = rest_frames;
+        kf.tempo = tempo;
+        kf.advance_acc = advance_acc;
+        kf.next_page_idx = next_page_idx;
+        kf.running = running;
+        kf.finished = finished;
+        for (int j = last_start; j <= last_end; j++) kf.cells[j - last_start] = prev_col[j];
+    }
+
+    bool restoreKeyframe(const TrackerKeyframe& kf) {
+        if (kf.window_start < 0 || kf.window_end >= score->len || kf.window_end < kf.window_start ||
+            kf.window_end - kf.window_start >= KEYFRAME_CELLS) return false;
+
+        reset();
+        prev_col[0] = FLT_MAX;
+        for (int j = kf.window_start; j <= kf.window_end; j++) prev_col[j] = kf.cells[j - kf.window_start];
+        last_start = kf.window_start;
+        last_end = kf.window_end;
+        current_position = kf.position;
+        rest_frames = kf.rest_frames;
+        tempo = kf.tempo;
+        advance_acc = kf.advance_acc;
+        next_page_idx = kf.next_page_idx;
+        running = kf.running;
+        finished = kf.finished;
+        return true;
+    }
+
+    // Kleinster wirksamer Radius: der Skip-Übergang (2x Vorschub) muss noch im Fenster liegen
+    int minRadius() const { return 2 * (int)ceilf(frames_per_update) + 2; }
+
+    // Radius ändern; Werte außerhalb des neuen Fensters sind über last_start/last_end weiter erfasst.
+    void setRadius(int r) {
+        int min_r = minRadius();
+        if (r > cfg.radius) r = cfg.radius;
+        if (r < min_r) r = min_r;
+        radius = r;
+    }
+
+    // Pause (Aktivitätserkennung meldet Stille): keine FFT, keine DTW-Spalte.
+    // Die Kostenspalte bleibt eingefroren, damit leise Frames den Pfad nicht
+    // über penalty_wait verschieben. Nach der Pause geht es an gleicher Stelle weiter.
+    void rest() {
+        if (!running || finished) return;
+        rest_frames++;
+    }
+
 private:
+    float advance_acc = 0.0f;
+    int last_start = 0;       // Fenster, dessen Werte in prev_col stehen
+    int last_end = 0;
+
     void checkPageTurn() {
-        if (next_page_idx < num_pages) {
-            int target = page_end_indices[next_page_idx];
-            if (current_position >= (target - PAGE_TURN_OFFSET)) {
-                Serial1.print('n'); 
+        if (next_page_idx < score->num_pages) {
+            int target = score->page_ends[next_page_idx];
+            if (current_position >= (target - cfg.page_turn_offset)) {
+                for (int i = 0; i < LINK_WAKE_PREAMBLE; i++) Serial1.write((uint8_t)LINK_WAKE_BYTE);
+                Serial1.print('n');
                 Serial.println("\n!!! BLÄTTERN !!!\n");
                 next_page_idx++;
             }
         } else {
-            if (current_position >= score_len - 5) finished = true;
+            if (current_position >= score->len - 5) finished = true;
         }
     }
 };
@@ -0,0 +1,45 @@
+#ifndef DISTANCE_H
+#define DISTANCE_H
+
+// Skalarprodukt zweier Chroma-Vektoren, spezialisiert pro Breite (12, 24, 36 Bins).
+// Vier unabhängige Akkumulatoren pro "Quad" (4 Floats): die FPU des M7 kann
+// so jede Multiplikation starten, ohne auf das vorherige Ergebnis zu warten.
+//   12 Bins = 3 Quads, 24 Bins = 6 Quads, 36 Bins = 9 Quads
+// Kosten sind damit linear und vorhersagbar (siehe src/bench_dtw.cpp).
+
+#define CHROMA_QUAD(q)                      \
+    acc0 += a[4 * (q) + 0] * b[4 * (q) + 0]; \
+    acc1 += a[4 * (q) + 1] * b[4 * (q) + 1]; \
+    acc2 += a[4 * (q) + 2] * b[4 * (q) + 2]; \
+    acc3 += a[4 * (q) + 3] * b[4 * (q) + 3];
+
+template <int N>
+inline float chromaDot(const float* a, const float* b);
+
+template <>
+inline float chromaDot<12>(const float* a, const float* b) {
+    float acc0 = 0.0f, acc1 = 0.0f, acc2 = 0.0f, acc3 = 0.0f;
+    CHROMA_QUAD(0) CHROMA_QUAD(1) CHROMA_QUAD(2)
+    return (acc0 + acc1) + (acc2 + acc3);
+}
+
+template <>
+inline float chromaDot<24>(const float* a, const float* b) {
+    float acc0 = 0.0f, acc1 = 0.0f, acc2 = 0.0f, acc3 = 0.0f;
+    CHROMA_QUAD(0) CHROMA_QUAD(1) CHROMA_QUAD(2)
+    CHROMA_QUAD(3) CHROMA_QUAD(4) CHROMA_QUAD(5)
+    return (acc0 + acc1) + (acc2 + acc3);
+}
+
+template <>
+inline float chromaDot<36>(const float* a, const float* b) {
+    float acc0 = 0.0f, acc1 = 0.0f, acc2 = 0.0f, acc3 = 0.0f;
+    CHROMA_QUAD(0) CHROMA_QUAD(1) CHROMA_QUAD(2)
+    CHROMA_QUAD(3) CHROMA_QUAD(4) CHROMA_QUAD(5)
+    CHROMA_QUAD(6) CHROMA_QUAD(7) CHROMA_QUAD(8)
+    return (acc0 + acc1) + (acc2 + acc3);
+}
+
+#undef CHROMA_QUAD
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <stdint.h>
+#include <string.h>
+#include "DTW.h"
+
+// Konfiguration
+#define RECORDER_FRAMES 256              // Ringgröße: 256 x 92.9 ms = ~24 s
+#define RECORDER_KEYFRAME_INTERVAL 64    // Voller Tracker-Zustand alle 64 Frames
+#define RECORDER_KEYFRAMES (RECORDER_FRAMES / RECORDER_KEYFRAME_INTERVAL + 1)
+#define RECORDER_MAGIC 0x43455246UL      // "FREC" im Speicher (Little Endian)
+#define RECORDER_VERSION 2
+
+// Frame-Flags
+#define REC_UPDATE    0x01   // tracker.update() mit chroma/snr/onset aufgerufen
+#define REC_REST      0x02   // tracker.rest() (Pause)
+#define REC_PAGE_TURN 0x04   // In diesem Frame wurde geblättert
+#define REC_ACTIVE    0x08   // Aktivitätserkennung offen (chroma = Live-Chroma)
+
+// Ein Live-Frame: Eingaben des Trackers (exakt wie an update() übergeben) und seine Entscheidung
+struct RecorderFrame {
+    uint32_t frame;
+    uint32_t millis;
+    float volume;
+    float snr;
+    float onset;
+    float advance;             // Vorschub-Faktor (Schlag-Raster: Schläge im Segment)
+    float cost;
+    float confidence;
+    int32_t position;          // Position nach dem Frame
+    int16_t radius;            // Radius während des Frames (Degradation)
+    uint8_t flags;
+    uint8_t page;              // next_page_idx nach dem Frame
+    float chroma[NUM_CHROMA];
+};
+
+// Kopf des Binär-Dumps; danach keyframe_count x TrackerKeyframe und frame_count x RecorderFrame
+// (chronologisch). Alle Werte Little Endian wie auf Teensy und PC.
+struct RecorderHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t num_chroma;
+    uint16_t keyframe_cells;
+    uint16_t frame_count;
+    uint16_t keyframe_count;
+    uint8_t score_index;
+    uint8_t beat_sync;
+    float frames_per_update;
+    TrackerConfig cfg;
+};
+
+// Speicher der Ringe (~39 KB). Auf dem Teensy als DMAMEM-Variable (RAM2) anlegen, nicht neben Partitur,
+// FeatureStage und Code in RAM1. DMAMEM wird beim Booten nicht initialisiert; das braucht es auch nicht,
+// gültig ist nur, was der Recorder über seine Zähler selbst geschrieben hat.
+struct RecorderRings {
+    RecorderFrame frames[RECORDER_FRAMES];
+    TrackerKeyframe keyframes[RECORDER_KEYFRAMES];
+};
+
+// Flight-Recorder: hält die letzten RECORDER_FRAMES Frames im RAM. Bei einem Auslöser
+// (Taster, 'p' vom ESP32, Befehl "dump") wird der Ring eingefroren und binär ausgegeben.
+// Keyframes mit dem vollen Tracker-Zustand erlauben es, den Ring auf dem PC durch denselben
+// DTWTracker zu schicken (host_replay --dump) und jede Entscheidung nachzuvollziehen.
+class FlightRecorder {
+public:
+    explicit FlightRecorder(RecorderRings& rings) : frame_ring(rings.frames), keyframe_ring(rings.keyframes) {}
+
+    bool frozen = false;
+
+    void reset() {
+        frames = 0;
+        keyframes = 0;
+        frozen = false;
+    }
+
+    // Zu Beginn jedes Frames, vor update()/rest()
+    void beginFrame(const DTWTracker& tracker) {
+        if (frozen) return;
+        if (frames % RECORDER_KEYFRAME_INTERVAL == 0) {
+            TrackerKeyframe& kf = keyframe_ring[keyframes % RECORDER_KEYFRAMES];
+            tracker.saveKeyframe(kf);
+            kf.frame = frames;
+            keyframes++;
+        }
+    }
+
+    // Frame-Datensatz zum Befüllen; frame/radius sind schon gesetzt
+    RecorderFrame& current(const DTWTracker& tracker) {
+        RecorderFrame& f = frozen ? scratch : frame_ring[frames % RECORDER_FRAMES];
+        memset(&f, 0, sizeof(f));
+        f.frame = frames;
+        f.radius = tracker.radius;
+        return f;
+    }
+
+    // Eingaben eines update()-Aufrufs festhalten (nach CENS bzw. Schlag-Mittelung)
+    static void noteUpdate(RecorderFrame& f, const float* chroma, float snr, float onset, float advance) {
+        memcpy(f.chroma, chroma, sizeof(f.chroma));
+        f.snr = snr;
+        f.onset = onset;
+        f.advance = advance;
+        f.flags |= REC_UPDATE;
+    }
+
+    // Am Ende des Frames: Entscheidung des Trackers eintragen und weiterschalten
+    void endFrame(const DTWTracker& tracker, RecorderFrame& f, int page_before) {
+        f.position = tracker.current_position;
+        f.page = tracker.next_page_idx;
+        if (tracker.next_page_idx != page_before) f.flags |= REC_PAGE_TURN;
+        if (f.flags & REC_UPDATE) {
+            f.cost = tracker.cost;
+            f.confidence = tracker.confidence;
+        }
+        if (!frozen) frames++;
+    }
+
+    uint32_t getFrames() const { return frames; }
+
+    // Anzahl gültiger Frames im Ring und Index des ältesten
+    int count() const { return frames < RECORDER_FRAMES ? frames : RECORDER_FRAMES; }
+    uint32_t first() const { return frames - count(); }
+
+    // --- DUMP ---
+    // Out braucht write(const uint8_t*, size_t) (Serial, File, ...)
+    template <typename Out>
+    size_t dump(Out& out, const DTWTracker& tracker) {
+        // Erster Keyframe, ab dem alle Frames noch im Ring liegen
+        int k0 = firstKeyframe();
+        uint32_t start = (k0 >= 0) ? keyframe_ring[k0 % RECORDER_KEYFRAMES].frame : frames;
+        int kcount = (k0 >= 0) ? keyframes - k0 : 0;
+
+        RecorderHeader h;
+        memset(&h, 0, sizeof(h));
+        h.magic = RECORDER_MAGIC;
+        h.version = RECORDER_VERSION;
+        h.num_chroma = NUM_CHROMA;
+        h.keyframe_cells = KEYFRAME_CELLS;
+        h.frame_count = frames - start;
+        h.keyframe_count = kcount;
+        h.score_index = tracker.cfg.score_index;
+        h.beat_sync = SCORE_BEAT_SYNC;
+        h.frames_per_update = tracker.frames_per_update;
+        h.cfg = tracker.cfg;
+
+        size_t n = out.write((const uint8_t*)&h, sizeof(h));
+        for (int k = k0; k >= 0 && k < (int)keyframes; k++) {
+            n += out.write((const uint8_t*)&keyframe_ring[k % RECORDER_KEYFRAMES], sizeof(TrackerKeyframe));
+        }
+        for (uint32_t i = start; i < frames; i++) {
+            n += out.write((const uint8_t*)&frame_ring[i % RECORDER_FRAMES], sizeof(RecorderFrame));
+        }
+        return n;
+    }
+
+    // Größe des nächsten Dumps in Bytes
+    size_t dumpSize() const {
+        int k0 = firstKeyframe();
+        if (k0 < 0) return sizeof(RecorderHeader);
+        uint32_t start = keyframe_ring[k0 % RECORDER_KEYFRAMES].frame;
+        return sizeof(RecorderHeader) + (keyframes - k0) * sizeof(TrackerKeyframe) +
+               (frames - start) * sizeof(RecorderFrame);
+    }
+
+private:
+    RecorderFrame* frame_ring;
+    TrackerKeyframe* keyframe_ring;
+    RecorderFrame scratch;     // Ziel während eingefroren
+    uint32_t frames = 0;
+    uint32_t keyframes = 0;
+
+    // Ältester Keyframe, der noch im Ring liegt und dessen Frame noch aufgezeichnet ist
+    int firstKeyframe() const {
+        if (keyframes == 0) return -1;
+        int k = (keyframes > RECORDER_KEYFRAMES) ? keyframes - RECORDER_KEYFRAMES : 0;
+        for (; k < (int)keyframes; k++) {
+            if (keyframe_ring[k % RECORDER_KEYFRAMES].frame >= first()) return k;
+        }
+        return -1;
+    }
+};
+
+#endif
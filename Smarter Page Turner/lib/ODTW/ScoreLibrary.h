@@ -0,0 +1,79 @@
+#ifndef SCORE_LIBRARY_H
+#define SCORE_LIBRARY_H
+
+#include "Settings.h"
+#include "ScoreData.h"
+
+// Ältere ScoreData.h ohne Breitenangabe haben 12 Bins
+#ifndef SCORE_NUM_CHROMA
+#define SCORE_NUM_CHROMA 12
+#endif
+static_assert(SCORE_NUM_CHROMA == NUM_CHROMA,
+              "ScoreData.h wurde mit anderer Chroma-Breite erzeugt (--bins) als NUM_CHROMA");
+
+// Partituren ohne Feature-Angabe sind klassisches chroma_stft
+#ifndef SCORE_FEATURE_CENS
+#define SCORE_FEATURE_CENS 0
+#endif
+
+// Onset-Spur (score_onset[]) ist optional
+#ifndef SCORE_HAS_ONSET
+#define SCORE_HAS_ONSET 0
+#endif
+
+// Zeitraster der Partitur (chroma_builder.py: SAMPLE_RATE, HOP_LENGTH)
+#ifndef SCORE_SAMPLE_RATE
+#define SCORE_SAMPLE_RATE 44100.0f
+#endif
+#ifndef SCORE_HOP_LENGTH
+#define SCORE_HOP_LENGTH 512
+#endif
+
+// Schlag-Raster: ein Partitur-Eintrag = ein notierter Schlag (SCORE_FRAMES_PER_BEAT Hops)
+#ifndef SCORE_BEAT_SYNC
+#define SCORE_BEAT_SYNC 0
+#endif
+#ifndef SCORE_FRAMES_PER_BEAT
+#define SCORE_FRAMES_PER_BEAT 1.0f
+#endif
+
+#ifndef SCORE_NAME
+#define SCORE_NAME "ScoreData"
+#endif
+
+// Sicht auf eine Partitur im Flash. Der Tracker arbeitet nur über diese Struktur,
+// damit zur Laufzeit zwischen mehreren eingebundenen Partituren gewechselt werden kann.
+struct ScoreView {
+    const char* name;
+    const float (*chroma)[NUM_CHROMA];
+    const float* onset;          // nullptr ohne Onset-Spur
+    int len;
+    const int* page_ends;
+    int num_pages;
+    const float* magnitudes = nullptr;   // Vorberechnete |chroma[i]| (ScoreStore), sonst rechnet der Tracker
+};
+
+// Weitere Partituren: generate_score_data.py ... --header --symbol stueck
+//   -> stueck.h mit allem in namespace stueck { ... }, nach lib/ODTW kopieren und unten eintragen:
+//   #include "stueck.h"
+//   SCORE_CHECK(stueck)
+//   ... und SCORE_ENTRY(stueck) in score_library[]
+// Feature-Typ, Onset-Spur und Raster müssen zur Haupt-Partitur passen (Firmware-Pfad ist fest).
+#define SCORE_CHECK(sym)                                                               \
+    static_assert(sym::num_chroma == NUM_CHROMA, #sym ": falsche Chroma-Breite");      \
+    static_assert(sym::feature_cens == SCORE_FEATURE_CENS, #sym ": anderer Feature-Typ"); \
+    static_assert(sym::has_onset == SCORE_HAS_ONSET, #sym ": Onset-Spur passt nicht"); \
+    static_assert(sym::beat_sync == SCORE_BEAT_SYNC, #sym ": Raster passt nicht");
+#define SCORE_ENTRY(sym) \
+    { sym::name, sym::score_chroma, sym::onset_track, sym::score_len, sym::page_end_indices, sym::num_pages }
+
+static const ScoreView score_library[] = {
+#if SCORE_HAS_ONSET
+    { SCORE_NAME, score_chroma, score_onset, score_len, page_end_indices, num_pages },
+#else
+    { SCORE_NAME, score_chroma, nullptr, score_len, page_end_indices, num_pages },
+#endif
+};
+static const int score_library_size = sizeof(score_library) / sizeof(score_library[0]);
+
+#endif
@@ -0,0 +1,226 @@
+#ifndef SCORE_STORE_H
+#define SCORE_STORE_H
+
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Settings.h"
+#include "ScoreLibrary.h"
+
+// Partitur-Speicher für Host-Prozesse (host_daemon, host_server): ein Verzeichnis mit
+//   index.spti         Kopf + ein Eintrag pro Partitur (Name, Lage in der Datendatei)
+//   scores-<gen>.spts  Partituren im Binärformat hintereinander, jede auf 64 Byte ausgerichtet
+// Beides wird nur gelesen und per mmap(MAP_SHARED) eingeblendet: die Chroma-Matrix, die vorberechneten
+// Magnituden und die Onset-Spur liegen direkt in den Seiten des Page-Cache, ScoreView zeigt hinein.
+// Alle Prozesse, die denselben Speicher öffnen, teilen sich diese Seiten; Start kostet nur das
+// Einblenden (kein Parsen, keine Wurzeln), der Tracker legt nur noch seine zwei Spalten an.
+// Geschrieben wird der Speicher von "Score Pipeline/score_store.py" (bzw. generate_score_data.py --store):
+// neue Datendatei unter neuem Namen, dann index.spti per rename() ersetzen. Laufende Prozesse behalten
+// ihre Abbildung der alten Datei, neue sehen den neuen Stand. Der Schreiber lässt die zwei vorigen
+// Datendateien liegen; fehlt die Datendatei trotzdem (Index gelesen, dann zweimal neu geschrieben),
+// liest open() den Index erneut.
+// Nur POSIX (Linux/macOS), auf dem Teensy gibt es weiter nur die eingebundene score_library.
+
+#define SCORE_STORE_MAX 64
+#define SCORE_STORE_INDEX "index.spti"
+#define SCORE_STORE_VERSION 1
+#define SCORE_STORE_ALIGN 64
+#define SCORE_STORE_RETRIES 3   // Versuche, wenn die Datendatei zwischen Index und Öffnen verschwindet
+
+// Eigenschaften einer Partitur (ScoreFileHeader::flags, ScoreIndexEntry::flags)
+#define SCORE_FLAG_CENS 0x01
+#define SCORE_FLAG_ONSET 0x02
+#define SCORE_FLAG_BEAT_SYNC 0x04
+
+// --- BINÄRFORMAT (little-endian) ---
+// Eine Partitur: Kopf, dann die Abschnitte an den angegebenen Offsets (relativ zum Kopf)
+struct ScoreFileHeader {
+    char magic[4];              // "SPTS"
+    uint32_t version;
+    uint32_t num_chroma;
+    uint32_t len;               // Partitur-Frames (bzw. Schläge)
+    uint32_t num_pages;
+    uint32_t flags;
+    float sample_rate;          // Raster wie SCORE_SAMPLE_RATE / SCORE_HOP_LENGTH
+    uint32_t hop_length;
+    float frames_per_beat;      // Nur mit SCORE_FLAG_BEAT_SYNC
+    uint32_t chroma_offset;     // float[len][num_chroma]
+    uint32_t magnitude_offset;  // float[len], |chroma[i]| (wie DTWTracker::setScore)
+    uint32_t onset_offset;      // float[len], 0 ohne Onset-Spur
+    uint32_t pages_offset;      // int32[num_pages]
+    uint32_t reserved[3];
+    char name[64];              // Nullterminiert
+};
+static_assert(sizeof(ScoreFileHeader) == 128, "ScoreFileHeader: Layout muss zu score_writer.py passen");
+
+struct ScoreIndexHeader {
+    char magic[4];              // "SPTI"
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+    char data_file[48];         // Name der Datendatei im selben Verzeichnis
+};
+static_assert(sizeof(ScoreIndexHeader) == 64, "ScoreIndexHeader: Layout muss zu score_writer.py passen");
+
+struct ScoreIndexEntry {
+    char name[64];
+    uint64_t offset;            // Lage des ScoreFileHeader in der Datendatei
+    uint64_t size;
+    uint32_t len;
+    uint32_t num_chroma;
+    uint32_t flags;
+    uint32_t reserved;
+};
+static_assert(sizeof(ScoreIndexEntry) == 96, "ScoreIndexEntry: Layout muss zu score_writer.py passen");
+
+class ScoreStore {
+public:
+    ~ScoreStore() { close(); }
+
+    // Verzeichnis öffnen und einblenden. Partituren, die nicht zur Übersetzung passen (Chroma-Breite,
+    // Feature-Typ, Onset-Spur, Raster), werden übersprungen und gezählt. false = Speicher unbrauchbar
+    bool open(const char* dir) {
+        char path[256];
+        const ScoreIndexHeader* head = nullptr;
+        for (int attempt = 1; !data; attempt++) {
+            close();
+            snprintf(path, sizeof(path), "%s/%s", dir, SCORE_STORE_INDEX);
+            size_t indexSize;
+            index = (const uint8_t*)mapFile(path, indexSize);
+            if (!index) return fail("%s nicht lesbar", path);
+            indexBytes = indexSize;
+
+            head = (const ScoreIndexHeader*)index;
+            if (indexSize < sizeof(ScoreIndexHeader) || memcmp(head->magic, "SPTI", 4) ||
+                head->version != SCORE_STORE_VERSION) {
+                return fail("%s: kein Index (Version %d)", path, SCORE_STORE_VERSION);
+            }
+            if (sizeof(ScoreIndexHeader) + (size_t)head->count * sizeof(ScoreIndexEntry) > indexSize) {
+                return fail("%s: Index abgeschnitten", path);
+            }
+            char dataName[sizeof(head->data_file) + 1];
+            memcpy(dataName, head->data_file, sizeof(head->data_file));
+            dataName[sizeof(head->data_file)] = '\0';
+            snprintf(path, sizeof(path), "%s/%s", dir, dataName);
+            data = (const uint8_t*)mapFile(path, dataBytes);
+            // Inzwischen aufgeräumt: der aktuelle Index nennt eine neuere Datei
+            if (!data && (errno != ENOENT || attempt >= SCORE_STORE_RETRIES)) return fail("%s nicht lesbar", path);
+        }
+
+        const ScoreIndexEntry* entries = (const ScoreIndexEntry*)(index + sizeof(ScoreIndexHeader));
+        for (uint32_t i = 0; i < head->count && count < SCORE_STORE_MAX; i++) {
+            if (!addEntry(entries[i])) skipped++;
+        }
+        return true;
+    }
+
+    void close() {
+        if (index) munmap((void*)index, indexBytes);
+        if (data) munmap((void*)data, dataBytes);
+        index = nullptr;
+        data = nullptr;
+        indexBytes = dataBytes = 0;
+        count = 0;
+        skipped = 0;
+    }
+
+    int size() const { return count; }
+    int getSkipped() const { return skipped; }
+    const char* getError() const { return error; }
+    size_t getMappedBytes() const { return indexBytes + dataBytes; }
+
+    const ScoreView* view(int i) const { return (i >= 0 && i < count) ? &views[i] : nullptr; }
+
+    // Index der Partitur mit diesem Namen, -1 wenn nicht vorhanden
+    int find(const char* name) const {
+        for (int i = 0; i < count; i++) {
+            if (!strcmp(views[i].name, name)) return i;
+        }
+        return -1;
+    }
+
+private:
+    const uint8_t* index = nullptr;
+    const uint8_t* data = nullptr;
+    size_t indexBytes = 0;
+    size_t dataBytes = 0;
+    ScoreView views[SCORE_STORE_MAX];
+    int count = 0;
+    int skipped = 0;
+    char error[320] = "";
+
+    static const void* mapFile(const char* path, size_t& bytes) {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return nullptr;
+        struct stat st;
+        void* p = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            bytes = (size_t)st.st_size;
+            p = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);   // Die Abbildung bleibt gültig
+        return p == MAP_FAILED ? nullptr : p;
+    }
+
+    template <typename... Args>
+    bool fail(const char* fmt, Args... args) {
+        snprintf(error, sizeof(error), fmt, args...);
+        close();
+        return false;
+    }
+
+    // Abschnitt [offset, offset + bytes) liegt in der Partitur und ist für floats ausgerichtet.
+    // Vergleiche ohne Summe: die Werte kommen aus der Datei und dürfen nicht überlaufen
+    static bool inside(const ScoreIndexEntry& e, uint32_t offset, uint64_t bytes) {
+        return offset % 4 == 0 && offset >= sizeof(ScoreFileHeader) && bytes <= e.size && offset <= e.size - bytes;
+    }
+
+    bool addEntry(const ScoreIndexEntry& e) {
+        if (e.offset % SCORE_STORE_ALIGN || e.size > dataBytes || e.offset > dataBytes - e.size ||
+            e.size < sizeof(ScoreFileHeader)) {
+            return false;
+        }
+        const uint8_t* base = data + e.offset;
+        const ScoreFileHeader* h = (const ScoreFileHeader*)base;
+        if (memcmp(h->magic, "SPTS", 4) || h->version != SCORE_STORE_VERSION || h->len == 0) return false;
+
+        // Gleiche Bedingungen wie SCORE_CHECK in ScoreLibrary.h, nur zur Laufzeit
+        bool onset = h->flags & SCORE_FLAG_ONSET;
+        if (h->num_chroma != NUM_CHROMA) return false;
+        if (((h->flags & SCORE_FLAG_CENS) != 0) != (SCORE_FEATURE_CENS != 0)) return false;
+        if (onset != (SCORE_HAS_ONSET != 0)) return false;
+        if (((h->flags & SCORE_FLAG_BEAT_SYNC) != 0) != (SCORE_BEAT_SYNC != 0)) return false;
+        if (h->sample_rate != SCORE_SAMPLE_RATE || h->hop_length != SCORE_HOP_LENGTH) return false;
+        if (SCORE_BEAT_SYNC && fabsf(h->frames_per_beat - SCORE_FRAMES_PER_BEAT) > 1e-3f) return false;
+
+        uint64_t frameBytes = (uint64_t)h->len * sizeof(float);
+        if (!inside(e, h->chroma_offset, frameBytes * NUM_CHROMA) || !inside(e, h->magnitude_offset, frameBytes) ||
+            !inside(e, h->pages_offset, (uint64_t)h->num_pages * sizeof(int32_t)) ||
+            (onset && !inside(e, h->onset_offset, frameBytes)) || memchr(h->name, '\0', sizeof(h->name)) == nullptr) {
+            return false;
+        }
+        // Seitenenden aufsteigend und innerhalb der Partitur (DTW.h liest page_ends[next_page_idx] ungeprüft)
+        const int32_t* pages = (const int32_t*)(base + h->pages_offset);
+        for (uint32_t p = 0; p < h->num_pages; p++) {
+            if (pages[p] < 0 || (uint32_t)pages[p] >= h->len || (p > 0 && pages[p] <= pages[p - 1])) return false;
+        }
+
+        ScoreView& v = views[count++];
+        v.name = h->name;
+        v.chroma = (const float(*)[NUM_CHROMA])(base + h->chroma_offset);
+        v.onset = onset ? (const float*)(base + h->onset_offset) : nullptr;
+        v.len = (int)h->len;
+        v.page_ends = (const int*)(base + h->pages_offset);
+        v.num_pages = (int)h->num_pages;
+        v.magnitudes = (const float*)(base + h->magnitude_offset);
+        return true;
+    }
+};
+
+#endif
@@ -2,17 +2,34 @@
 #define SETTINGS_H
 
 #define FFT_SIZE 4096
-#define NUM_CHROMA 12
+#ifndef NUM_CHROMA
+#define NUM_CHROMA 12        // Muss zu SCORE_NUM_CHROMA in ScoreData.h passen
+#endif
 
-// DTW Parameter
+// DTW Parameter (Standardwerte; zur Laufzeit über TrackerConfig / Serial-Shell "set" änderbar)
 #define PENALTY_WAIT 2.0f
 #define PENALTY_STEP 0.0f
 #define PENALTY_SKIP 0.8f
 
+// Gewicht des Onset-Terms in der Distanz (nur mit score_onset in ScoreData.h)
+#define ONSET_WEIGHT 0.2f
+
 // Optimierung: Radius verkleinern
 #define CALC_RADIUS 100     // +/- 100 Frames reichen meistens
+#define CALC_RADIUS_CENS 60 // CENS-Features sind robuster -> schmaleres Fenster reicht
+#define CALC_RADIUS_BEATS 16 // Schlag-Raster (SCORE_BEAT_SYNC): +/- 16 Schläge
 
 #define PAGE_TURN_OFFSET 10 
-#define START_THRESHOLD 1500 
+#define PAGE_TURN_OFFSET_BEATS 2  // Im Schlag-Raster: 2 Schläge vor Seitenende
+#define TEMPO_SMOOTH 0.05f    // Glättung der Tempo-Schätzung (~20 Frames)
+#define START_THRESHOLD 4.0f  // Start, wenn das Spektrum 4x über dem Rauschboden liegt (~12 dB)
+
+// UART zum ESP32-C3 (Bluetooth-Manager)
+#define LINK_BAUD 115200
+// Der ESP schläft zwischen den Befehlen und wacht an den ersten Flanken auf RX auf; diese
+// Bytes gehen verloren. Daher vor jedem Befehl eine Präambel aus 'U' (~1.4 ms), die der ESP
+// verwirft. Muss zu WAKE_PREAMBLE_BYTES in Bluetooth-Manager/src/main.cpp passen (0 = aus).
+#define LINK_WAKE_PREAMBLE 16
+#define LINK_WAKE_BYTE 'U'
 
 #endif
\ No newline at end of file
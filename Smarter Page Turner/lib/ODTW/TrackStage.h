@@ -0,0 +1,99 @@
+#ifndef TRACK_STAGE_H
+#define TRACK_STAGE_H
+
+#include <Arduino.h>
+#include "Settings.h"
+#include "FeatureStage.h"
+#include "CENS.h"
+#include "Beat.h"
+#include "Scheduler.h"
+#include "DTW.h"
+
+// Was ein Frame beim Tracker auslöst (gleiche Werte wie BatchInput in BatchDTW.h)
+enum TrackAction : uint8_t {
+    TRACK_NONE = 0,     // Musik, aber Schlag-Segment noch offen (SCORE_BEAT_SYNC): kein DTW-Schritt
+    TRACK_UPDATE = 1,   // DTW-Schritt mit input/snr/onset
+    TRACK_REST = 2      // Pause (keine Aktivität oder keine Musik): tracker.rest()
+};
+
+// Verbraucher-Stufe der Pipeline, Gegenstück zu FeatureStage: FeatureFrame -> CENS -> [Schlag-Raster]
+// -> DTW, dazu die Abbildung der Degradationsstufe auf Radius, CENS-Glättung und Chroma-Modus.
+// Firmware und alle Host-Programme gehen durch diese Stufe; Ausgabe, Flight-Recorder, Mitschnitt und
+// Statistik bleiben beim Aufrufer. Header-only wie DTW.h (die Partitur-Tabellen gehören in die
+// Übersetzungseinheit des Programms).
+class TrackStage {
+public:
+    // t: der Tracker, den consume() und applyDegradation() steuern. Sein Zeitraster (setFrameClock)
+    // muss schon stehen, das Schlag-Raster richtet sich danach.
+    void init(DTWTracker& t) {
+        tracker = &t;
+        cens.init();
+        if (SCORE_BEAT_SYNC) beats.init(t.live_frames_per_beat);
+        beatFrames = t.live_frames_per_beat;
+        smoothing = true;
+    }
+
+    // Neuer Anfang (Reset, Partitur-Wechsel): CENS-Verlauf und offenes Schlag-Segment verwerfen
+    void reset() {
+        cens.reset();
+        beats.reset();
+    }
+
+    // Frame vorbereiten, ohne den Tracker anzufassen: CENS in-place auf f.chroma (gleicher Feature-Raum
+    // wie die Partitur, ScoreData.h mit --feature cens), im Schlag-Raster das Segment sammeln.
+    // Bei TRACK_UPDATE stehen die Eingaben in input/snr/onset/advance (input zeigt in f oder in das
+    // Segment).
+    TrackAction prepare(FeatureFrame& f) {
+        // In Pausen liefert die DSP-Stufe keine Chroma, der DTW ruht
+        if (!(f.flags & FEATURE_ACTIVE)) return TRACK_REST;
+        if (SCORE_FEATURE_CENS) cens.process(f.chroma, smoothing);
+        if (!(f.flags & FEATURE_TRACK)) return TRACK_REST;
+        snr = f.snr;
+#if SCORE_BEAT_SYNC
+        // DTW-Schritt nur am Ende eines Schlag-Segments. Ein Segment zählt so viele Schläge, wie es lang
+        // ist: zwei Achtel-Segmente rücken zusammen einen Schlag vor, nicht zwei
+        input = beatChroma;
+        if (!beats.push(f.chroma, f.onset, beatChroma, onset)) return TRACK_NONE;
+        advance = beats.getSegmentLength() / beatFrames;
+        if (advance > BEAT_MAX_FRACTION) advance = BEAT_MAX_FRACTION;
+        return TRACK_UPDATE;
+#else
+        input = f.chroma;
+        onset = f.onset;
+        return TRACK_UPDATE;
+#endif
+    }
+
+    // Frame durch den Tracker: prepare(), dann update() bzw. rest()
+    TrackAction consume(FeatureFrame& f) {
+        TrackAction action = prepare(f);
+        if (action == TRACK_UPDATE) tracker->update(input, snr, onset, advance);
+        else if (action == TRACK_REST) tracker->rest();
+        return action;
+    }
+
+    // Degradationsstufe des Schedulers anwenden (nach jedem Frame, gilt ab dem nächsten):
+    // Radius relativ zum eingestellten cfg.radius, CENS ohne Glättung, Peak-Chroma in der DSP-Stufe
+    void applyDegradation(DegradeLevel level, FeatureStage& features) {
+        tracker->setRadius(level >= DEGRADE_RADIUS ? tracker->cfg.radius / 2 : tracker->cfg.radius);
+        smoothing = level < DEGRADE_SMOOTHING;
+        features.requestMode(level >= DEGRADE_CHROMA ? CHROMA_MODE_PEAKS : CHROMA_MODE_DEFAULT);
+    }
+
+    CENSStage cens;
+    BeatAggregator beats;
+
+    // Eingaben des letzten TRACK_UPDATE (Flight-Recorder, Batch-Auswertung)
+    float* input = nullptr;
+    float snr = 0.0f;
+    float onset = 0.0f;
+    float advance = 1.0f;       // Schläge im Segment (SCORE_BEAT_SYNC), sonst 1
+    bool smoothing = true;      // false ab DEGRADE_SMOOTHING
+
+private:
+    DTWTracker* tracker = nullptr;
+    float beatChroma[NUM_CHROMA];   // Schlag-Segment (SCORE_BEAT_SYNC)
+    float beatFrames = 1.0f;        // Live-Frames pro Schlag
+};
+
+#endif
@@ -0,0 +1,50 @@
+#include "AudioHealth.h"
+
+void AudioHealthMonitor::init(float sampleRate, int blocks) {
+    blocksPerMicro = sampleRate / HEALTH_BLOCK_SAMPLES / 1e6f;
+    memoryBlocks = blocks;
+    start();
+}
+
+void AudioHealthMonitor::start() {
+    lastMicros = micros();
+    elapsedMicros = 0;
+    blocksConsumed = 0;
+    lostBlocks = 0;
+    catchups = 0;
+    stalls = 0;
+    maxStallMicros = 0;
+    backlog = 0;
+    maxBacklog = 0;
+    memoryMax = 0;
+    catchingUp = false;
+}
+
+void AudioHealthMonitor::update(int queueDepth, int memoryUsed, int usageMax) {
+    backlog = queueDepth;
+    if (backlog > maxBacklog) maxBacklog = backlog;
+    memoryMax = usageMax > memoryUsed ? usageMax : memoryUsed;
+
+    // Erwartete Blöcke seit start()
+    uint32_t now = micros();
+    elapsedMicros += (uint32_t)(now - lastMicros);
+    lastMicros = now;
+    int32_t expected = (int32_t)(elapsedMicros * (double)blocksPerMicro);
+    int32_t deficit = expected - (int32_t)blocksConsumed - backlog - HEALTH_LOST_TOLERANCE;
+    // Verluste sind endgültig -> nur nach oben nachführen
+    if (deficit > (int32_t)lostBlocks) lostBlocks = deficit;
+
+    // Hysterese für den Aufholmodus
+    if (!catchingUp && backlog >= HEALTH_CATCHUP_ENTER) {
+        catchingUp = true;
+        catchups++;
+    } else if (catchingUp && backlog <= HEALTH_CATCHUP_EXIT) {
+        catchingUp = false;
+    }
+}
+
+void AudioHealthMonitor::blocked(uint32_t micros) {
+    if (micros * blocksPerMicro < 1.0f) return;
+    stalls++;
+    if (micros > maxStallMicros) maxStallMicros = micros;
+}
@@ -0,0 +1,62 @@
+#ifndef AUDIO_HEALTH_H
+#define AUDIO_HEALTH_H
+
+#include <Arduino.h>
+
+// Konfiguration (in Audio-Blöcken à 128 Samples, ~2.9 ms)
+#define HEALTH_BLOCK_SAMPLES 128
+#define HEALTH_LOST_TOLERANCE 2      // Jitter zwischen micros() und I2S-Takt
+#define HEALTH_CATCHUP_ENTER 24      // Ab 3/4 Frame Rückstand: Aufholmodus
+#define HEALTH_CATCHUP_EXIT 4        // ... bis die Queue fast leer ist
+
+// Überwachung der Audio-Queue zwischen I2S-ISR und loop().
+// Aus Laufzeit und Samplerate ergibt sich, wie viele Blöcke seit start() hätten ankommen müssen.
+// Was weder verarbeitet wurde noch in der Queue wartet, ist verloren (Queue/AudioMemory voll).
+// Die Bibliothek selbst kennt keine Audio-Library-Funktionen, die Werte kommen per Parameter.
+class AudioHealthMonitor {
+public:
+    void init(float sampleRate, int memoryBlocks);
+    // Beginn der Messung (nach queue.begin())
+    void start();
+
+    // Einmal pro loop(): aktuelle Queue-Tiefe und AudioMemoryUsage()/AudioMemoryUsageMax()
+    void update(int queueDepth, int memoryUsed, int memoryMax);
+    // Nach jedem gelesenen Block
+    void consumed() { blocksConsumed++; }
+    // loop() hing micros lang außerhalb der Audio-Kette (SD-Mitschnitt). Kam währenddessen mindestens
+    // ein Block an, musste die Kette warten -> Stall
+    void blocked(uint32_t micros);
+
+    // Aufholmodus: Rückstand in einem Rutsch abarbeiten, billigster Pfad, keine Ausgabe
+    bool isCatchingUp() const { return catchingUp; }
+
+    int getBacklog() const { return backlog; }
+    int getMaxBacklog() const { return maxBacklog; }
+    uint32_t getLagSamples() const { return (uint32_t)backlog * HEALTH_BLOCK_SAMPLES; }
+    uint32_t getLostBlocks() const { return lostBlocks; }
+    uint32_t getBlocksConsumed() const { return blocksConsumed; }
+    uint32_t getCatchups() const { return catchups; }
+    uint32_t getStalls() const { return stalls; }
+    uint32_t getMaxStallMicros() const { return maxStallMicros; }
+    int getMemoryMax() const { return memoryMax; }
+    int getMemoryBlocks() const { return memoryBlocks; }
+    // AudioMemory fast ausgeschöpft -> nächste Blöcke werden verworfen
+    bool isMemoryCritical() const { return memoryMax >= memoryBlocks - 2; }
+
+private:
+    float blocksPerMicro = 0.0f;
+    int memoryBlocks = 0;
+    uint32_t lastMicros = 0;
+    uint64_t elapsedMicros = 0;   // Aufsummiert, damit der micros()-Überlauf (~71 min) nicht stört
+    uint32_t blocksConsumed = 0;
+    uint32_t lostBlocks = 0;
+    uint32_t catchups = 0;
+    uint32_t stalls = 0;
+    uint32_t maxStallMicros = 0;
+    int backlog = 0;
+    int maxBacklog = 0;
+    int memoryMax = 0;
+    bool catchingUp = false;
+};
+
+#endif
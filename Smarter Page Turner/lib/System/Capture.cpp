@@ -0,0 +1,135 @@
+#include "Capture.h"
+
+File createNumberedFile(const char* pattern, char* name, int nameSize) {
+    if (!SD.begin(BUILTIN_SDCARD)) return File();
+    for (int n = 1; n < 100000; n++) {
+        snprintf(name, nameSize, pattern, n);
+        if (!SD.exists(name)) break;
+    }
+    return SD.open(name, FILE_WRITE_BEGIN);
+}
+
+bool CaptureWriter::start(CaptureType captureType, float sampleRate, int frameSamples, int numChroma) {
+    if (isActive()) stop();
+    if (captureType == CAPTURE_OFF || numChroma > CAPTURE_MAX_CHROMA) return false;
+
+    file = createNumberedFile(CAPTURE_FILE_PATTERN, fileName, sizeof(fileName));
+    if (!file) return false;
+
+    memset(&header, 0, sizeof(header));
+    header.magic = CAPTURE_MAGIC;
+    header.version = CAPTURE_VERSION;
+    header.type = captureType;
+    header.num_chroma = numChroma;
+    header.sample_rate = sampleRate;
+    header.frame_samples = frameSamples;
+    header.record_bytes = (captureType == CAPTURE_FEATURES)
+        ? sizeof(CaptureFrame) + numChroma * sizeof(float) : sizeof(int16_t);
+    writeHeader();
+
+    full[0] = full[1] = false;
+    active = 0;
+    fill = 0;
+    drained = 0;
+    frames = 0;
+    maxWriteMicros = 0;
+    type = captureType;
+    return true;
+}
+
+void CaptureWriter::stop() {
+    if (!isActive()) return;
+
+    // Reihenfolge erhalten: erst die vollen Puffer (der ältere zuerst), dann der angefangene
+    while (full[0] || full[1]) service();
+    if (fill > 0) {
+        // Auf ganze Blöcke auffüllen; data_bytes sagt dem Leser, wo die Daten enden
+        int padded = (fill + CAPTURE_BLOCK - 1) / CAPTURE_BLOCK * CAPTURE_BLOCK;
+        memset(buffers[active] + fill, 0, padded - fill);
+        writeChunk(buffers[active], padded);
+    }
+    fill = 0;
+    writeHeader();
+    file.close();
+    type = CAPTURE_OFF;
+}
+
+void CaptureWriter::writeSamples(const int16_t* samples, int count) {
+    if (type != CAPTURE_RAW) return;
+    append(samples, count * sizeof(int16_t));
+}
+
+void CaptureWriter::writeFrame(float volume, float flatness, float snr, float onset, const float* chroma) {
+    if (type != CAPTURE_FEATURES) return;
+    // Ganzer Datensatz am Stück, damit ein Verwerfen nie einen halben Frame hinterlässt
+    uint8_t record[sizeof(CaptureFrame) + CAPTURE_MAX_CHROMA * sizeof(float)];
+    CaptureFrame* f = (CaptureFrame*)record;
+    f->frame = frames++;
+    f->flags = chroma ? CAPTURE_FRAME_DSP : 0;
+    f->volume = volume;
+    f->flatness = flatness;
+    f->snr = snr;
+    f->onset = onset;
+    float* values = (float*)(record + sizeof(CaptureFrame));
+    if (chroma) memcpy(values, chroma, header.num_chroma * sizeof(float));
+    else memset(values, 0, header.num_chroma * sizeof(float));
+    append(record, header.record_bytes);
+}
+
+uint32_t CaptureWriter::service() {
+    if (!isActive()) return 0;
+    // Nur einer voll -> der inaktive. Beide voll -> der aktive ist der ältere (wurde zuerst gefüllt)
+    int idx = full[active] ? active : active ^ 1;
+    if (!full[idx]) return 0;
+    // Der Puffer bleibt voll (für append() belegt), bis sein letzter Sektor geschrieben ist
+    uint32_t dt = writeChunk(buffers[idx] + drained, CAPTURE_CHUNK);
+    drained += CAPTURE_CHUNK;
+    if (drained == CAPTURE_BUFFER_BYTES) {
+        full[idx] = false;
+        drained = 0;
+    }
+    return dt;
+}
+
+void CaptureWriter::append(const void* data, int size) {
+    // Platz im aktiven plus ggf. im zweiten Puffer; reicht er nicht, kommt die Karte nicht
+    // hinterher -> ganzen Datensatz verwerfen statt warten
+    int space = full[active] ? 0 : CAPTURE_BUFFER_BYTES - fill;
+    if (!full[active ^ 1]) space += CAPTURE_BUFFER_BYTES;
+    if (size > space) {
+        header.dropped_bytes += size;
+        return;
+    }
+    const uint8_t* src = (const uint8_t*)data;
+    while (size > 0) {
+        int n = CAPTURE_BUFFER_BYTES - fill;
+        if (n > size) n = size;
+        memcpy(buffers[active] + fill, src, n);
+        fill += n;
+        src += n;
+        size -= n;
+        header.data_bytes += n;
+        if (fill == CAPTURE_BUFFER_BYTES) {
+            full[active] = true;
+            active ^= 1;
+            fill = 0;
+        }
+    }
+}
+
+uint32_t CaptureWriter::writeChunk(const uint8_t* data, int size) {
+    uint32_t t0 = micros();
+    file.write(data, size);
+    uint32_t dt = micros() - t0;
+    if (dt > maxWriteMicros) maxWriteMicros = dt;
+    return dt;
+}
+
+void CaptureWriter::writeHeader() {
+    uint8_t block[CAPTURE_BLOCK];
+    memset(block, 0, sizeof(block));
+    memcpy(block, &header, sizeof(header));
+    file.seek(0);
+    file.write(block, sizeof(block));
+    file.seek(file.size());
+}
@@ -0,0 +1,104 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <Arduino.h>
+#include <SD.h>
+
+// Konfiguration
+#define CAPTURE_BLOCK 512                          // SD-Sektor; Datei wird nur in ganzen Blöcken geschrieben
+#define CAPTURE_BUFFER_BYTES (16 * CAPTURE_BLOCK)  // 8 KB pro Puffer = ~93 ms Rohaudio
+#define CAPTURE_CHUNK CAPTURE_BLOCK                // Pro service() höchstens ein Sektor auf die Karte
+#define CAPTURE_MAGIC 0x43545053UL                 // "SPTC" im Speicher (Little Endian)
+#define CAPTURE_VERSION 1
+#define CAPTURE_MAX_CHROMA 36
+#define CAPTURE_FILE_PATTERN "CAP%05d.SPT"
+#define RECORDER_FILE_PATTERN "REC%05d.BIN"        // Flight-Recorder-Dump (Befehl "dump sd")
+
+enum CaptureType : uint8_t {
+    CAPTURE_OFF = 0,
+    CAPTURE_RAW = 1,        // int16-Samples direkt aus der I2S-Queue (vor AGC/Resampler)
+    CAPTURE_FEATURES = 2    // Pro Frame: Lautstärke, Flatness, SNR, Onset, Chroma (vor CENS)
+};
+
+// Dateikopf im ersten 512-Byte-Block; data_bytes/dropped_bytes werden bei stop() nachgetragen
+struct CaptureHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t type;
+    uint8_t num_chroma;
+    float sample_rate;          // Echte Rate der Samples (Teensy: 44117.647)
+    uint32_t frame_samples;     // Samples pro Feature-Frame (FFT_SIZE)
+    uint32_t record_bytes;      // CAPTURE_FEATURES: Bytes pro Frame, sonst 2
+    uint32_t data_bytes;        // Nutzdaten ab Offset CAPTURE_BLOCK (ohne Auffüllung)
+    uint32_t dropped_bytes;     // Verworfen, weil beide Puffer voll waren
+};
+
+// Kopf eines Feature-Frames, danach num_chroma floats (nur gültig mit CAPTURE_FRAME_DSP)
+#define CAPTURE_FRAME_DSP 0x01  // Aktivitätserkennung offen, dsp.process() lief
+struct CaptureFrame {
+    uint32_t frame;
+    uint32_t flags;
+    float volume;
+    float flatness;
+    float snr;
+    float onset;
+};
+
+// Doppelpuffer (16 KB). Auf dem Teensy als DMAMEM-Variable (RAM2) anlegen: der Mitschnitt ist meist aus,
+// RAM1 gehört Partitur, DSP und Code. Nicht initialisiert beim Booten, gültig ist nur, was append() schrieb
+typedef uint8_t CaptureBuffers[2][CAPTURE_BUFFER_BYTES];
+
+// Nächste freie Datei nach pattern (printf mit einer Nummer) auf der SD-Karte anlegen, Name nach name.
+// Sucht einmalig von 1 an, nicht für den Audio-Pfad. Ungültige File ohne Karte
+File createNumberedFile(const char* pattern, char* name, int nameSize);
+
+// Mitschnitt auf SD für Replay und Regressionstests (host_replay liest die Dateien direkt).
+// Zwei Puffer: write*() kopiert nur in den aktiven Puffer; ist er voll, wird umgeschaltet und
+// service() schreibt den vollen Puffer sektorweise (CAPTURE_CHUNK pro Aufruf) auf die Karte.
+// service() läuft einmal pro loop(), also mindestens einmal pro Audio-Block (~2.9 ms): 512 B pro
+// Block sind ~176 KB/s, doppelt so viel wie Rohaudio. Ein Aussetzer der Karte hält loop() so nur
+// für einen Sektor auf, nicht für 8 KB. Sind beide Puffer voll, werden Daten verworfen und gezählt.
+class CaptureWriter {
+public:
+    explicit CaptureWriter(CaptureBuffers& storage) : buffers(storage) {}
+
+    // Legt die nächste freie CAPxxxxx.SPT an; false ohne Karte
+    bool start(CaptureType type, float sampleRate, int frameSamples, int numChroma);
+    // Rest schreiben, Kopf nachtragen, schließen (blockiert, nur aus der Shell)
+    void stop();
+
+    void writeSamples(const int16_t* samples, int count);
+    // chroma == nullptr -> Frame ohne DSP (Pause)
+    void writeFrame(float volume, float flatness, float snr, float onset, const float* chroma);
+
+    // Höchstens CAPTURE_CHUNK Bytes des ältesten vollen Puffers schreiben. Rückgabe: Dauer in us
+    // (0 = nichts zu tun), für AudioHealthMonitor::blocked()
+    uint32_t service();
+
+    CaptureType getType() const { return type; }
+    bool isActive() const { return type != CAPTURE_OFF; }
+    const char* getFileName() const { return fileName; }
+    uint32_t getBytes() const { return header.data_bytes; }
+    uint32_t getDropped() const { return header.dropped_bytes; }
+    uint32_t getMaxWriteMicros() const { return maxWriteMicros; }
+
+private:
+    CaptureType type = CAPTURE_OFF;
+    CaptureHeader header;
+    File file;
+    char fileName[16];
+
+    uint8_t (*buffers)[CAPTURE_BUFFER_BYTES];
+    bool full[2] = {false, false};
+    int active = 0;
+    int fill = 0;
+    int drained = 0;                        // Schon geschriebene Bytes des ältesten vollen Puffers
+    uint32_t frames = 0;
+    uint32_t maxWriteMicros = 0;
+
+    void append(const void* data, int size);
+    uint32_t writeChunk(const uint8_t* data, int size);
+    void writeHeader();
+};
+
+#endif
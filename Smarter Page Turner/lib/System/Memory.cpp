@@ -0,0 +1,124 @@
+#include "Memory.h"
+
+#if defined(__IMXRT1062__)
+#include <malloc.h>
+
+// Symbole aus dem Teensy-4-Linkerskript
+extern unsigned long _ebss;
+extern unsigned long _estack;
+extern unsigned long _heap_start;
+extern unsigned long _heap_end;
+extern char* __brkval;
+
+static uint32_t* stackBottom() { return (uint32_t*)&_ebss; }
+static uint32_t* stackTop() { return (uint32_t*)&_estack; }
+#endif
+
+void MemoryMonitor::paintStack() {
+#if defined(__IMXRT1062__)
+    uint32_t marker;
+    uint32_t* end = (uint32_t*)((uint8_t*)&marker - MEMORY_STACK_GUARD);
+    for (uint32_t* p = stackBottom(); p < end; p++) *p = MEMORY_STACK_PATTERN;
+    painted = true;
+#endif
+}
+
+void MemoryMonitor::setModule(const char* name, uint32_t staticBytes, uint32_t heapBytes, bool ram2) {
+    for (int i = 0; i < moduleCount; i++) {
+        if (!strcmp(modules[i].name, name)) {
+            modules[i].staticBytes = staticBytes;
+            modules[i].heapBytes = heapBytes;
+            modules[i].ram2 = ram2;
+            return;
+        }
+    }
+    if (moduleCount >= MEMORY_MAX_MODULES) return;
+    modules[moduleCount++] = {name, staticBytes, heapBytes, ram2};
+}
+
+uint32_t MemoryMonitor::getStackUsed() const {
+#if defined(__IMXRT1062__)
+    if (!painted) return 0;
+    // Von unten die erste überschriebene Stelle suchen
+    uint32_t* p = stackBottom();
+    while (p < stackTop() && *p == MEMORY_STACK_PATTERN) p++;
+    return (uint32_t)((uint8_t*)stackTop() - (uint8_t*)p);
+#else
+    return 0;
+#endif
+}
+
+uint32_t MemoryMonitor::getStackSize() const {
+#if defined(__IMXRT1062__)
+    return (uint32_t)((uint8_t*)stackTop() - (uint8_t*)stackBottom());
+#else
+    return 0;
+#endif
+}
+
+uint32_t MemoryMonitor::getHeapUsed() const {
+#if defined(__IMXRT1062__)
+    return mallinfo().uordblks;
+#else
+    return 0;
+#endif
+}
+
+uint32_t MemoryMonitor::getHeapPeak() const {
+#if defined(__IMXRT1062__)
+    char* brk = __brkval ? __brkval : (char*)&_heap_start;
+    return (uint32_t)(brk - (char*)&_heap_start);
+#else
+    return 0;
+#endif
+}
+
+uint32_t MemoryMonitor::getHeapSize() const {
+#if defined(__IMXRT1062__)
+    return (uint32_t)((char*)&_heap_end - (char*)&_heap_start);
+#else
+    return 0;
+#endif
+}
+
+uint32_t MemoryMonitor::getModuleHeap() const {
+    uint32_t sum = 0;
+    for (int i = 0; i < moduleCount; i++) sum += modules[i].heapBytes;
+    return sum;
+}
+
+void MemoryMonitor::printReport() {
+    uint32_t staticSum = 0, ram2Sum = 0, heapSum = 0;
+    for (int i = 0; i < moduleCount; i++) {
+        Serial.print("  ");
+        Serial.print(modules[i].name);
+        Serial.print(": ");
+        Serial.print((unsigned long)modules[i].staticBytes);
+        Serial.print(modules[i].ram2 ? " B statisch (RAM2), " : " B statisch, ");
+        Serial.print((unsigned long)modules[i].heapBytes);
+        Serial.println(" B Heap");
+        if (modules[i].ram2) ram2Sum += modules[i].staticBytes;
+        else staticSum += modules[i].staticBytes;
+        heapSum += modules[i].heapBytes;
+    }
+    Serial.print("  Summe: ");
+    Serial.print((unsigned long)staticSum);
+    Serial.print(" B statisch (RAM1), ");
+    Serial.print((unsigned long)ram2Sum);
+    Serial.print(" B statisch (RAM2), ");
+    Serial.print((unsigned long)heapSum);
+    Serial.println(" B Heap");
+
+    Serial.print("Stack: max ");
+    Serial.print((unsigned long)getStackUsed());
+    Serial.print(" / ");
+    Serial.print((unsigned long)getStackSize());
+    Serial.println(" B (RAM1)");
+    Serial.print("Heap: ");
+    Serial.print((unsigned long)getHeapUsed());
+    Serial.print(" B belegt, max ");
+    Serial.print((unsigned long)getHeapPeak());
+    Serial.print(" / ");
+    Serial.print((unsigned long)getHeapSize());
+    Serial.println(" B (RAM2)");
+}
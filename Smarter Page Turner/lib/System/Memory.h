@@ -0,0 +1,51 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <Arduino.h>
+
+// Konfiguration
+#define MEMORY_MAX_MODULES 16
+#define MEMORY_STACK_PATTERN 0xA5A5A5A5UL   // Füllmuster für das Stack-Bemalen
+#define MEMORY_STACK_GUARD 512              // Bytes unter dem aktuellen SP, die beim Bemalen frei bleiben
+
+// Speicher-Überwachung für Teensy 4.1:
+// - Stack (RAM1/DTCM): beim Booten wird alles zwischen Ende von .bss und dem aktuellen SP mit einem
+//   Muster gefüllt; der Höchststand ist die tiefste Stelle, an der das Muster überschrieben wurde.
+// - Heap (RAM2/OCRAM): aktueller Verbrauch aus mallinfo(), Höchststand aus __brkval (sbrk wächst nur).
+// - Modul-Budget: jedes Modul meldet seinen statischen RAM und seinen Heap-Anteil; printReport()
+//   stellt das dem freien Speicher gegenüber.
+// Auf dem Host sind Stack und Heap nicht messbar (0), die Modul-Tabelle funktioniert trotzdem.
+class MemoryMonitor {
+public:
+    // Ganz am Anfang von setup() aufrufen
+    void paintStack();
+
+    // Modul eintragen oder aktualisieren (z.B. nach einem Partiturwechsel).
+    // ram2: statischer Anteil liegt als DMAMEM in RAM2 (verkleinert den Heap, nicht den Stack)
+    void setModule(const char* name, uint32_t staticBytes, uint32_t heapBytes, bool ram2 = false);
+
+    uint32_t getStackUsed() const;      // Höchststand seit paintStack()
+    uint32_t getStackSize() const;      // Ende .bss bis Stack-Anfang
+    uint32_t getHeapUsed() const;
+    uint32_t getHeapPeak() const;
+    uint32_t getHeapSize() const;
+    uint32_t getModuleHeap() const;     // Summe der gemeldeten Heap-Anteile
+
+    // Heap-Reserve, wenn zusätzlich extraHeap Bytes angelegt würden (negativ = passt nicht)
+    int32_t heapHeadroom(uint32_t extraHeap) const { return (int32_t)getHeapSize() - (int32_t)(getHeapPeak() + extraHeap); }
+
+    void printReport();
+
+private:
+    struct Module {
+        const char* name;
+        uint32_t staticBytes;
+        uint32_t heapBytes;
+        bool ram2;
+    };
+    Module modules[MEMORY_MAX_MODULES];
+    int moduleCount = 0;
+    bool painted = false;
+};
+
+#endif
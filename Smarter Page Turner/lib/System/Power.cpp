@@ -0,0 +1,108 @@
+#include "Power.h"
+
+#if defined(__IMXRT1062__)
+extern "C" uint32_t set_arm_clock(uint32_t frequency);
+#endif
+
+static const uint32_t CLOCK_STEPS[3] = {POWER_CLOCK_WAIT_MHZ, POWER_CLOCK_TRACKING_MHZ, POWER_CLOCK_MAX_MHZ};
+
+void PowerManager::init() {
+    step = 2;
+    clockMHz = POWER_CLOCK_MAX_MHZ;
+    calmFrames = 0;
+    isrWorkPeak = 0.0f;
+    resetStats();
+}
+
+void PowerManager::resetStats() {
+    busyMicros = 0;
+    idleMicros = 0;
+    energy = 0.0;
+    for (int i = 0; i < 3; i++) stepMicros[i] = 0;
+    clockChanges = 0;
+    sleeps = 0;
+}
+
+bool PowerManager::update(float frameLoad, bool tracking, uint32_t isrMicros) {
+#if POWER_SCALE_CLOCK
+    // Arbeit in "Last x MHz" -> Last bei jeder Stufe = Arbeit / Stufe
+    float work = frameLoad * clockMHz;
+    int needed = 2;
+    for (int s = 0; s < 3; s++) {
+        if (work / CLOCK_STEPS[s] <= POWER_TARGET_LOAD) {
+            needed = s;
+            break;
+        }
+    }
+    // DSP im Interrupt: kleinste Stufe, bei der der Höchststand in die Block-Frist passt
+    float isrWork = (float)isrMicros * clockMHz;
+    if (isrWork > isrWorkPeak) isrWorkPeak = isrWork;
+    int isrStep = 2;
+    for (int s = 0; s < 3; s++) {
+        if (isrWorkPeak / CLOCK_STEPS[s] <= POWER_ISR_TARGET_LOAD * POWER_ISR_BLOCK_US) {
+            isrStep = s;
+            break;
+        }
+    }
+    if (isrStep > needed) needed = isrStep;
+    // Ohne Tracking reicht der Warte-Takt; höher nur, wenn die Last es verlangt
+    int minStep = tracking ? 1 : 0;
+    int target = needed < minStep ? minStep : needed;
+
+    if (target > step) {
+        // Zu knapp oder Tracking beginnt -> sofort hoch
+        calmFrames = 0;
+        setStep(target);
+        return true;
+    }
+    if (target < step) {
+        // Runter erst, wenn die nächstniedrigere Stufe POWER_DOWN_FRAMES Frames am Stück gereicht hätte
+        if (++calmFrames >= POWER_DOWN_FRAMES) {
+            calmFrames = 0;
+            setStep(step - 1);
+            return true;
+        }
+        return false;
+    }
+    calmFrames = 0;
+#endif
+    return false;
+}
+
+void PowerManager::setStep(int s) {
+    step = s;
+    clockMHz = CLOCK_STEPS[s];
+    set_arm_clock(clockMHz * 1000000UL);
+    clockChanges++;
+}
+
+void PowerManager::idle() {
+#if POWER_USE_WFI && defined(__IMXRT1062__)
+    sleeps++;
+    asm volatile("dsb");
+    asm volatile("wfi");
+#endif
+}
+
+void PowerManager::account(uint32_t busy, uint32_t idle) {
+    busyMicros += busy;
+    idleMicros += idle;
+    stepMicros[step] += busy + idle;
+    float active = clockMHz * POWER_MW_PER_MHZ;
+    energy += (double)(POWER_BASE_MW + active) * busy + (double)(POWER_BASE_MW + active * POWER_WFI_FRACTION) * idle;
+}
+
+float PowerManager::getDutyCycle() const {
+    uint64_t total = busyMicros + idleMicros;
+    return total ? (float)busyMicros / total : 1.0f;
+}
+
+float PowerManager::getPowerMw() const {
+    uint64_t total = busyMicros + idleMicros;
+    return total ? (float)(energy / total) : 0.0f;
+}
+
+float PowerManager::getClockShare(int s) const {
+    uint64_t total = busyMicros + idleMicros;
+    return total ? (float)stepMicros[s] / total : 0.0f;
+}
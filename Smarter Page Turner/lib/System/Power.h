@@ -0,0 +1,74 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <Arduino.h>
+
+// Konfiguration
+#define POWER_USE_WFI 1                // 1 = in loop() schlafen, bis der nächste Interrupt kommt
+#define POWER_SCALE_CLOCK 1            // 1 = CPU-Takt nach Last regeln (set_arm_clock)
+#define POWER_CLOCK_WAIT_MHZ 150       // Warten auf den ersten Ton / lange Pausen
+#define POWER_CLOCK_TRACKING_MHZ 396   // Untergrenze, solange der Tracker läuft
+#define POWER_CLOCK_MAX_MHZ 600
+#define POWER_TARGET_LOAD 0.5f         // Ziel-Last (Anteil am Scheduler-Budget) beim Hochrechnen
+#define POWER_DOWN_FRAMES 32           // ~3 s am Stück genug Luft, bevor eine Stufe runter geht
+#define POWER_ISR_BLOCK_US 2902        // Frist der DSP im Audio-Interrupt: ein Block (128 Samples)
+#define POWER_ISR_TARGET_LOAD 0.5f     // ... davon darf die längste DSP-Rechnung höchstens die Hälfte nehmen
+
+// Grobes Leistungsmodell für die Statistik (Schätzwerte, mit Messgerät nachjustieren):
+// P = Grundlast + Takt * mW/MHz * (Tastgrad + (1 - Tastgrad) * Restanteil im WFI)
+#define POWER_BASE_MW 120.0f           // Board, Regler, Mikrofon, ohne CPU-Kern
+#define POWER_MW_PER_MHZ 0.6f          // Kern aktiv (~360 mW bei 600 MHz)
+#define POWER_WFI_FRACTION 0.3f        // Im WFI verbleibender Anteil (Takte laufen, Kern steht)
+
+// Energiesparen zwischen den Audio-Frames:
+// - idle(): WFI, wenn loop() nichts zu tun hat. Der nächste Audio-Block (alle 2.9 ms) oder
+//   der SysTick (1 ms) weckt wieder auf, es geht also kein Block verloren.
+// - update(): Takt aus der Last des letzten Frames. Die Last skaliert mit 1/Takt, daher wird
+//   die kleinste Stufe gewählt, bei der die hochgerechnete Last unter POWER_TARGET_LOAD bleibt.
+//   Hoch sofort, runter erst nach POWER_DOWN_FRAMES ruhigen Frames. Den vollen Takt gibt es nur,
+//   solange der Tracker läuft. Rechnet die DSP im Audio-Interrupt (PIPELINE_ISR_PRODUCER), zählt
+//   zusätzlich deren Frist von einem Block: die Stufe muss die längste bisher gemessene DSP-Rechnung
+//   in POWER_ISR_TARGET_LOAD eines Blocks schaffen, die Frame-Last sieht diese Frist nicht.
+// - account(): wache/schlafende Zeit für Tastgrad und geschätzte Leistung.
+// Auf dem Host setzt set_arm_clock() nur F_CPU_ACTUAL (Shim), WFI entfällt.
+class PowerManager {
+public:
+    void init();
+    void resetStats();
+
+    // Nach jedem Frame; frameLoad = FrameScheduler::getFrameLoad() beim aktuellen Takt.
+    // isrMicros: DSP-Zeit des Frames, wenn sie im Audio-Interrupt lief (FeatureFrame::dspMicros), sonst 0.
+    // true, wenn der Takt geändert wurde (dann scheduler.clockChanged() aufrufen)
+    bool update(float frameLoad, bool tracking, uint32_t isrMicros = 0);
+
+    // In loop(), wenn nichts zu tun ist
+    void idle();
+
+    // Wache und schlafende Mikrosekunden seit dem letzten Aufruf
+    void account(uint32_t busyMicros, uint32_t idleMicros);
+
+    uint32_t getClockMHz() const { return clockMHz; }
+    float getDutyCycle() const;          // Anteil wach, 0..1
+    float getPowerMw() const;            // Geschätzt, bezogen auf die Zeit seit resetStats()
+    uint32_t getClockChanges() const { return clockChanges; }
+    uint32_t getSleeps() const { return sleeps; }
+    // Zeitanteil pro Taktstufe (0 = WAIT, 1 = TRACKING, 2 = MAX)
+    float getClockShare(int step) const;
+
+private:
+    uint32_t clockMHz = POWER_CLOCK_MAX_MHZ;
+    int step = 2;
+    int calmFrames = 0;
+    float isrWorkPeak = 0.0f;            // Längste DSP im Interrupt in us x MHz (taktunabhängig)
+
+    uint64_t busyMicros = 0;
+    uint64_t idleMicros = 0;
+    double energy = 0.0;                 // mW * us
+    uint64_t stepMicros[3] = {0, 0, 0};
+    uint32_t clockChanges = 0;
+    uint32_t sleeps = 0;
+
+    void setStep(int s);
+};
+
+#endif
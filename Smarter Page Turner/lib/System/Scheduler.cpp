@@ -0,0 +1,94 @@
+#include "Scheduler.h"
+
+uint32_t FrameScheduler::now() {
+#ifdef ARM_DWT_CYCCNT
+    return ARM_DWT_CYCCNT;
+#else
+    return micros();
+#endif
+}
+
+void FrameScheduler::init(float framePeriod) {
+#ifdef ARM_DWT_CYCCNT
+    // Zykluszähler aktivieren (600 MHz -> Überlauf nach ~7 s, Differenzen bleiben gültig)
+    ARM_DEMCR |= ARM_DEMCR_TRCENA;
+    ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+    ticksPerMicro = F_CPU_ACTUAL / 1000000.0f;
+#else
+    ticksPerMicro = 1.0f;
+#endif
+    period = framePeriod;
+    periodTicks = (uint32_t)(framePeriod * 1e6f * ticksPerMicro);
+    budgetTicks = (uint32_t)(periodTicks * SCHED_BUDGET_FRACTION);
+    reset();
+}
+
+void FrameScheduler::clockChanged() {
+#ifdef ARM_DWT_CYCCNT
+    float old = ticksPerMicro;
+    ticksPerMicro = F_CPU_ACTUAL / 1000000.0f;
+    // Gemessene Werte in der neuen Einheit weiterführen
+    lastTicks = (uint32_t)(lastTicks * (ticksPerMicro / old));
+    maxTicks = (uint32_t)(maxTicks * (ticksPerMicro / old));
+    periodTicks = (uint32_t)(period * 1e6f * ticksPerMicro);
+    budgetTicks = (uint32_t)(periodTicks * SCHED_BUDGET_FRACTION);
+#endif
+}
+
+void FrameScheduler::reset() {
+    level = DEGRADE_NONE;
+    minLevel = DEGRADE_NONE;
+    load = 0.0f;
+    calmFrames = 0;
+    lastTicks = 0;
+    pendingTicks = 0;
+    maxTicks = 0;
+    frames = 0;
+    overruns = 0;
+    missed = 0;
+    degradations = 0;
+    memset(levelFrames, 0, sizeof(levelFrames));
+}
+
+void FrameScheduler::beginFrame() {
+    startTicks = now();
+}
+
+void FrameScheduler::endFrame() {
+    lastTicks = now() - startTicks + pendingTicks;
+    pendingTicks = 0;
+    if (lastTicks > maxTicks) maxTicks = lastTicks;
+    frames++;
+    levelFrames[getLevel()]++;
+
+    float frameLoad = (float)lastTicks / budgetTicks;
+    load += SCHED_LOAD_SMOOTH * (frameLoad - load);
+
+    if (lastTicks > periodTicks) missed++;
+
+    if (lastTicks > budgetTicks) {
+        overruns++;
+        degrade();
+    } else if (frameLoad < SCHED_RECOVER_LOAD) {
+        // Erholung: eine Stufe zurück nach genug ruhigen Frames
+        if (level > DEGRADE_NONE && ++calmFrames >= SCHED_RECOVER_FRAMES) {
+            level = (DegradeLevel)(level - 1);
+            calmFrames = 0;
+        }
+    } else {
+        calmFrames = 0;
+    }
+}
+
+void FrameScheduler::reportOverload() {
+    overruns++;
+    degrade();
+}
+
+void FrameScheduler::degrade() {
+    calmFrames = 0;
+    if (level < SCHED_MAX_LEVEL) {
+        level = (DegradeLevel)(level + 1);
+        degradations++;
+    }
+}
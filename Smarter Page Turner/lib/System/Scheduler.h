@@ -0,0 +1,81 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+// Konfiguration (Anteile an der Frame-Periode, 4096 Samples = ~92.9 ms)
+#define SCHED_BUDGET_FRACTION 0.6f   // Budget pro Frame; Rest bleibt für Audio-ISR, Serial, BLE
+#define SCHED_RECOVER_LOAD 0.35f     // Unter 35% Last darf eine Stufe zurückgenommen werden ...
+#define SCHED_RECOVER_FRAMES 16      // ... wenn das ~1.5 s am Stück so bleibt
+#define SCHED_LOAD_SMOOTH 0.1f       // Glättung der angezeigten Last
+#define SCHED_MAX_LEVEL 3
+
+// Degradationsstufen bei Überlast (kumulativ)
+enum DegradeLevel {
+    DEGRADE_NONE = 0,       // Volle Qualität
+    DEGRADE_RADIUS = 1,     // DTW-Fenster halbieren
+    DEGRADE_SMOOTHING = 2,  // + CENS-Glättung überspringen
+    DEGRADE_CHROMA = 3      // + Peak-Chroma statt aller Bins
+};
+
+// Frame-Scheduler mit Zyklus-Budget. beginFrame()/endFrame() klammern DSP + DTW eines Frames; läuft die
+// DSP in einer eigenen Pipeline-Stufe, kommt ihre Zeit per addWork() dazu.
+// Überschreitet ein Frame das Budget, steigt die Degradationsstufe sofort um eins; erst nach
+// SCHED_RECOVER_FRAMES ruhigen Frames geht es eine Stufe zurück (Hysterese gegen Flattern).
+// Zeitbasis: DWT-Zykluszähler auf dem Teensy, micros() auf dem Host.
+class FrameScheduler {
+public:
+    // framePeriod: Sekunden Audio pro Frame (FFT_SIZE / Samplerate)
+    void init(float framePeriod);
+    void reset();
+    // Nach set_arm_clock(): Zyklen-Budget an den neuen Takt anpassen
+    void clockChanged();
+
+    void beginFrame();
+    void endFrame();
+    // Rechenzeit, die für diesen Frame schon in einer anderen Stufe anfiel (DSP im Erzeuger)
+    void addWork(uint32_t micros) { pendingTicks += (uint32_t)(micros * ticksPerMicro); }
+
+    // Überlast von außen melden (z.B. Audio-Rückstau), zählt wie ein Budget-Überlauf
+    void reportOverload();
+
+    // Untergrenze für die Stufe (z.B. DEGRADE_CHROMA im Aufholmodus der Audio-Queue)
+    void setMinLevel(DegradeLevel l) { minLevel = l; }
+
+    DegradeLevel getLevel() const { return level > minLevel ? level : minLevel; }
+    float getLoad() const { return load; }               // Geglättet, 1.0 = volles Budget
+    float getFrameLoad() const { return budgetTicks ? (float)lastTicks / budgetTicks : 0.0f; }  // Letzter Frame
+    uint32_t getLastMicros() const { return ticksToMicros(lastTicks); }
+    uint32_t getMaxMicros() const { return ticksToMicros(maxTicks); }
+    uint32_t getFrames() const { return frames; }
+    uint32_t getOverruns() const { return overruns; }     // Budget überschritten
+    uint32_t getMissedDeadlines() const { return missed; } // Länger als die Frame-Periode
+    uint32_t getDegradations() const { return degradations; }
+    uint32_t getFramesAtLevel(int l) const { return levelFrames[l]; }
+
+private:
+    uint32_t budgetTicks = 0;
+    uint32_t periodTicks = 0;
+    uint32_t startTicks = 0;
+    uint32_t pendingTicks = 0;
+    uint32_t lastTicks = 0;
+    uint32_t maxTicks = 0;
+    float ticksPerMicro = 1.0f;
+    float period = 0.0f;
+    float load = 0.0f;
+    int calmFrames = 0;
+    DegradeLevel level = DEGRADE_NONE;
+    DegradeLevel minLevel = DEGRADE_NONE;
+
+    uint32_t frames = 0;
+    uint32_t overruns = 0;
+    uint32_t missed = 0;
+    uint32_t degradations = 0;
+    uint32_t levelFrames[SCHED_MAX_LEVEL + 1];
+
+    static uint32_t now();
+    uint32_t ticksToMicros(uint32_t ticks) const { return (uint32_t)(ticks / ticksPerMicro); }
+    void degrade();
+};
+
+#endif
@@ -0,0 +1,60 @@
+#include "Shell.h"
+
+void CommandShell::add(const char* name, ShellHandler handler, const char* help) {
+    if (numCommands >= SHELL_MAX_COMMANDS) return;
+    commands[numCommands++] = { name, handler, help };
+}
+
+bool CommandShell::feed(char c) {
+    if (c == '\r') return false;
+    if (c != '\n') {
+        if (length < SHELL_LINE_MAX - 1) line[length++] = c;
+        else overflow = true;
+        return false;
+    }
+
+    line[length] = '\0';
+    bool ran = false;
+    if (overflow) {
+        Serial.println("ERR Zeile zu lang");
+    } else if (length > 0) {
+        execute(line);
+        ran = true;
+    }
+    length = 0;
+    overflow = false;
+    return ran;
+}
+
+void CommandShell::execute(char* text) {
+    // In Argumente zerlegen (in place, Leerzeichen/Tabs als Trenner)
+    char* argv[SHELL_MAX_ARGS];
+    int argc = 0;
+    char* p = text;
+    while (*p && argc < SHELL_MAX_ARGS) {
+        while (*p == ' ' || *p == '\t') p++;
+        if (!*p) break;
+        argv[argc++] = p;
+        while (*p && *p != ' ' && *p != '\t') p++;
+        if (*p) *p++ = '\0';
+    }
+    if (argc == 0) return;
+
+    for (int i = 0; i < numCommands; i++) {
+        if (strcmp(commands[i].name, argv[0]) == 0) {
+            commands[i].handler(argc, argv);
+            return;
+        }
+    }
+    Serial.print("ERR Unbekannter Befehl: ");
+    Serial.println(argv[0]);
+}
+
+void CommandShell::printHelp() {
+    for (int i = 0; i < numCommands; i++) {
+        Serial.print("  ");
+        Serial.print(commands[i].name);
+        Serial.print(" - ");
+        Serial.println(commands[i].help);
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef SHELL_H
+#define SHELL_H
+
+#include <Arduino.h>
+
+// Konfiguration
+#define SHELL_LINE_MAX 64
+#define SHELL_MAX_ARGS 4
+#define SHELL_MAX_COMMANDS 16
+
+typedef void (*ShellHandler)(int argc, char** argv);
+
+// Kompakte Zeilen-Shell für die USB-Serial: "befehl arg1 arg2\n".
+// Zeichen werden einzeln per feed() übergeben (nicht blockierend, aus loop() heraus),
+// bei Zeilenende wird der passende Handler aufgerufen. argv[0] ist der Befehl selbst.
+class CommandShell {
+public:
+    void add(const char* name, ShellHandler handler, const char* help);
+
+    // true -> Zeile wurde ausgeführt
+    bool feed(char c);
+    void execute(char* line);
+    void printHelp();
+
+private:
+    struct Command {
+        const char* name;
+        ShellHandler handler;
+        const char* help;
+    };
+    Command commands[SHELL_MAX_COMMANDS];
+    int numCommands = 0;
+    char line[SHELL_LINE_MAX];
+    int length = 0;
+    bool overflow = false;
+};
+
+#endif
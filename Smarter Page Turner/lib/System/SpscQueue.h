@@ -0,0 +1,115 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Lock-freie Warteschlange für genau einen Erzeuger und einen Verbraucher (z.B. Audio-ISR -> loop(),
+// später Lese-Thread -> Tracker-Thread auf dem Host). Feste Größe N (Zweierpotenz), keine Allokation.
+// head schreibt nur der Erzeuger, tail nur der Verbraucher; acquire/release ordnet die Nutzdaten.
+// Auf dem Cortex-M7 sind 32-Bit-Atomics einfache LDR/STR mit Barriere, in der ISR also unbedenklich.
+// Ist die Queue voll, verwirft push() das neue Element und zählt es (der Erzeuger blockiert nie).
+template <typename T, uint32_t N>
+class SpscQueue {
+    static_assert((N & (N - 1)) == 0, "SpscQueue: N muss eine Zweierpotenz sein");
+
+public:
+    // --- ERZEUGER ---
+    bool push(const T& item) {
+        uint32_t head = headIndex.load(std::memory_order_relaxed);
+        uint32_t depth = head - tailIndex.load(std::memory_order_acquire);
+        if (depth >= N) {
+            dropped++;
+            return false;
+        }
+        items[head & (N - 1)] = item;
+        headIndex.store(head + 1, std::memory_order_release);
+        if (depth + 1 > maxDepth) maxDepth = depth + 1;
+        return true;
+    }
+
+    // --- VERBRAUCHER ---
+    bool pop(T& item) {
+        uint32_t tail = tailIndex.load(std::memory_order_relaxed);
+        if (tail == headIndex.load(std::memory_order_acquire)) return false;
+        item = items[tail & (N - 1)];
+        tailIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Nur zwischen den Stufen konsistent (z.B. nach reset des Verbrauchers): alles Wartende verwerfen
+    void clear() { tailIndex.store(headIndex.load(std::memory_order_acquire), std::memory_order_release); }
+
+    // Von beiden Seiten lesbar, aber nur eine Momentaufnahme
+    uint32_t size() const {
+        return headIndex.load(std::memory_order_acquire) - tailIndex.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    static constexpr uint32_t capacity() { return N; }
+
+    // Statistik (schreibt nur der Erzeuger)
+    uint32_t getDropped() const { return dropped; }
+    uint32_t getMaxDepth() const { return maxDepth; }
+    void resetStats() {
+        dropped = 0;
+        maxDepth = 0;
+    }
+
+private:
+    // Getrennte Cache-Zeilen, damit Erzeuger und Verbraucher (auf dem Host: zwei Kerne) sich nicht stören
+    alignas(64) std::atomic<uint32_t> headIndex{0};
+    alignas(64) std::atomic<uint32_t> tailIndex{0};
+    alignas(64) T items[N];
+    uint32_t dropped = 0;
+    uint32_t maxDepth = 0;
+};
+
+// Wartezeit in einer Queue: Erzeuger stempelt beim push(), Verbraucher misst beim pop()
+struct QueueLatency {
+    uint32_t last = 0;
+    uint32_t max = 0;
+    uint64_t sum = 0;
+    uint32_t count = 0;
+
+    void add(uint32_t micros) {
+        last = micros;
+        if (micros > max) max = micros;
+        sum += micros;
+        count++;
+    }
+    uint32_t mean() const { return count ? (uint32_t)(sum / count) : 0; }
+    void reset() { *this = QueueLatency(); }
+};
+
+// Verteilung für Perzentile (p99 usw.), lineare Fächer à LATENCY_HIST_STEP_US, alles darüber im
+// letzten Fach. Für den Host gedacht (8 KB), auf dem Teensy reicht QueueLatency.
+#define LATENCY_HIST_STEP_US 50
+#define LATENCY_HIST_BUCKETS 2000     // bis 100 ms
+
+struct LatencyHistogram {
+    uint32_t buckets[LATENCY_HIST_BUCKETS] = {};
+    uint32_t count = 0;
+
+    void add(uint32_t micros) {
+        uint32_t b = micros / LATENCY_HIST_STEP_US;
+        buckets[b < LATENCY_HIST_BUCKETS ? b : LATENCY_HIST_BUCKETS - 1]++;
+        count++;
+    }
+    void merge(const LatencyHistogram& other) {
+        for (int i = 0; i < LATENCY_HIST_BUCKETS; i++) buckets[i] += other.buckets[i];
+        count += other.count;
+    }
+    // Obergrenze des Fachs, in dem das Perzentil p (0..1) liegt
+    uint32_t percentile(float p) const {
+        if (!count) return 0;
+        uint32_t target = (uint32_t)(p * (count - 1)) + 1;
+        uint32_t seen = 0;
+        for (int i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+            seen += buckets[i];
+            if (seen >= target) return (i + 1) * LATENCY_HIST_STEP_US;
+        }
+        return LATENCY_HIST_BUCKETS * LATENCY_HIST_STEP_US;
+    }
+};
+
+#endif
@@ -0,0 +1,109 @@
+#include "Storage.h"
+#include <EEPROM.h>
+
+uint32_t Storage::crc32(const void* data, size_t size, uint32_t crc) {
+    // Bitweise CRC-32 (IEEE), ohne Tabelle: läuft nur beim Laden/Speichern
+    const uint8_t* p = (const uint8_t*)data;
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= p[i];
+        for (int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
+
+static void readBytes(int addr, void* data, size_t size) {
+    uint8_t* p = (uint8_t*)data;
+    for (size_t i = 0; i < size; i++) p[i] = EEPROM.read(addr + (int)i);
+}
+
+static void writeBytes(int addr, const void* data, size_t size) {
+    const uint8_t* p = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++) EEPROM.update(addr + (int)i, p[i]);
+}
+
+bool Storage::load(int addr, uint32_t magic, void* data, uint16_t size) {
+    uint32_t storedMagic;
+    uint16_t storedSize;
+    readBytes(addr, &storedMagic, 4);
+    readBytes(addr + 4, &storedSize, 2);
+    if (storedMagic != magic || storedSize != size || size > STORAGE_MAX_RECORD) return false;
+
+    // Erst prüfen, dann übernehmen: bei CRC-Fehler bleibt data unverändert
+    static uint8_t buffer[STORAGE_MAX_RECORD];
+    uint32_t storedCrc;
+    readBytes(addr + 8, buffer, size);
+    readBytes(addr + 8 + size, &storedCrc, 4);
+    if (crc32(buffer, size) != storedCrc) return false;
+
+    memcpy(data, buffer, size);
+    return true;
+}
+
+void Storage::save(int addr, uint32_t magic, const void* data, uint16_t size) {
+    // Unveränderter Datensatz -> gar nicht schreiben
+    static uint8_t current[STORAGE_MAX_RECORD];
+    if (size <= STORAGE_MAX_RECORD && load(addr, magic, current, size) &&
+        memcmp(current, data, size) == 0) return;
+
+    // Magic zuletzt schreiben: ein abgebrochener Schreibvorgang hinterlässt keinen gültigen Satz
+    uint32_t invalid = 0xFFFFFFFFUL;
+    uint16_t reserved = 0;
+    uint32_t crc = crc32(data, size);
+    writeBytes(addr, &invalid, 4);
+    writeBytes(addr + 4, &size, 2);
+    writeBytes(addr + 6, &reserved, 2);
+    writeBytes(addr + 8, data, size);
+    writeBytes(addr + 8 + size, &crc, 4);
+    writeBytes(addr, &magic, 4);
+}
+
+void Storage::erase(int addr) {
+    uint32_t invalid = 0xFFFFFFFFUL;
+    writeBytes(addr, &invalid, 4);
+}
+
+// --- SLOT-RING ---
+void SlotRing::init(int baseAddr, int numSlots, uint32_t recordMagic, uint16_t recordSize) {
+    base = baseAddr;
+    slots = numSlots;
+    magic = recordMagic;
+    size = recordSize;
+    sequence = 0;
+    nextSlot = 0;
+    saves = 0;
+}
+
+bool SlotRing::loadLatest(void* data) {
+    // Datensatz = [Nummer 4][Nutzdaten size]
+    static uint8_t buffer[STORAGE_MAX_RECORD];
+    bool found = false;
+    for (int s = 0; s < slots; s++) {
+        if (!Storage::load(slotAddr(s), magic, buffer, size + 4)) continue;
+        uint32_t seq;
+        memcpy(&seq, buffer, 4);
+        if (!found || (int32_t)(seq - sequence) > 0) {
+            found = true;
+            sequence = seq;
+            nextSlot = (s + 1) % slots;
+            memcpy(data, buffer + 4, size);
+        }
+    }
+    return found;
+}
+
+void SlotRing::save(const void* data) {
+    static uint8_t buffer[STORAGE_MAX_RECORD];
+    uint32_t seq = sequence + 1;
+    memcpy(buffer, &seq, 4);
+    memcpy(buffer + 4, data, size);
+    Storage::save(slotAddr(nextSlot), magic, buffer, size + 4);
+    sequence = seq;
+    nextSlot = (nextSlot + 1) % slots;
+    saves++;
+}
+
+void SlotRing::erase() {
+    for (int s = 0; s < slots; s++) Storage::erase(slotAddr(s));
+    nextSlot = 0;
+}
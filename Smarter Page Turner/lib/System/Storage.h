@@ -0,0 +1,58 @@
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <Arduino.h>
+
+// EEPROM-Aufteilung (Teensy 4.1: 4284 Bytes, emuliert im Flash)
+#define STORAGE_CONFIG_ADDR 0        // Laufzeit-Parameter (TrackerConfig)
+#define STORAGE_CONFIG_MAGIC 0x43464731UL  // "CFG1"
+#define STORAGE_MAX_RECORD 256       // Größter Datensatz in Bytes
+#define STORAGE_CHECKPOINT_ADDR 64   // Ring aus Tracker-Checkpoints (nach der Config)
+#define STORAGE_CHECKPOINT_SLOTS 8
+#define STORAGE_CHECKPOINT_MAGIC 0x434B5032UL  // "CKP2" (mit Partitur-Fingerabdruck)
+
+// Datensatz im EEPROM: [magic 4][size 2][reserviert 2][data size][crc32 4].
+// Ungültig (frisches EEPROM, andere Firmware-Version, halb geschrieben) -> load() liefert false.
+// Geschrieben wird nur, was sich geändert hat (EEPROM.update), um die Flash-Emulation zu schonen.
+namespace Storage {
+    uint32_t crc32(const void* data, size_t size, uint32_t crc = 0);
+
+    bool load(int addr, uint32_t magic, void* data, uint16_t size);
+    void save(int addr, uint32_t magic, const void* data, uint16_t size);
+    // Datensatz ungültig machen (nur das Magic überschreiben)
+    void erase(int addr);
+
+    // Belegte Bytes eines Datensatzes (für die Aufteilung weiterer Bereiche)
+    constexpr int recordSize(uint16_t size) { return 8 + size + 4; }
+}
+
+// Wear-Levelling für häufig geschriebene Daten: N Slots im Ring, jeder Datensatz trägt eine
+// fortlaufende Nummer. save() schreibt reihum in den nächsten Slot, loadLatest() nimmt den
+// gültigen Slot mit der höchsten Nummer. Jeder Slot wird so nur bei jedem N-ten Speichern belastet,
+// und ein abgebrochener Schreibvorgang kostet höchstens den neuesten Stand.
+class SlotRing {
+public:
+    void init(int baseAddr, int slots, uint32_t magic, uint16_t size);
+    bool loadLatest(void* data);
+    void save(const void* data);
+    // Alle Slots ungültig machen (z.B. Stück zu Ende -> kein Wiederanlauf)
+    void erase();
+
+    uint32_t getSequence() const { return sequence; }
+    uint32_t getSaves() const { return saves; }
+    // Bytes im EEPROM, die der Ring belegt
+    int footprint() const { return slots * Storage::recordSize(size + 4); }
+
+private:
+    int base = 0;
+    int slots = 1;
+    uint32_t magic = 0;
+    uint16_t size = 0;
+    uint32_t sequence = 0;   // Nummer des zuletzt geschriebenen Datensatzes
+    int nextSlot = 0;
+    uint32_t saves = 0;
+
+    int slotAddr(int slot) const { return base + slot * Storage::recordSize(size + 4); }
+};
+
+#endif
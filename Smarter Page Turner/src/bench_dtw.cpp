@@ -0,0 +1,89 @@
+#include <Arduino.h>
+#include "Chroma.h"
+#include "AGC.h"
+#include "Distance.h"
+
+// Benchmark: Kosten des Distanz-Kernels pro Chroma-Breite und eines kompletten DSP-Frames.
+// Gemessen mit dem Zykluszähler (ARM_DWT_CYCCNT), 600 MHz -> 600 Zyklen = 1 us.
+
+#define BENCH_WINDOW 201        // Zellen pro DTW-Spalte (2 * CALC_RADIUS + 1)
+#define BENCH_REPEATS 100
+
+// Synthetische "Partitur" im RAM, groß genug für 36 Bins
+float benchScore[BENCH_WINDOW][36];
+float benchLive[36];
+volatile float sink;            // Verhindert, dass der Compiler die Schleifen wegoptimiert
+
+AudioDSP dsp;
+BlockAGC agc;
+int16_t audioBuffer[FFT_SIZE];
+float chromaVector[NUM_CHROMA];
+
+template <int N>
+uint32_t benchKernel() {
+    uint32_t start = ARM_DWT_CYCCNT;
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        float acc = 0.0f;
+        for (int j = 0; j < BENCH_WINDOW; j++) {
+            acc += chromaDot<N>(benchLive, benchScore[j]);
+        }
+        sink = acc;
+    }
+    return (ARM_DWT_CYCCNT - start) / BENCH_REPEATS;
+}
+
+void printResult(const char* name, uint32_t cycles) {
+    Serial.print(name);
+    Serial.print(": ");
+    Serial.print(cycles);
+    Serial.print(" Zyklen (");
+    Serial.print(cycles / (F_CPU_ACTUAL / 1000000.0f), 1);
+    Serial.println(" us)");
+}
+
+void setup() {
+    Serial.begin(115200);
+    while (!Serial && millis() < 3000) {}
+
+    // Zykluszähler aktivieren
+    ARM_DEMCR |= ARM_DEMCR_TRCENA;
+    ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+
+    randomSeed(42);
+    for (int j = 0; j < BENCH_WINDOW; j++) {
+        for (int k = 0; k < 36; k++) benchScore[j][k] = random(1000) / 1000.0f;
+    }
+    for (int k = 0; k < 36; k++) benchLive[k] = random(1000) / 1000.0f;
+
+    // Sinus + Rauschen als Audio-Frame
+    for (int i = 0; i < FFT_SIZE; i++) {
+        audioBuffer[i] = (int16_t)(8000.0f * sinf(2.0f * PI * 440.0f * i / SAMPLE_RATE) + random(-200, 200));
+    }
+    dsp.init();
+    agc.init(SAMPLE_RATE);
+}
+
+void loop() {
+    Serial.println("--- DTW-Spalte (201 Zellen, nur Skalarprodukt) ---");
+    printResult("12 Bins", benchKernel<12>());
+    printResult("24 Bins", benchKernel<24>());
+    printResult("36 Bins", benchKernel<36>());
+
+    uint32_t start = ARM_DWT_CYCCNT;
+    dsp.process(audioBuffer, chromaVector);
+    Serial.print("--- AudioDSP::process, NUM_CHROMA = ");
+    Serial.print(NUM_CHROMA);
+    Serial.println(" ---");
+    printResult("Frame", ARM_DWT_CYCCNT - start);
+
+    // AGC läuft auf allen 32 Blöcken eines Frames (Kopie, damit der DSP-Frame gleich bleibt)
+    static int16_t agcBuffer[FFT_SIZE];
+    memcpy(agcBuffer, audioBuffer, sizeof(agcBuffer));
+    start = ARM_DWT_CYCCNT;
+    for (int b = 0; b < FFT_SIZE; b += AGC_BLOCK_SIZE) agc.process(agcBuffer + b, AGC_BLOCK_SIZE);
+    Serial.println("--- BlockAGC, 32 Blöcke = 1 Frame ---");
+    printResult("Frame", ARM_DWT_CYCCNT - start);
+
+    Serial.println();
+    delay(2000);
+}
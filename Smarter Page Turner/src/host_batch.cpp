@@ -0,0 +1,298 @@
+#include <Arduino.h>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "WavFile.h"
+#include "Settings.h"
+#include "Chroma.h"
+#include "Activity.h"
+#include "FeatureStage.h"
+#include "AGC.h"
+#include "DTW.h"
+#include "BatchDTW.h"
+#include "TrackStage.h"
+#include "ScoreData.h"
+#include "ScoreStore.h"
+
+// Batch-Auswertung: viele Aufnahmen desselben Stücks gegen eine Partitur (Regression, Parameter-Suche).
+// Rechnet die Aufführungen einmal mit unabhängigen DTWTrackern und einmal mit dem BatchTracker
+// (BatchDTW.h), vergleicht Frame für Frame die Positionen und misst den Durchsatz der DTW-Stufe.
+//
+//   host_batch [--copies K] [--stagger F] [--tempo P] [--lockstep] [--set name=wert]
+//              [--store DIR [--score NAME]] aufnahme.wav [weitere.wav ...]
+//
+//   --copies K   Jede Aufnahme K-mal (Standard 16)
+//   --stagger F  Kopie c setzt c*F Live-Frames später ein (Standard 3)
+//   --tempo P    Kopien gleichmäßig zwischen Tempo 1-P und 1+P gestreckt (z.B. 0.15; Standard 0): Frames
+//                werden wiederholt bzw. ausgelassen, wie eine langsamere oder schnellere Aufführung
+//   --lockstep   Alle Aufführungen im Live-Takt (ein Frame pro Takt); sonst nach Partitur-Position
+//                (BatchTracker::pace), was offline erlaubt ist, weil alle Eingaben vorliegen
+//   --set N=W    Tracker-Parameter (wie host_replay)
+//   --store DIR  Partitur aus einem Partitur-Speicher (ScoreStore.h), --score NAME wählt sie aus
+//
+// Die DSP (AGC, FeatureStage, CENS, Schlag-Raster) läuft vorher einmal pro Aufnahme, gemessen wird nur
+// das Tracking. Ein Thread: die Zahlen sind Updates pro Sekunde und Kern.
+
+// Eingabe eines Frames für den Tracker, nach der DSP
+struct TrackInput {
+    uint8_t kind;                // BatchInput
+    float snr;
+    float onset;
+    float advance;               // Segmentlänge in Schlägen (Schlag-Raster), sonst 1
+    float chroma[NUM_CHROMA];
+};
+
+static_assert((int)TRACK_NONE == (int)BATCH_NONE && (int)TRACK_UPDATE == (int)BATCH_UPDATE &&
+              (int)TRACK_REST == (int)BATCH_REST, "TrackAction und BatchInput müssen übereinstimmen");
+
+// DSP-Kette und TrackStage wie Session in host_server.cpp, nur ohne Tracker: Eingaben aufzeichnen
+static void extractInputs(const std::vector<int16_t>& samples, float rate, std::vector<TrackInput>& out) {
+    BlockAGC agc;
+    FeatureStage features;
+    FeatureQueue queue;
+    TrackStage stage;
+    FeatureFrame f;
+    DTWTracker clock;            // Nur für das Zeitraster (live_frames_per_beat), wird nie gerechnet
+    clock.setFrameClock(rate, FFT_SIZE);
+    agc.init(rate);
+    features.init(rate);
+    stage.init(clock);
+
+    int16_t block[128];
+    size_t pos = 0;
+    while (pos < samples.size()) {
+        int n = (int)std::min<size_t>(128, samples.size() - pos);
+        memcpy(block, &samples[pos], n * sizeof(int16_t));
+        pos += n;
+        agc.process(block, n);
+        if (features.push(block, n, queue) == 0 || !queue.pop(f)) continue;
+
+        TrackInput in;
+        in.kind = stage.prepare(f);
+        in.snr = f.snr;
+        in.onset = f.onset;
+        in.advance = 1.0f;
+        memcpy(in.chroma, f.chroma, sizeof(in.chroma));
+        if (in.kind == TRACK_UPDATE) {
+            in.snr = stage.snr;
+            in.onset = stage.onset;
+            in.advance = stage.advance;
+            memcpy(in.chroma, stage.input, sizeof(in.chroma));
+        }
+        out.push_back(in);
+    }
+}
+
+// Positionsverlauf einer Aufführung als Prüfsumme (FNV-1a)
+static void hashPosition(uint32_t& h, int pos) {
+    for (int b = 0; b < 4; b++) {
+        h ^= (uint8_t)(pos >> (8 * b));
+        h *= 16777619u;
+    }
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+}
+
+int main(int argc, char** argv) {
+    int copies = 16;
+    int stagger = 3;
+    float tempoSpread = 0.0f;
+    bool lockstep = false;
+    TrackerConfig config = defaultTrackerConfig();
+    std::vector<const char*> paths;
+    ScoreStore store;
+    const char* storeDir = nullptr;
+    const char* scoreName = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--copies") && i + 1 < argc) copies = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--stagger") && i + 1 < argc) stagger = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--tempo") && i + 1 < argc) tempoSpread = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--lockstep")) lockstep = true;
+        else if (!strcmp(argv[i], "--store") && i + 1 < argc) storeDir = argv[++i];
+        else if (!strcmp(argv[i], "--score") && i + 1 < argc) scoreName = argv[++i];
+        else if (!strcmp(argv[i], "--set") && i + 1 < argc) {
+            char* arg = argv[++i];
+            char* eq = strchr(arg, '=');
+            const ConfigParam* p = nullptr;
+            if (eq) {
+                *eq = '\0';
+                p = findConfigParam(arg);
+            }
+            if (!p || !configSet(config, *p, atof(eq + 1))) {
+                fprintf(stderr, "FEHLER: --set %s ungültig\n", arg);
+                return 1;
+            }
+        }
+        else if (argv[i][0] != '-') paths.push_back(argv[i]);
+        else {
+            fprintf(stderr, "Aufruf: %s [--copies K] [--stagger F] [--tempo P] [--lockstep] [--set name=wert] [--store DIR [--score NAME]] aufnahme.wav [...]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (paths.empty() || copies < 1 || stagger < 0 || tempoSpread < 0.0f || tempoSpread >= 1.0f) {
+        fprintf(stderr, "FEHLER: keine Aufnahme bzw. --copies/--stagger/--tempo ungültig\n");
+        return 1;
+    }
+
+    const ScoreView* view = &score_library[config.score_index < score_library_size ? config.score_index : 0];
+    if (storeDir) {
+        if (!store.open(storeDir) || store.size() == 0) {
+            fprintf(stderr, "FEHLER: Partitur-Speicher %s: %s\n", storeDir,
+                    store.getError()[0] ? store.getError() : "keine passende Partitur");
+            return 1;
+        }
+        int idx = scoreName ? store.find(scoreName) : 0;
+        if (idx < 0) {
+            fprintf(stderr, "FEHLER: Partitur %s nicht im Speicher\n", scoreName);
+            return 1;
+        }
+        view = store.view(idx);
+    }
+
+    // --- DSP (einmal pro Aufnahme) ---
+    std::vector<std::vector<TrackInput>> inputs(paths.size());
+    std::vector<float> rates(paths.size());
+    for (size_t r = 0; r < paths.size(); r++) {
+        std::vector<int16_t> samples;
+        if (!readWav(paths[r], samples, rates[r])) {
+            fprintf(stderr, "FEHLER: %s nicht lesbar oder kein PCM16\n", paths[r]);
+            return 1;
+        }
+        extractInputs(samples, rates[r], inputs[r]);
+    }
+    for (size_t r = 1; r < rates.size(); r++) {
+        if (rates[r] != rates[0]) {
+            fprintf(stderr, "FEHLER: %s hat %.0f Hz, der Batch braucht ein gemeinsames Zeitraster (%.0f Hz)\n",
+                    paths[r], rates[r], rates[0]);
+            return 1;
+        }
+    }
+
+    // Aufführung l: Aufnahme l % R als Kopie c = l / R, setzt c * stagger Frames später ein und spielt
+    // im Tempo stretch[l] (Frame k der Kopie ist Frame k * stretch der Aufnahme)
+    const int lanes = (int)paths.size() * copies;
+    std::vector<const std::vector<TrackInput>*> source(lanes);
+    std::vector<int> delay(lanes), length(lanes);
+    std::vector<float> stretch(lanes);
+    for (int l = 0; l < lanes; l++) {
+        int c = l / (int)paths.size();
+        source[l] = &inputs[l % paths.size()];
+        delay[l] = c * stagger;
+        stretch[l] = (copies > 1) ? 1.0f + tempoSpread * (2.0f * c / (copies - 1) - 1.0f) : 1.0f;
+        length[l] = delay[l] + (int)(source[l]->size() / stretch[l]);
+    }
+    // Frame k von Aufführung l; nullptr = nichts (vor dem Einsatz)
+    auto inputAt = [&](int l, int k) -> const TrackInput* {
+        if (k < delay[l]) return nullptr;
+        return &(*source[l])[(size_t)((k - delay[l]) * stretch[l])];
+    };
+
+    // Tracker melden Start und Seitenwechsel über Serial/Serial1; hier nur Zahlen
+    Serial.quiet = true;
+    Serial1.quiet = true;
+
+    // --- UNABHÄNGIGE TRACKER ---
+    // Jeder Tracker am Stück durch seine Aufnahme (Spalten bleiben im Cache)
+    std::vector<std::unique_ptr<DTWTracker>> trackers(lanes);
+    for (int l = 0; l < lanes; l++) {
+        trackers[l].reset(new DTWTracker());
+        trackers[l]->setConfig(config);
+        trackers[l]->setScore(view);
+        trackers[l]->setFrameClock(rates[0], FFT_SIZE);
+        trackers[l]->setRadius(config.radius);
+    }
+    std::vector<uint32_t> traceSingle(lanes, 2166136261u);
+    uint64_t updates = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int l = 0; l < lanes; l++) {
+        DTWTracker& tr = *trackers[l];
+        for (int k = 0; k < length[l]; k++) {
+            const TrackInput* in = inputAt(l, k);
+            if (in && in->kind == BATCH_UPDATE) {
+                tr.update((float*)in->chroma, in->snr, in->onset, in->advance);
+                updates++;
+            }
+            else if (in && in->kind == BATCH_REST) tr.rest();
+            hashPosition(traceSingle[l], tr.current_position);
+        }
+    }
+    double singleSeconds = secondsSince(start);
+
+    // --- BATCH-TRACKER ---
+    BatchTracker batch;
+    batch.init(view, lanes, config);
+    batch.setFrameClock(rates[0], FFT_SIZE);
+    std::vector<float> live((size_t)lanes * NUM_CHROMA, 0.0f), snr(lanes, 0.0f), onset(lanes, 0.0f);
+    std::vector<float> advance(lanes, 1.0f);
+    std::vector<uint8_t> kind(lanes, BATCH_NONE), pending(lanes), go(lanes);
+    std::vector<int> cursor(lanes, 0);
+    std::vector<uint32_t> traceBatch(lanes, 2166136261u);
+    int ticks = 0;
+    start = std::chrono::steady_clock::now();
+    for (;; ticks++) {
+        bool more = false;
+        for (int l = 0; l < lanes; l++) {
+            pending[l] = cursor[l] < length[l];
+            more |= pending[l];
+        }
+        if (!more) break;
+        if (lockstep) memcpy(go.data(), pending.data(), lanes);
+        else batch.pace(pending.data(), go.data());
+
+        for (int l = 0; l < lanes; l++) {
+            const TrackInput* in = go[l] ? inputAt(l, cursor[l]) : nullptr;
+            kind[l] = in ? in->kind : (uint8_t)BATCH_NONE;
+            if (!in) continue;
+            snr[l] = in->snr;
+            onset[l] = in->onset;
+            advance[l] = in->advance;
+            memcpy(&live[(size_t)l * NUM_CHROMA], in->chroma, sizeof(in->chroma));
+        }
+        batch.update(live.data(), snr.data(), onset.data(), kind.data(), advance.data());
+        for (int l = 0; l < lanes; l++) {
+            if (!go[l]) continue;
+            hashPosition(traceBatch[l], batch.get(l).current_position);
+            cursor[l]++;
+        }
+    }
+    double batchSeconds = secondsSince(start);
+
+    // --- VERGLEICH ---
+    int mismatches = 0;
+    for (int l = 0; l < lanes; l++) {
+        const DTWTracker& a = *trackers[l];
+        const BatchLane& b = batch.get(l);
+        if (traceSingle[l] != traceBatch[l] || a.next_page_idx != b.next_page_idx || a.finished != b.finished ||
+            a.tempo != b.tempo || a.cost != b.cost || a.confidence != b.confidence) {
+            if (mismatches < 5) {
+                printf("ABWEICHUNG Aufführung %d: Position %d/%d, Seite %d/%d, Tempo %.4f/%.4f\n", l,
+                       a.current_position, b.current_position, a.next_page_idx, b.next_page_idx, a.tempo, b.tempo);
+            }
+            mismatches++;
+        }
+    }
+
+    int lo = batch.get(0).current_position, hi = lo;
+    for (int l = 1; l < lanes; l++) {
+        lo = std::min(lo, batch.get(l).current_position);
+        hi = std::max(hi, batch.get(l).current_position);
+    }
+    printf("Batch: %d Aufführung(en) (%zu Aufnahme(n) x %d, Versatz %d Frames, Tempo +-%.0f %%), Partitur %s (%d Frames), Radius %d, %d Spuren/Kachel\n",
+           lanes, paths.size(), copies, stagger, 100.0f * tempoSpread, view->name, view->len, batch.radius, BATCH_LANES);
+    printf("%llu DTW-Updates in %d Takten (%s), Ende %d..%d\n", (unsigned long long)updates, ticks,
+           lockstep ? "Live-Takt" : "nach Partitur-Position", lo, hi);
+    if (updates > 0) {
+        printf("Unabhängig: %8.3f s  %10.0f Updates/s\n", singleSeconds, updates / singleSeconds);
+        printf("Batch:      %8.3f s  %10.0f Updates/s  (x%.2f)\n", batchSeconds, updates / batchSeconds,
+               singleSeconds / batchSeconds);
+    } else {
+        printf("Keine DTW-Updates (Aufnahme zu leise, START_THRESHOLD nie überschritten?)\n");
+    }
+    printf("Auslastung der Kacheln %.0f %%, %u Umverteilung(en)\n",
+           batch.computedCells ? 100.0 * batch.usefulCells / batch.computedCells : 0.0, batch.regroups);
+    printf("Ergebnis: %s\n", mismatches ? "ABWEICHUNGEN" : "identisch");
+    return mismatches ? 2 : 0;
+}
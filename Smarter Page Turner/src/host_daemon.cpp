@@ -0,0 +1,504 @@
+#include <Arduino.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "Settings.h"
+#include "Chroma.h"
+#include "Activity.h"
+#include "FeatureStage.h"
+#include "Resampler.h"
+#include "AGC.h"
+#include "Scheduler.h"
+#include "SpscQueue.h"
+#include "DTW.h"
+#include "TrackStage.h"
+#include "ScoreData.h"
+#include "ScoreStore.h"
+
+// Host-Daemon: Score-Following auf einem Linux-Rechner als Rückfallebene zum Teensy. Liest PCM16 von
+// stdin, aus einer FIFO oder einer Datei (WAV oder roh) und meldet Position und Seitenwechsel über
+// einen UNIX-Socket. Kein Audio-Gerät nötig, z.B.:
+//   arecord -f S16_LE -r 44100 -c 1 -t raw | host_daemon --rate 44100
+//   host_daemon --input aufnahme.wav &  socat - UNIX-CONNECT:/tmp/pageturner.sock
+//
+//   host_daemon [--input -|fifo|datei.wav|datei.raw] [--rate HZ] [--channels N] [--socket PFAD]
+//               [--fast] [--realtime] [--resample] [--no-agc] [--set name=wert] [--seek frame] [--quiet]
+//               [--store DIR [--score NAME]]
+//
+//   --input P    Quelle ("-" = stdin, Standard). WAV wird am RIFF-Kopf erkannt, sonst roh S16LE.
+//   --rate HZ    Samplerate roher Daten (Standard 44100) bzw. Korrektur für WAV (Teensy: 44117.647)
+//   --channels N Kanäle roher Daten (Standard 1), verwendet wird der erste
+//   --socket P   UNIX-Socket für Ereignisse (Standard /tmp/pageturner.sock)
+//   --fast       Dateien so schnell wie möglich verarbeiten (Test); Standard bei Dateien ist Echtzeit
+//   --realtime   Auch Pipes im Takt der Samplerate lesen (wenn der Erzeuger schneller liefert)
+//   --resample, --no-agc, --set, --seek wie host_replay
+//   --quiet      Keine Ausgabe pro Frame
+//   --store DIR  Partitur aus einem Partitur-Speicher (ScoreStore.h) statt der eingebundenen score_library;
+//                viele Daemons teilen sich dann dieselben Seiten. --score NAME wählt sie aus (Standard: erste)
+//
+// Threads: der Lese-Thread holt Blöcke à 128 Samples und reicht sie über eine lock-freie SpscQueue an
+// den Verarbeitungs-Thread (AGC -> FeatureStage -> featureQueue -> CENS -> DTW). Ist die Queue voll,
+// verwirft der Lese-Thread (Echtzeit) bzw. wartet (--fast). Latenz pro Frame = Eintreffen des
+// letzten Blocks bis zur Entscheidung des Trackers.
+//
+// Ereignisse (eine Zeile pro Ereignis, an alle verbundenen Clients):
+//   POS <zeit_s> <frame> <partitur_s> <seite> <tempo> <konfidenz> <latenz_us>   (jeder Frame, wenn aktiv)
+//   PAUSE <zeit_s> <frame>                                                       (Frame ohne Musik)
+//   TURN <seite> <frame>                                                         (Seitenwechsel)
+//   END <frame>                                                                  (Stückende / Eingabe zu Ende)
+
+#define DAEMON_BLOCK_SAMPLES 128     // Wie AudioRecordQueue
+#define DAEMON_BLOCK_QUEUE 256       // ~750 ms bei 44.1 kHz
+#define DAEMON_IDLE_SLEEP_US 200     // Verarbeitungs-Thread pollt die leere Queue in diesem Abstand
+#define DAEMON_MAX_CLIENTS 16
+#define DAEMON_MAX_CHANNELS 16
+#define DAEMON_EVENT_MAX 160         // Längste Ereigniszeile
+#define DAEMON_DEFAULT_SOCKET "/tmp/pageturner.sock"
+
+struct PcmBlock {
+    int16_t samples[DAEMON_BLOCK_SAMPLES];
+    int count;
+    uint32_t arrived;        // micros() nach dem Lesen
+};
+
+FeatureStage features;
+FeatureQueue featureQueue;
+SpscQueue<PcmBlock, DAEMON_BLOCK_QUEUE> blockQueue;
+DTWTracker tracker;
+TrackStage trackStage;
+FrameScheduler scheduler;
+PolyphaseResampler resampler;
+BlockAGC agc;
+ScoreStore store;
+
+float liveRate = 0.0f;
+bool quiet = false;
+uint32_t frameCount = 0;
+QueueLatency frameLatency;       // Block da -> Tracker-Entscheidung
+LatencyHistogram latencyHist;
+uint32_t lateFrames = 0;         // Latenz über eine Frame-Periode
+
+std::atomic<bool> stopRequested{false};
+std::atomic<bool> readerDone{false};
+
+// --- EINGABE ---
+// PCM16 aus Datei, FIFO oder Pipe. Ein WAV-Kopf wird auch im Datenstrom erkannt und übersprungen.
+class PcmSource {
+public:
+    float rate = 44100.0f;
+    int channels = 1;
+    bool regularFile = false;
+
+    bool open(const char* path) {
+        fd = (!strcmp(path, "-")) ? STDIN_FILENO : ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        regularFile = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+        return readHeader();
+    }
+
+    // Bis zu count Samples (erster Kanal) lesen; 0 = Ende der Eingabe oder Stopp.
+    // Ein Block am Stück (ein read() pro Block statt pro Sample), dann im Speicher entflechten
+    int read(int16_t* out, int count) {
+        if (count > DAEMON_BLOCK_SAMPLES) count = DAEMON_BLOCK_SAMPLES;
+        size_t frameBytes = channels * sizeof(int16_t);
+        int n = (int)(readSome(interleaved, count * frameBytes) / frameBytes);   // Teil-Frame am Ende verwerfen
+        for (int i = 0; i < n; i++) out[i] = interleaved[i * channels];
+        return n;
+    }
+
+private:
+    int fd = -1;
+    uint8_t pending[12];
+    int pendingLen = 0;
+    int pendingPos = 0;
+    int16_t interleaved[DAEMON_BLOCK_SAMPLES * DAEMON_MAX_CHANNELS];
+
+    // Genau len Bytes; weniger nur bei EOF, Fehler oder Stopp. Wartet mit poll(), damit SIGINT durchkommt.
+    size_t readSome(void* data, size_t len) {
+        uint8_t* p = (uint8_t*)data;
+        size_t got = 0;
+        while (got < len && pendingPos < pendingLen) p[got++] = pending[pendingPos++];
+        while (got < len) {
+            struct pollfd pfd = {fd, POLLIN, 0};
+            int ready = poll(&pfd, 1, 100);
+            if (stopRequested.load()) break;
+            if (ready < 0 && errno != EINTR) break;
+            if (ready <= 0) continue;
+            ssize_t r = ::read(fd, p + got, len - got);
+            if (r < 0 && errno == EINTR) continue;
+            if (r <= 0) break;
+            got += r;
+        }
+        return got;
+    }
+
+    bool readFull(void* data, size_t len) {
+        return readSome(data, len) == len;
+    }
+
+    bool skip(uint32_t bytes) {
+        uint8_t tmp[256];
+        while (bytes) {
+            uint32_t n = bytes < sizeof(tmp) ? bytes : sizeof(tmp);
+            if (!readFull(tmp, n)) return false;
+            bytes -= n;
+        }
+        return true;
+    }
+
+    // RIFF/WAVE -> Kanäle und Rate übernehmen, bis "data" vorspulen; sonst die 12 Bytes als PCM behalten
+    bool readHeader() {
+        if (!readFull(pending, sizeof(pending))) return false;
+        if (memcmp(pending, "RIFF", 4) || memcmp(pending + 8, "WAVE", 4)) {
+            pendingLen = sizeof(pending);
+            return true;
+        }
+        char id[4];
+        uint32_t size;
+        int bits = 0;
+        while (readFull(id, 4) && readFull(&size, 4)) {
+            if (!memcmp(id, "fmt ", 4)) {
+                uint8_t fmt[16];
+                if (size < 16 || !readFull(fmt, 16)) return false;
+                channels = fmt[2] | (fmt[3] << 8);
+                rate = (float)(fmt[4] | (fmt[5] << 8) | (fmt[6] << 16) | ((uint32_t)fmt[7] << 24));
+                bits = fmt[14] | (fmt[15] << 8);
+                if (!skip(size - 16 + (size & 1))) return false;
+            } else if (!memcmp(id, "data", 4)) {
+                return bits == 16 && channels >= 1 && channels <= DAEMON_MAX_CHANNELS;
+            } else if (!skip(size + (size & 1))) {
+                return false;
+            }
+        }
+        return false;
+    }
+};
+
+PcmSource source;
+
+// Lese-Thread: nur lesen, stempeln, einreihen. pace = im Takt der Samplerate (Dateien)
+void readerThread(bool pace, bool wait) {
+    // Signale gehen an den Verarbeitungs-Thread
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t samples = 0;
+    PcmBlock block;
+    while (!stopRequested.load()) {
+        block.count = source.read(block.samples, DAEMON_BLOCK_SAMPLES);
+        if (block.count <= 0) break;
+        block.arrived = (uint32_t)micros();
+        // Ohne Echtzeit (--fast) auf den Verbraucher warten statt zu verwerfen
+        while (wait && blockQueue.size() >= blockQueue.capacity() && !stopRequested.load()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(DAEMON_IDLE_SLEEP_US));
+        }
+        blockQueue.push(block);
+        samples += block.count;
+        if (pace) {
+            std::this_thread::sleep_until(start + std::chrono::microseconds((uint64_t)(samples * 1e6 / source.rate)));
+        }
+    }
+    readerDone.store(true);
+}
+
+// --- EREIGNISSE ---
+// UNIX-Stream-Socket, beliebig viele Leser (bis DAEMON_MAX_CLIENTS). Senden blockiert nie:
+// wer nicht abnimmt, verliert ganze Zeilen; wer die Verbindung schließt, wird entfernt.
+// Nimmt der Socket nur einen Teil einer Zeile, wird der Rest gemerkt und vor der nächsten Zeile
+// nachgeschickt; solange er hängt, fallen neue Zeilen für diesen Client weg (nie halbe Zeilen).
+class EventSocket {
+public:
+    bool open(const char* socketPath) {
+        path = socketPath;
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (listenFd < 0) return false;
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (strlen(path) >= sizeof(addr.sun_path)) return false;
+        strcpy(addr.sun_path, path);
+        unlink(path);
+        return bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) == 0 && listen(listenFd, 4) == 0;
+    }
+
+    void close() {
+        for (Client& c : clients) ::close(c.fd);
+        clients.clear();
+        if (listenFd >= 0) {
+            ::close(listenFd);
+            unlink(path);
+        }
+        listenFd = -1;
+    }
+
+    // Neue Verbindungen annehmen (einmal pro Frame)
+    void accept() {
+        int fd;
+        while ((fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK)) >= 0) {
+            if ((int)clients.size() >= DAEMON_MAX_CLIENTS) {
+                ::close(fd);
+                continue;
+            }
+            clients.push_back(Client{fd, {}, 0});
+        }
+    }
+
+    void publish(const char* line) {
+        size_t len = strlen(line);
+        if (len > DAEMON_EVENT_MAX) len = DAEMON_EVENT_MAX;
+        for (size_t i = 0; i < clients.size();) {
+            Client& c = clients[i];
+            ssize_t r = 0;
+            // Erst den Rest der angefangenen Zeile, sonst klebt die neue an einem Bruchstück
+            if (c.tailLen) {
+                r = sendSome(c.fd, c.tail, c.tailLen);
+                if (r > 0) {
+                    c.tailLen -= r;
+                    memmove(c.tail, c.tail + r, c.tailLen);
+                }
+            }
+            if (r >= 0 && c.tailLen == 0) {
+                r = sendSome(c.fd, line, len);
+                if (r > 0 && (size_t)r < len) {
+                    c.tailLen = len - r;
+                    memcpy(c.tail, line + r, c.tailLen);
+                }
+                if (r == 0) dropped++;      // Nichts angenommen: Zeile entfällt ganz
+            } else if (r >= 0) {
+                dropped++;                  // Rest hängt noch: Client liest zu langsam
+            }
+            if (r < 0) {
+                ::close(c.fd);
+                clients.erase(clients.begin() + i);
+                continue;
+            }
+            i++;
+        }
+    }
+
+    size_t getClients() const { return clients.size(); }
+    uint32_t getDropped() const { return dropped; }
+
+private:
+    const char* path = "";
+    int listenFd = -1;
+
+    // Gesendete Bytes, 0 = Socket voll, -1 = Verbindung weg. Blockiert nie.
+    static ssize_t sendSome(int fd, const char* data, size_t len) {
+        ssize_t r = send(fd, data, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (r >= 0) return r;
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+
+    struct Client {
+        int fd;
+        char tail[DAEMON_EVENT_MAX];   // Nicht angenommener Rest der letzten Zeile
+        size_t tailLen;
+    };
+    std::vector<Client> clients;
+    uint32_t dropped = 0;
+};
+
+EventSocket events;
+
+// --- VERARBEITUNG ---
+// Ein Frame aus der featureQueue durch die TrackStage, wie consumeFrame() in der Firmware.
+// arrived = Eintreffen des Blocks, der den Frame vollgemacht hat
+void consumeFrame(FeatureFrame& f, uint32_t arrived) {
+    float timestamp = (float)frameCount * FFT_SIZE / liveRate;
+    frameCount++;
+    int pageBefore = tracker.next_page_idx;
+    bool finishedBefore = tracker.finished;
+
+    scheduler.beginFrame();
+    scheduler.addWork(f.dspMicros);
+    bool tracked = trackStage.consume(f) != TRACK_REST;
+    scheduler.endFrame();
+    trackStage.applyDegradation(scheduler.getLevel(), features);
+
+    uint32_t latency = (uint32_t)micros() - arrived;
+    frameLatency.add(latency);
+    latencyHist.add(latency);
+    if (latency > FFT_SIZE / liveRate * 1e6f) lateFrames++;
+
+    char line[DAEMON_EVENT_MAX];
+    events.accept();
+    if (tracker.running) {
+        if (tracked) {
+            snprintf(line, sizeof(line), "POS %.3f %d %.2f %d %.2f %.2f %u\n", timestamp, tracker.current_position,
+                     tracker.frameToSeconds(tracker.current_position), tracker.next_page_idx, tracker.tempo,
+                     tracker.confidence, latency);
+        } else {
+            snprintf(line, sizeof(line), "PAUSE %.3f %d\n", timestamp, tracker.current_position);
+        }
+        events.publish(line);
+        if (!quiet) fputs(line, stdout);
+    }
+    if (tracker.next_page_idx != pageBefore) {
+        snprintf(line, sizeof(line), "TURN %d %d\n", tracker.next_page_idx, tracker.current_position);
+        events.publish(line);
+        fputs(line, stdout);
+    }
+    if (tracker.finished && !finishedBefore) {
+        snprintf(line, sizeof(line), "END %d\n", tracker.current_position);
+        events.publish(line);
+        fputs(line, stdout);
+    }
+}
+
+void onSignal(int) {
+    stopRequested.store(true);
+}
+
+int main(int argc, char** argv) {
+    const char* input = "-";
+    const char* socketPath = DAEMON_DEFAULT_SOCKET;
+    float rateArg = 0.0f;
+    int channelsArg = 0;
+    bool fast = false;
+    bool realtime = false;
+    bool resample = false;
+    bool useAgc = true;
+    int seekFrame = -1;
+    const char* storeDir = nullptr;
+    const char* scoreName = nullptr;
+    TrackerConfig config = defaultTrackerConfig();
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--input") && i + 1 < argc) input = argv[++i];
+        else if (!strcmp(argv[i], "--rate") && i + 1 < argc) rateArg = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "--channels") && i + 1 < argc) channelsArg = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--socket") && i + 1 < argc) socketPath = argv[++i];
+        else if (!strcmp(argv[i], "--fast")) fast = true;
+        else if (!strcmp(argv[i], "--realtime")) realtime = true;
+        else if (!strcmp(argv[i], "--resample")) resample = true;
+        else if (!strcmp(argv[i], "--no-agc")) useAgc = false;
+        else if (!strcmp(argv[i], "--seek") && i + 1 < argc) seekFrame = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--set") && i + 1 < argc) {
+            char* arg = argv[++i];
+            char* eq = strchr(arg, '=');
+            const ConfigParam* p = nullptr;
+            if (eq) {
+                *eq = '\0';
+                p = findConfigParam(arg);
+            }
+            if (!p || !configSet(config, *p, atof(eq + 1))) {
+                fprintf(stderr, "FEHLER: --set %s ungültig\n", arg);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--quiet")) quiet = true;
+        else if (!strcmp(argv[i], "--store") && i + 1 < argc) storeDir = argv[++i];
+        else if (!strcmp(argv[i], "--score") && i + 1 < argc) scoreName = argv[++i];
+        else {
+            fprintf(stderr, "Aufruf: %s [--input -|fifo|datei] [--rate HZ] [--channels N] [--socket PFAD] [--fast] [--realtime] [--resample] [--no-agc] [--set name=wert] [--seek frame] [--quiet] [--store DIR [--score NAME]]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const ScoreView* storeScore = nullptr;
+    if (storeDir) {
+        if (!store.open(storeDir)) {
+            fprintf(stderr, "FEHLER: %s\n", store.getError());
+            return 1;
+        }
+        storeScore = store.view(scoreName ? store.find(scoreName) : 0);
+        if (!storeScore) {
+            fprintf(stderr, "FEHLER: Partitur %s nicht im Speicher %s (%d passend, %d übersprungen)\n",
+                    scoreName ? scoreName : "", storeDir, store.size(), store.getSkipped());
+            return 1;
+        }
+    }
+
+    if (channelsArg > 0) source.channels = channelsArg;
+    if (!source.open(input)) {
+        fprintf(stderr, "FEHLER: %s nicht lesbar oder kein PCM16\n", input);
+        return 1;
+    }
+    if (rateArg > 0.0f) source.rate = rateArg;
+    if (source.channels < 1 || source.channels > DAEMON_MAX_CHANNELS) {
+        fprintf(stderr, "FEHLER: %d Kanäle\n", source.channels);
+        return 1;
+    }
+    if (!events.open(socketPath)) {
+        fprintf(stderr, "FEHLER: Socket %s nicht anlegbar (%s)\n", socketPath, strerror(errno));
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+    Serial.quiet = quiet;
+    Serial1.quiet = true;     // Befehle an den ESP32 gibt es hier nicht, Seitenwechsel kommen als TURN
+
+    liveRate = resample ? SCORE_SAMPLE_RATE : source.rate;
+    if (resample) resampler.init(source.rate, SCORE_SAMPLE_RATE);
+    agc.init(source.rate);
+    features.init(liveRate);
+    tracker.setConfig(config);
+    if (storeScore) tracker.setScore(storeScore);   // Ohne Umweg über die score_library
+    else tracker.init();
+    if (seekFrame >= 0) tracker.seek(seekFrame);
+    tracker.setFrameClock(liveRate, FFT_SIZE);
+    trackStage.init(tracker);
+    scheduler.init(FFT_SIZE / liveRate);
+
+    bool pace = !fast && (source.regularFile || realtime);
+    fprintf(stderr, "Daemon: %s, %d Kanäle @ %.3f Hz%s, Socket %s, Partitur %s (%d Frames)\n", input,
+            source.channels, source.rate, pace ? " (Echtzeit)" : "", socketPath, tracker.score->name,
+            tracker.score->len);
+
+    std::thread reader(readerThread, pace, fast);
+
+    int16_t resampled[RESAMPLER_MAX_BLOCK + 4];
+    uint32_t start = (uint32_t)millis();
+    while (!stopRequested.load()) {
+        PcmBlock block;
+        if (!blockQueue.pop(block)) {
+            if (readerDone.load() && blockQueue.empty()) break;
+            events.accept();
+            std::this_thread::sleep_for(std::chrono::microseconds(DAEMON_IDLE_SLEEP_US));
+            continue;
+        }
+        if (useAgc) agc.process(block.samples, block.count);
+        if (resample) {
+            int n = resampler.process(block.samples, block.count, resampled, RESAMPLER_MAX_BLOCK + 4);
+            features.push(resampled, n, featureQueue);
+        } else {
+            features.push(block.samples, block.count, featureQueue);
+        }
+        FeatureFrame f;
+        while (featureQueue.pop(f)) consumeFrame(f, block.arrived);
+    }
+    stopRequested.store(true);
+    reader.join();
+
+    char line[32];
+    snprintf(line, sizeof(line), "END %d\n", tracker.current_position);
+    if (!tracker.finished) events.publish(line);
+    events.close();
+
+    float seconds = ((uint32_t)millis() - start) / 1000.0f;
+    float audio = frameCount * FFT_SIZE / liveRate;
+    fprintf(stderr, "Fertig: %u Frames (%.1f s Audio in %.1f s), Endposition %d/%d, Seite %d, Tempo %.2f\n",
+            frameCount, audio, seconds, tracker.current_position, tracker.score->len, tracker.next_page_idx,
+            tracker.tempo);
+    fprintf(stderr, "Latenz: mittel %u us, p50 %u us, p99 %u us, max %u us, %u Frames über einer Frame-Periode\n",
+            frameLatency.mean(), latencyHist.percentile(0.5f), latencyHist.percentile(0.99f), frameLatency.max,
+            lateFrames);
+    fprintf(stderr, "Queues: Blöcke max %u/%u, verworfen %u; Ereignisse verworfen %u\n", blockQueue.getMaxDepth(),
+            blockQueue.capacity(), blockQueue.getDropped(), events.getDropped());
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include <Arduino.h>
+#include <vector>
+#include "WavFile.h"
+#include "FeatureFile.h"
+#include "Settings.h"
+#include "Chroma.h"
+#include "Activity.h"
+#include "FeatureStage.h"
+#include "AGC.h"
+#include "Resampler.h"
+#include "ScoreLibrary.h"         // SCORE_SAMPLE_RATE
+
+// Feature-Export für den Feature-Cache (ODTW_Python/feature_cache.py): schickt eine WAV-Aufnahme durch
+// die DSP-Kette der Firmware (AGC -> [Resampler] -> FeatureStage) und schreibt pro Frame Flags,
+// Lautstärke, SNR, Onset und Chroma in eine Feature-Datei (FeatureFile.h). Kein Tracker.
+//
+//   host_features [--rate HZ] [--resample] [--no-agc] [--quantize] aufnahme.wav ausgabe.sptf
+//   host_features --params [--rate HZ] [--resample] [--no-agc]
+//
+//   --rate HZ    Rate, mit der die Aufnahme tatsächlich entstanden ist (Standard: WAV-Header)
+//   --resample   Per Polyphasen-Filter auf SCORE_SAMPLE_RATE bringen (wie host_replay)
+//   --no-agc     BlockAGC abschalten
+//   --quantize   Chroma als uint8 statt float (1/4 der Größe)
+//   --params     Nur die Parameter-Zeichenkette ausgeben, die in die Datei und den Cache-Schlüssel geht
+//                (Optionen und die wichtigsten Konstanten). Den Rest deckt feature_cache.py ab, indem es
+//                den Hash dieses Programms mit in den Schlüssel nimmt.
+
+static void formatParams(char* out, size_t size, float rateOverride, bool resample, bool useAgc) {
+    snprintf(out, size, "audiodsp/%d fft=%d bins=%d mode=%d agc=%d rs=%d rate=%.3f", FEATURE_DSP_VERSION,
+             FFT_SIZE, NUM_CHROMA, (int)CHROMA_MODE_DEFAULT, useAgc ? 1 : 0, resample ? 1 : 0, rateOverride);
+}
+
+int main(int argc, char** argv) {
+    float rateOverride = 0.0f;
+    bool resample = false;
+    bool useAgc = true;
+    bool quantize = false;
+    bool paramsOnly = false;
+    const char* inPath = nullptr;
+    const char* outPath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--rate") && i + 1 < argc) rateOverride = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "--resample")) resample = true;
+        else if (!strcmp(argv[i], "--no-agc")) useAgc = false;
+        else if (!strcmp(argv[i], "--quantize")) quantize = true;
+        else if (!strcmp(argv[i], "--params")) paramsOnly = true;
+        else if (argv[i][0] != '-' && !inPath) inPath = argv[i];
+        else if (argv[i][0] != '-' && !outPath) outPath = argv[i];
+        else {
+            inPath = nullptr;
+            break;
+        }
+    }
+
+    char params[64];
+    formatParams(params, sizeof(params), rateOverride, resample, useAgc);
+    if (paramsOnly) {
+        printf("%s\n", params);
+        return 0;
+    }
+    if (!inPath || !outPath) {
+        fprintf(stderr, "Aufruf: %s [--rate HZ] [--resample] [--no-agc] [--quantize] aufnahme.wav ausgabe.sptf\n"
+                        "       %s --params [--rate HZ] [--resample] [--no-agc]\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    std::vector<int16_t> samples;
+    float sourceRate;
+    if (!readWav(inPath, samples, sourceRate)) {
+        fprintf(stderr, "FEHLER: %s nicht lesbar oder kein PCM16\n", inPath);
+        return 1;
+    }
+    if (rateOverride > 0.0f) sourceRate = rateOverride;
+    float liveRate = resample ? SCORE_SAMPLE_RATE : sourceRate;
+
+    Serial.quiet = true;
+    BlockAGC agc;
+    PolyphaseResampler resampler;
+    FeatureStage features;
+    FeatureQueue queue;
+    FeatureFrame f;
+    agc.init(sourceRate);
+    if (resample) resampler.init(sourceRate, SCORE_SAMPLE_RATE);
+    features.init(liveRate);
+
+    FeatureFileWriter out;
+    out.numChroma = NUM_CHROMA;
+    out.flags.reserve(samples.size() / FFT_SIZE + 1);
+
+    // In Blöcken wie AudioRecordQueue einspeisen
+    int16_t resampled[RESAMPLER_MAX_BLOCK + 4];
+    for (size_t pos = 0; pos < samples.size(); pos += AGC_BLOCK_SIZE) {
+        int count = (int)std::min<size_t>(AGC_BLOCK_SIZE, samples.size() - pos);
+        if (useAgc) agc.process(&samples[pos], count);
+        if (resample) {
+            int n = resampler.process(&samples[pos], count, resampled, RESAMPLER_MAX_BLOCK + 4);
+            features.push(resampled, n, queue);
+        } else {
+            features.push(&samples[pos], count, queue);
+        }
+        while (queue.pop(f)) {
+            out.add(f.flags, f.volume, f.snr, f.onset, (f.flags & FEATURE_ACTIVE) ? f.chroma : nullptr);
+        }
+    }
+
+    if (!out.write(outPath, liveRate, FFT_SIZE, params, quantize)) {
+        fprintf(stderr, "FEHLER: %s nicht schreibbar\n", outPath);
+        return 1;
+    }
+    printf("%s: %zu Frames, %s\n", outPath, out.flags.size(), params);
+    return 0;
+}
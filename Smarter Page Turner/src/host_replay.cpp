@@ -0,0 +1,437 @@
+#include <Arduino.h>
+#include <vector>
+#include "WavFile.h"
+#include "Settings.h"
+#include "Chroma.h"
+#include "Activity.h"
+#include "FeatureStage.h"
+#include "Resampler.h"
+#include "AGC.h"
+#include "Scheduler.h"
+#include "Storage.h"
+#include "Capture.h"
+#include "Power.h"
+#include "SpscQueue.h"
+#include "DTW.h"
+#include "TrackStage.h"
+#include "Recorder.h"
+#include "ScoreData.h"
+
+// Host-Replay: spielt eine WAV-Aufnahme (PCM16, mono/stereo) durch dieselbe Kette wie
+// odtw_turner.cpp (Aktivität -> DSP | featureQueue | CENS -> DTW). Seitenwechsel erscheinen als
+// "[Serial1] UUU...n" (Weck-Präambel + Befehl).
+//
+//   host_replay aufnahme.wav|CAPxxxxx.SPT [--rate HZ] [--resample] [--no-agc] [--set name=wert] [--seek frame]
+//                            [--checkpoint-at frame] [--dump-out datei.bin] [--capture raw|features] [--quiet]
+//   host_replay --dump mitschnitt.bin [--quiet]
+//
+//   --rate HZ    Rate, mit der die Aufnahme tatsächlich entstanden ist (Standard: WAV-Header).
+//                Teensy-Mitschnitte: 44117.647
+//   --resample   Aufnahme per Polyphasen-Filter auf SCORE_SAMPLE_RATE bringen
+//                (wie RESAMPLE_TO_SCORE_RATE in der Firmware)
+//   --no-agc     BlockAGC abschalten (wie USE_AGC 0 in der Firmware)
+//   --set N=W    Tracker-Parameter setzen wie "set N W" in der Serial-Shell (mehrfach möglich)
+//   --seek F     Ab Partitur-Frame F starten
+//   --checkpoint-at N  Nach Live-Frame N Checkpoint in das (emulierte) EEPROM schreiben, Tracker neu
+//                initialisieren und daraus fortsetzen -> simuliert einen Reset mitten im Stück
+//   Statt WAV geht auch ein SD-Mitschnitt ("capture" in der Firmware): Rohaudio läuft wie eine WAV-Datei
+//   durch die ganze Kette, Feature-Mitschnitte überspringen FFT/Chroma und starten bei Aktivität/CENS.
+//   --capture T  Selbst einen Mitschnitt schreiben (raw oder features, CAPxxxxx.SPT im aktuellen Verzeichnis)
+//   --dump-out D Flight-Recorder am Ende nach D schreiben (gleiches Format wie "dump" auf dem Teensy)
+//   --dump D     Flight-Recorder-Dump (Teensy-Mitschrift oder --dump-out) ab dem ersten Keyframe durch
+//                den Tracker schicken und jede Position mit der aufgezeichneten vergleichen
+//   --quiet      Nur Seitenwechsel und Zusammenfassung ausgeben
+
+FeatureStage features;
+FeatureQueue featureQueue;
+DTWTracker tracker;
+TrackStage trackStage;
+FrameScheduler scheduler;
+PolyphaseResampler resampler;
+BlockAGC agc;
+
+int frameCount = 0;
+float liveRate = 0.0f;
+bool quiet = false;
+int checkpointAt = -1;
+SlotRing checkpoints;
+RecorderRings recorderRings;
+FlightRecorder recorder(recorderRings);
+CaptureBuffers captureBuffers;
+CaptureWriter capture(captureBuffers);
+PowerManager power;
+bool featureInput = false;      // Eingabe ist ein Feature-Mitschnitt (ersetzt die DSP-Stufe)
+int featureMismatches = 0;      // Feature-Mitschnitt: Aktivitätserkennung anders entschieden als live
+QueueLatency featureLatency;
+
+// SD-Mitschnitt (CaptureWriter) lesen: Kopf aus dem ersten Block, Nutzdaten ab CAPTURE_BLOCK
+static bool readCapture(const char* path, CaptureHeader& header, std::vector<uint8_t>& data) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    bool ok = fread(&header, sizeof(header), 1, f) == 1 && header.magic == CAPTURE_MAGIC &&
+              header.version == CAPTURE_VERSION && fseek(f, CAPTURE_BLOCK, SEEK_SET) == 0;
+    if (ok) {
+        data.resize(header.data_bytes);
+        ok = fread(data.data(), 1, data.size(), f) == data.size();
+    }
+    fclose(f);
+    return ok;
+}
+
+// Taktregelung wie in der Firmware durchspielen. Der Host läuft immer mit voller Geschwindigkeit;
+// seine Frame-Zeit gilt als Zeit bei POWER_CLOCK_MAX_MHZ und wird auf den simulierten Takt hochgerechnet.
+void simulatePower() {
+    float scale = (float)POWER_CLOCK_MAX_MHZ / power.getClockMHz();
+    uint32_t period = (uint32_t)(FFT_SIZE / liveRate * 1e6f);
+    uint32_t busy = (uint32_t)(scheduler.getLastMicros() * scale);
+    if (busy > period) busy = period;
+    power.account(busy, period - busy);
+    bool tracking = tracker.running && !tracker.finished && features.activity.isActive();
+    power.update(scheduler.getFrameLoad() * scale, tracking);
+}
+
+// Checkpoint sichern, Tracker wie nach dem Einschalten neu aufsetzen und wiederherstellen
+void simulateReset() {
+    TrackerCheckpoint cp;
+    tracker.saveCheckpoint(cp);
+    checkpoints.save(&cp);
+    int before = tracker.current_position;
+
+    tracker.init();
+    tracker.setFrameClock(liveRate, FFT_SIZE);
+    bool ok = checkpoints.loadLatest(&cp) && tracker.restoreCheckpoint(cp);
+    printf("Checkpoint nach Frame %d: Pos %d -> %d, Seite %d, Tempo %.2f%s\n", frameCount, before,
+           tracker.current_position, tracker.next_page_idx, tracker.tempo, ok ? "" : " (FEHLER)");
+}
+
+// Verbraucher: ein Frame aus der featureQueue durch die TrackStage, wie consumeFrame() in der Firmware
+void consumeFrame(FeatureFrame& f) {
+    featureLatency.add(micros() - f.produced);
+    // Zeitstempel aus der Sample-Position statt millis() -> reproduzierbar
+    float timestamp = (float)frameCount * FFT_SIZE / liveRate;
+    frameCount++;
+
+    recorder.beginFrame(tracker);
+    RecorderFrame& rec = recorder.current(tracker);
+    rec.millis = (uint32_t)(timestamp * 1000.0f);
+    int pageBefore = tracker.next_page_idx;
+
+    scheduler.beginFrame();
+    scheduler.addWork(f.dspMicros);
+    rec.volume = f.volume;
+
+    if (!featureInput) {
+        if (f.flags & FEATURE_ACTIVE) capture.writeFrame(f.volume, f.flatness, f.snr, f.onset, f.chroma);
+        else capture.writeFrame(f.volume, 0.0f, 0.0f, 0.0f, nullptr);
+    }
+    TrackAction action = trackStage.consume(f);
+    bool tracked = action != TRACK_REST;
+    if (f.flags & FEATURE_ACTIVE) {
+        memcpy(rec.chroma, f.chroma, sizeof(rec.chroma));
+        rec.flags |= REC_ACTIVE;
+    }
+    if (action == TRACK_UPDATE) FlightRecorder::noteUpdate(rec, trackStage.input, trackStage.snr, trackStage.onset, trackStage.advance);
+    if (!tracked) rec.flags |= REC_REST;
+    scheduler.endFrame();
+    recorder.endFrame(tracker, rec, pageBefore);
+    trackStage.applyDegradation(scheduler.getLevel(), features);
+    simulatePower();
+    if (frameCount == checkpointAt) simulateReset();
+
+    if (tracker.running && !quiet) {
+        Serial.print("[");
+        Serial.print(timestamp, 3);
+        Serial.print("s] Pos: ");
+        Serial.print(tracker.current_position);
+        Serial.print(" (");
+        Serial.print(tracker.frameToSeconds(tracker.current_position), 2);
+        Serial.print("s)");
+        if (!tracked) {
+            Serial.println(" | Pause");
+        } else {
+            Serial.print(" | Tuning: ");
+            Serial.print(features.dsp.getTuningCents(), 1);
+            Serial.print(" ct | Gain: ");
+            Serial.print(agc.getGainDb(), 1);
+            Serial.println(" dB");
+        }
+    }
+}
+
+// Feature-Mitschnitt statt DSP-Stufe: aufgezeichnete Werte ersetzen FFT und Chroma, die
+// Aktivitätserkennung entscheidet wie live (Abweichungen werden gezählt)
+void produceFromCapture(const CaptureFrame& cf, const float* chroma) {
+    FeatureFrame f = {};
+    f.seq = frameCount;
+    f.volume = cf.volume;
+    if (features.activity.gate(f.volume)) {
+        if (!(cf.flags & CAPTURE_FRAME_DSP)) featureMismatches++;
+        memcpy(f.chroma, chroma, sizeof(f.chroma));
+        f.flatness = cf.flatness;
+        f.snr = cf.snr;
+        f.onset = cf.onset;
+        f.flags = FEATURE_ACTIVE;
+        if (features.activity.confirm(f.flatness)) f.flags |= FEATURE_TRACK;
+    } else if (cf.flags & CAPTURE_FRAME_DSP) {
+        featureMismatches++;
+    }
+    f.produced = micros();
+    featureQueue.push(f);
+}
+
+// Alles Fertige aus der Queue holen (Host: Erzeuger und Verbraucher laufen abwechselnd im selben Thread)
+void drainFeatures() {
+    FeatureFrame f;
+    while (featureQueue.pop(f)) consumeFrame(f);
+}
+
+// --- FLIGHT-RECORDER ---
+struct FileOut {
+    FILE* f;
+    size_t write(const uint8_t* data, size_t len) { return fwrite(data, 1, len, f); }
+};
+
+// Dump ab dem ersten Keyframe nachrechnen. Die Datei darf eine ganze Serial-Mitschrift sein,
+// gesucht wird der erste passende Kopf.
+static int replayDump(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "FEHLER: %s nicht lesbar\n", path);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + n);
+    fclose(f);
+
+    RecorderHeader h;
+    size_t pos = 0;
+    bool found = false;
+    for (; pos + sizeof(h) <= data.size(); pos++) {
+        memcpy(&h, &data[pos], sizeof(h));
+        if (h.magic == RECORDER_MAGIC && h.version == RECORDER_VERSION) {
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        fprintf(stderr, "FEHLER: kein Flight-Recorder-Dump in %s\n", path);
+        return 1;
+    }
+    if (h.num_chroma != NUM_CHROMA || h.keyframe_cells != KEYFRAME_CELLS || h.beat_sync != SCORE_BEAT_SYNC) {
+        fprintf(stderr, "FEHLER: Dump passt nicht zu diesem Build (NUM_CHROMA %d, Keyframe %d, Beat-Sync %d)\n",
+                h.num_chroma, h.keyframe_cells, h.beat_sync);
+        return 1;
+    }
+    size_t need = sizeof(h) + h.keyframe_count * sizeof(TrackerKeyframe) + h.frame_count * sizeof(RecorderFrame);
+    if (h.keyframe_count == 0 || pos + need > data.size()) {
+        fprintf(stderr, "FEHLER: Dump unvollständig (%zu von %zu Bytes)\n", data.size() - pos, need);
+        return 1;
+    }
+
+    std::vector<TrackerKeyframe> keys(h.keyframe_count);
+    std::vector<RecorderFrame> frames(h.frame_count);
+    const uint8_t* p = &data[pos + sizeof(h)];
+    memcpy(keys.data(), p, keys.size() * sizeof(TrackerKeyframe));
+    memcpy(frames.data(), p + keys.size() * sizeof(TrackerKeyframe), frames.size() * sizeof(RecorderFrame));
+
+    tracker.setConfig(h.cfg);
+    tracker.init();
+    tracker.frames_per_update = h.frames_per_update;
+    if (!tracker.restoreKeyframe(keys[0])) {
+        fprintf(stderr, "FEHLER: Keyframe passt nicht zur Partitur %d\n", h.score_index);
+        return 1;
+    }
+    printf("Dump: %d Frames ab Frame %u, %d Keyframes, Partitur %s, Position %d\n", h.frame_count,
+           keys[0].frame, h.keyframe_count, tracker.score->name, tracker.current_position);
+
+    int mismatches = 0;
+    for (const RecorderFrame& fr : frames) {
+        tracker.radius = fr.radius;
+        int pageBefore = tracker.next_page_idx;
+        if (fr.flags & REC_UPDATE) tracker.update((float*)fr.chroma, fr.snr, fr.onset, fr.advance);
+        else if (fr.flags & REC_REST) tracker.rest();
+
+        bool same = tracker.current_position == fr.position && tracker.next_page_idx == fr.page;
+        if (!same) mismatches++;
+        bool turned = tracker.next_page_idx != pageBefore;
+        if (!quiet || turned || !same) {
+            printf("%6u [%8.3fs] Pos %5d (Replay %5d) Seite %d | Kosten %.3f | Konf %.2f | Vol %.4f%s%s%s\n",
+                   fr.frame, fr.millis / 1000.0f, fr.position, tracker.current_position, fr.page, fr.cost,
+                   fr.confidence, fr.volume, (fr.flags & REC_REST) ? " | Pause" : "",
+                   turned ? " | BLÄTTERN" : "", same ? "" : " | ABWEICHUNG");
+        }
+    }
+    printf("Replay: %d Frames, %d Abweichungen\n", h.frame_count, mismatches);
+    return mismatches ? 2 : 0;
+}
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    float rateOverride = 0.0f;
+    bool resample = false;
+    bool useAgc = true;
+    int seekFrame = -1;
+    const char* dumpIn = nullptr;
+    const char* dumpOut = nullptr;
+    CaptureType captureType = CAPTURE_OFF;
+    TrackerConfig config = defaultTrackerConfig();
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--rate") && i + 1 < argc) rateOverride = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "--resample")) resample = true;
+        else if (!strcmp(argv[i], "--no-agc")) useAgc = false;
+        else if (!strcmp(argv[i], "--seek") && i + 1 < argc) seekFrame = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--checkpoint-at") && i + 1 < argc) checkpointAt = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--dump") && i + 1 < argc) dumpIn = argv[++i];
+        else if (!strcmp(argv[i], "--dump-out") && i + 1 < argc) dumpOut = argv[++i];
+        else if (!strcmp(argv[i], "--capture") && i + 1 < argc) {
+            i++;
+            if (!strcmp(argv[i], "raw")) captureType = CAPTURE_RAW;
+            else if (!strcmp(argv[i], "features")) captureType = CAPTURE_FEATURES;
+            else {
+                fprintf(stderr, "FEHLER: --capture raw|features\n");
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--set") && i + 1 < argc) {
+            char* arg = argv[++i];
+            char* eq = strchr(arg, '=');
+            const ConfigParam* p = nullptr;
+            if (eq) {
+                *eq = '\0';
+                p = findConfigParam(arg);
+            }
+            if (!p || !configSet(config, *p, atof(eq + 1))) {
+                fprintf(stderr, "FEHLER: --set %s ungültig\n", arg);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--quiet")) quiet = true;
+        else path = argv[i];
+    }
+    if (dumpIn) return replayDump(dumpIn);
+    if (!path) {
+        fprintf(stderr, "Aufruf: %s aufnahme.wav|CAPxxxxx.SPT [--rate HZ] [--resample] [--no-agc] [--set name=wert] [--seek frame] [--checkpoint-at frame] [--dump-out datei] [--capture raw|features] [--quiet]\n"
+                        "        %s --dump mitschnitt.bin [--quiet]\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    std::vector<int16_t> samples;
+    float fileRate = 0.0f;
+    CaptureHeader capHeader;
+    std::vector<uint8_t> capData;
+    if (readCapture(path, capHeader, capData)) {
+        fileRate = capHeader.sample_rate;
+        if (capHeader.type == CAPTURE_RAW) {
+            samples.resize(capData.size() / 2);
+            memcpy(samples.data(), capData.data(), samples.size() * 2);
+        } else if (capHeader.type == CAPTURE_FEATURES && capHeader.num_chroma == NUM_CHROMA &&
+                   capHeader.frame_samples == FFT_SIZE) {
+            featureInput = true;
+            resample = false;   // Features liegen schon im Raster des DSP
+        } else {
+            fprintf(stderr, "FEHLER: %s passt nicht zu diesem Build (%d Bins, %u Samples pro Frame)\n",
+                    path, capHeader.num_chroma, capHeader.frame_samples);
+            return 1;
+        }
+        if (capHeader.dropped_bytes) {
+            fprintf(stderr, "WARNUNG: im Mitschnitt fehlen %u Bytes (SD zu langsam)\n", capHeader.dropped_bytes);
+        }
+    } else if (!readWav(path, samples, fileRate)) {
+        fprintf(stderr, "FEHLER: %s ist weder PCM16-WAV noch SD-Mitschnitt\n", path);
+        return 1;
+    }
+    float sourceRate = rateOverride > 0.0f ? rateOverride : fileRate;
+    liveRate = resample ? SCORE_SAMPLE_RATE : sourceRate;
+
+    if (resample) resampler.init(sourceRate, SCORE_SAMPLE_RATE);
+    agc.init(sourceRate);
+    features.init(liveRate);
+    tracker.setConfig(config);
+    tracker.init();
+    if (seekFrame >= 0) tracker.seek(seekFrame);
+    tracker.setFrameClock(liveRate, FFT_SIZE);
+    trackStage.init(tracker);
+    scheduler.init(FFT_SIZE / liveRate);
+    power.init();
+    TrackerCheckpoint cp;
+    checkpoints.init(STORAGE_CHECKPOINT_ADDR, STORAGE_CHECKPOINT_SLOTS, STORAGE_CHECKPOINT_MAGIC, sizeof(cp));
+
+    if (captureType != CAPTURE_OFF) {
+        float rate = (captureType == CAPTURE_RAW) ? sourceRate : liveRate;
+        if (!capture.start(captureType, rate, FFT_SIZE, NUM_CHROMA)) {
+            fprintf(stderr, "FEHLER: Mitschnitt nicht anlegbar\n");
+            return 1;
+        }
+    }
+
+    if (featureInput) {
+        printf("Replay: %s, %zu Feature-Frames @ %.3f Hz\n", path, capData.size() / capHeader.record_bytes, sourceRate);
+    } else {
+        printf("Replay: %s, %zu Samples @ %.3f Hz%s\n", path, samples.size(), sourceRate,
+               resample ? " (resampled)" : "");
+    }
+    if (SCORE_BEAT_SYNC) {
+        printf("Partitur: %d Schläge, %.2f Live-Frames pro Schlag\n", tracker.score->len, tracker.live_frames_per_beat);
+    } else {
+        printf("Partitur: %d Frames, %.2f Frames pro Live-Frame\n", tracker.score->len, tracker.frames_per_update);
+    }
+
+    // Feature-Mitschnitt: ein Datensatz pro Frame
+    for (size_t pos = 0; featureInput && pos + capHeader.record_bytes <= capData.size(); pos += capHeader.record_bytes) {
+        CaptureFrame frame;
+        memcpy(&frame, &capData[pos], sizeof(frame));
+        float chroma[NUM_CHROMA];
+        memcpy(chroma, &capData[pos + sizeof(frame)], sizeof(chroma));
+        produceFromCapture(frame, chroma);
+        drainFeatures();
+    }
+
+    // In Blöcken wie AudioRecordQueue einspeisen
+    int16_t resampled[RESAMPLER_MAX_BLOCK + 4];
+    for (size_t pos = 0; pos < samples.size(); pos += AGC_BLOCK_SIZE) {
+        int count = (int)std::min<size_t>(AGC_BLOCK_SIZE, samples.size() - pos);
+        capture.writeSamples(&samples[pos], count);
+        capture.service();
+        if (useAgc) agc.process(&samples[pos], count);
+        if (resample) {
+            int n = resampler.process(&samples[pos], count, resampled, RESAMPLER_MAX_BLOCK + 4);
+            features.push(resampled, n, featureQueue);
+        } else {
+            features.push(&samples[pos], count, featureQueue);
+        }
+        drainFeatures();
+    }
+
+    printf("Fertig: %d Frames, Endposition %d/%d, Seite %d, Tuning %.1f ct, Tempo %.2f\n",
+           frameCount, tracker.current_position, tracker.score->len, tracker.next_page_idx,
+           features.dsp.getTuningCents(), tracker.tempo);
+    if (featureMismatches) printf("WARNUNG: Aktivitätserkennung wich in %d Frames vom Mitschnitt ab\n", featureMismatches);
+    if (capture.isActive()) {
+        capture.stop();
+        printf("Mitschnitt: %s, %u Bytes, verworfen %u\n", capture.getFileName(), capture.getBytes(), capture.getDropped());
+    }
+    if (dumpOut) {
+        FileOut out = {fopen(dumpOut, "wb")};
+        if (!out.f) {
+            fprintf(stderr, "FEHLER: %s nicht schreibbar\n", dumpOut);
+            return 1;
+        }
+        size_t bytes = recorder.dump(out, tracker);
+        fclose(out.f);
+        printf("Flight-Recorder: %zu Bytes nach %s\n", bytes, dumpOut);
+    }
+    printf("Power (simuliert): wach %.1f%%, ~%.0f mW, Taktwechsel %u, Anteile %d/%d/%d MHz: %.0f/%.0f/%.0f%%\n",
+           power.getDutyCycle() * 100.0f, power.getPowerMw(), power.getClockChanges(),
+           POWER_CLOCK_WAIT_MHZ, POWER_CLOCK_TRACKING_MHZ, POWER_CLOCK_MAX_MHZ, power.getClockShare(0) * 100.0f,
+           power.getClockShare(1) * 100.0f, power.getClockShare(2) * 100.0f);
+    printf("Scheduler: max %u us, Last %.0f%%, Überläufe %u, verpasst %u, Frames pro Stufe %u/%u/%u/%u\n",
+           scheduler.getMaxMicros(), scheduler.getLoad() * 100.0f, scheduler.getOverruns(),
+           scheduler.getMissedDeadlines(), scheduler.getFramesAtLevel(0), scheduler.getFramesAtLevel(1),
+           scheduler.getFramesAtLevel(2), scheduler.getFramesAtLevel(3));
+    printf("Pipeline: Queue max %u/%u, verworfen %u, Wartezeit %u us (max %u us)\n", featureQueue.getMaxDepth(),
+           featureQueue.capacity(), featureQueue.getDropped(), featureLatency.mean(), featureLatency.max);
+    return 0;
+}
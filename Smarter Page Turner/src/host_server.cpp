@@ -0,0 +1,468 @@
+#include <Arduino.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include "WavFile.h"
+#include "Settings.h"
+#include "Chroma.h"
+#include "Activity.h"
+#include "FeatureStage.h"
+#include "AGC.h"
+#include "SpscQueue.h"
+#include "DTW.h"
+#include "TrackStage.h"
+#include "ScoreData.h"
+#include "ScoreStore.h"
+
+// Host-Server: viele unabhängige Tracker-Sitzungen (z.B. ein Probenraum-Rechner für ein ganzes
+// Ensemble, oder Regressionstests über viele Aufnahmen) auf einem festen Pool von Worker-Threads.
+// Misst Durchsatz (Frames/s pro Kern) und Latenz (p50/p99/max), während die Zahl der Sitzungen wächst.
+//
+//   host_server [--sessions 1,4,16,64] [--threads N] [--batch N] [--no-pin] [--realtime]
+//               [--set name=wert] [--store DIR] aufnahme.wav [weitere.wav ...]
+//
+//   --sessions L Liste der Sitzungszahlen, jede wird einmal komplett durchgespielt (Standard 1,4,16,64)
+//   --threads N  Worker-Threads (Standard: Zahl der Kerne)
+//   --batch N    Höchstens N Sitzungen derselben Partitur pro Aufgabe (Standard SERVER_MAX_BATCH)
+//   --no-pin     Worker nicht an Kerne binden
+//   --realtime   Frames im Takt der Samplerate freigeben (Latenz unter Last), sonst so schnell wie möglich
+//   --set N=W    Tracker-Parameter für alle Sitzungen (wie host_replay)
+//   --store DIR  Partituren aus einem Partitur-Speicher (ScoreStore.h) statt der score_library
+//   Sitzung i spielt Aufnahme i % Anzahl gegen Partitur i % Zahl der Partituren.
+//
+// Ablauf: alle Sitzungen laufen im Gleichschritt. Pro Takt wird jede aktive Sitzung um einen Frame
+// (FFT_SIZE Samples) weitergeschoben; wie im Live-Betrieb kommt bei allen Aufführungen etwa gleichzeitig
+// ein Frame an. Die Sitzungen sind nach Partitur sortiert und in zusammenhängenden Bereichen auf die
+// Worker verteilt (Heimat-Worker, an einen Kern gebunden): die Zustände einer Sitzung und die Partitur
+// bleiben im Cache desselben Kerns. Sitzungen derselben Partitur und desselben Workers bilden Batches;
+// ein Batch rechnet erst die DSP aller Sitzungen und dann ihre DTW-Schritte direkt hintereinander,
+// nach Position sortiert, damit sich die Suchfenster in der Partitur überlappen.
+// Jeder Worker hat eine eigene Deque: hinten nimmt er sich selbst die zuletzt eingereihten Batches, ist
+// sie leer, stiehlt er vorne bei den anderen (Work-Stealing gleicht ungleich teure Sitzungen aus,
+// z.B. Pausen ohne FFT gegen dichte Passagen).
+// Latenz eines Frames = Freigabe des Takts bis zur Entscheidung seines Trackers.
+// Ohne FrameScheduler: alle Sitzungen rechnen mit voller Auflösung, damit die Zahlen vergleichbar sind.
+
+#define SERVER_BLOCK_SAMPLES 128     // Wie AudioRecordQueue
+#define SERVER_MAX_BATCH 8           // Sitzungen pro Aufgabe
+#define SERVER_MAX_THREADS 64
+
+struct Recording {
+    const char* path;
+    std::vector<int16_t> samples;
+    float rate = 0.0f;
+};
+
+// --- SITZUNG ---
+// Eine Aufführung mit eigener DSP-Kette und eigenem Tracker; die Aufnahme wird nur gelesen (geteilt)
+struct Session {
+    int id = 0;
+    int home = 0;                // Heimat-Worker
+    int scoreIndex = 0;
+    const Recording* rec = nullptr;
+    size_t pos = 0;
+    bool done = false;
+    uint32_t frames = 0;
+
+    BlockAGC agc;
+    FeatureStage features;
+    FeatureQueue queue;
+    DTWTracker tracker;
+    TrackStage stage;
+    FeatureFrame frame;
+
+    // view: Partitur aus dem ScoreStore, nullptr = score_library[score]
+    void init(const Recording* r, int score, const ScoreView* view, const TrackerConfig& config) {
+        rec = r;
+        scoreIndex = score;
+        pos = 0;
+        done = false;
+        frames = 0;
+        agc.init(rec->rate);
+        features.init(rec->rate);
+        queue.clear();
+        TrackerConfig c = config;
+        c.score_index = scoreIndex;
+        tracker.setConfig(c);
+        if (view) tracker.setScore(view);
+        else tracker.init();
+        tracker.setFrameClock(rec->rate, FFT_SIZE);
+        stage.init(tracker);
+    }
+
+    // DSP-Stufe: Blöcke durch AGC und FeatureStage schieben, bis ein Frame fertig ist.
+    // false = Aufnahme zu Ende
+    bool produce() {
+        int16_t block[SERVER_BLOCK_SAMPLES];
+        while (pos < rec->samples.size()) {
+            int n = (int)std::min<size_t>(SERVER_BLOCK_SAMPLES, rec->samples.size() - pos);
+            memcpy(block, &rec->samples[pos], n * sizeof(int16_t));
+            pos += n;
+            agc.process(block, n);
+            if (features.push(block, n, queue) > 0) return queue.pop(frame);
+        }
+        done = true;
+        return false;
+    }
+
+    // Tracker-Stufe (TrackStage wie in Firmware und host_daemon, ohne Degradation)
+    void track() {
+        frames++;
+        stage.consume(frame);
+        if (tracker.finished) done = true;
+    }
+};
+
+// Aufgabe für einen Worker: Sitzungen mit gleicher Partitur und gleichem Heimat-Worker
+struct Batch {
+    int home = 0;
+    int count = 0;
+    uint64_t generation = 0;           // Takt, in dem der Batch eingereiht wurde
+    Session* sessions[SERVER_MAX_BATCH];
+};
+
+// --- WORKER-POOL ---
+class WorkerPool {
+public:
+    struct Worker {
+        std::mutex lock;
+        std::deque<Batch*> tasks;
+        std::thread thread;
+        int core = -1;                 // -1 = nicht gebunden
+        LatencyHistogram latency;
+        uint32_t maxLatency = 0;
+        uint32_t lateFrames = 0;
+        uint64_t frames = 0;
+        uint64_t batches = 0;
+        uint64_t stolen = 0;
+        uint64_t busyMicros = 0;
+
+        void resetStats() {
+            latency = LatencyHistogram();
+            maxLatency = 0;
+            lateFrames = 0;
+            frames = batches = stolen = busyMicros = 0;
+        }
+    };
+
+    // threads Worker starten; pin = jeder an Kern (i % Kerne)
+    void start(int threads, bool pin, uint32_t framePeriodMicros) {
+        period = framePeriodMicros;
+        int cores = (int)std::thread::hardware_concurrency();
+        if (cores < 1) cores = 1;
+        for (int i = 0; i < threads; i++) workers.emplace_back(new Worker());
+        for (int i = 0; i < threads; i++) {
+            Worker& w = *workers[i];
+            w.thread = std::thread(&WorkerPool::workerLoop, this, i);
+            if (pin) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(i % cores, &set);
+                if (pthread_setaffinity_np(w.thread.native_handle(), sizeof(set), &set) == 0) w.core = i % cores;
+            }
+        }
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> l(wakeLock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& w : workers) w->thread.join();
+        workers.clear();
+    }
+
+    // Einen Takt ausführen: Batches bei ihren Heimat-Workern einreihen, warten bis alle fertig sind.
+    // release = micros() der Freigabe (Bezug für die Latenz)
+    void run(std::vector<Batch>& batches, uint32_t release) {
+        if (batches.empty()) return;
+        releaseMicros = release;
+        // pending steht, bevor ein Batch sichtbar ist, und alles geschieht unter wakeLock: ein Worker,
+        // der vom letzten Takt noch in take() hängt, findet entweder nichts oder nur Batches eines Takts,
+        // den er noch nicht gesehen hat, und lässt sie liegen
+        std::unique_lock<std::mutex> l(wakeLock);
+        pending.store((int)batches.size());
+        generation++;
+        for (Batch& b : batches) {
+            Worker& w = *workers[b.home];
+            b.generation = generation;
+            std::lock_guard<std::mutex> tl(w.lock);
+            w.tasks.push_back(&b);
+        }
+        wake.notify_all();
+        done.wait(l, [&] { return pending.load() == 0; });
+    }
+
+    int size() const { return (int)workers.size(); }
+    Worker& worker(int i) { return *workers[i]; }
+
+private:
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::mutex wakeLock;
+    std::condition_variable wake;
+    std::condition_variable done;
+    uint64_t generation = 0;
+    bool stopping = false;
+    std::atomic<int> pending{0};
+    uint32_t releaseMicros = 0;
+    uint32_t period = 0;
+
+    // Eigene Deque von hinten (zuletzt eingereiht, noch im Cache), sonst bei den Nachbarn von vorne stehlen.
+    // Nur Batches des Takts seen: die Deques enthalten nie mehr als einen Takt.
+    Batch* take(int index, uint64_t seen) {
+        Worker& self = *workers[index];
+        {
+            std::lock_guard<std::mutex> l(self.lock);
+            if (!self.tasks.empty() && self.tasks.back()->generation == seen) {
+                Batch* b = self.tasks.back();
+                self.tasks.pop_back();
+                return b;
+            }
+        }
+        int n = (int)workers.size();
+        for (int k = 1; k < n; k++) {
+            Worker& victim = *workers[(index + k) % n];
+            std::lock_guard<std::mutex> l(victim.lock);
+            if (!victim.tasks.empty() && victim.tasks.front()->generation == seen) {
+                Batch* b = victim.tasks.front();
+                victim.tasks.pop_front();
+                self.stolen++;
+                return b;
+            }
+        }
+        return nullptr;
+    }
+
+    void execute(Batch& b, Worker& w) {
+        uint32_t start = (uint32_t)micros();
+        // Erst die DSP aller Sitzungen, dann die DTW-Schritte am Stück: die Partitur bleibt im Cache
+        Session* ready[SERVER_MAX_BATCH];
+        int count = 0;
+        for (int i = 0; i < b.count; i++) {
+            Session* s = b.sessions[i];
+            if (!s->done && s->produce()) ready[count++] = s;
+        }
+        // Nach Position sortieren (Einfügen, höchstens SERVER_MAX_BATCH Einträge)
+        for (int i = 1; i < count; i++) {
+            Session* s = ready[i];
+            int j = i;
+            for (; j > 0 && ready[j - 1]->tracker.current_position > s->tracker.current_position; j--) ready[j] = ready[j - 1];
+            ready[j] = s;
+        }
+        for (int i = 0; i < count; i++) {
+            ready[i]->track();
+            uint32_t latency = (uint32_t)micros() - releaseMicros;
+            w.latency.add(latency);
+            if (latency > w.maxLatency) w.maxLatency = latency;
+            if (latency > period) w.lateFrames++;
+        }
+        w.frames += count;
+        w.batches++;
+        w.busyMicros += (uint32_t)micros() - start;
+    }
+
+    void workerLoop(int index) {
+        Worker& w = *workers[index];
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> l(wakeLock);
+                wake.wait(l, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            while (Batch* b = take(index, seen)) {
+                execute(*b, w);
+                if (pending.fetch_sub(1) == 1) {
+                    std::lock_guard<std::mutex> l(wakeLock);
+                    done.notify_one();
+                }
+            }
+        }
+    }
+};
+
+// Sitzungen nach Partitur sortiert in zusammenhängenden Bereichen auf die Worker verteilen
+// und in Batches gleicher Partitur schneiden
+void planBatches(std::vector<Session*>& sessions, int threads, int maxBatch, std::vector<Batch>& batches) {
+    std::stable_sort(sessions.begin(), sessions.end(),
+                     [](const Session* a, const Session* b) { return a->scoreIndex < b->scoreIndex; });
+    int n = (int)sessions.size();
+    for (int i = 0; i < n; i++) sessions[i]->home = (int)((int64_t)i * threads / n);
+
+    batches.clear();
+    for (int i = 0; i < n; i++) {
+        Session* s = sessions[i];
+        if (batches.empty() || batches.back().home != s->home || batches.back().count >= maxBatch ||
+            batches.back().sessions[0]->scoreIndex != s->scoreIndex) {
+            batches.emplace_back();
+            batches.back().home = s->home;
+        }
+        Batch& b = batches.back();
+        b.sessions[b.count++] = s;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<int> sessionCounts = {1, 4, 16, 64};
+    int threads = (int)std::thread::hardware_concurrency();
+    int maxBatch = SERVER_MAX_BATCH;
+    bool pin = true;
+    bool realtime = false;
+    TrackerConfig config = defaultTrackerConfig();
+    std::vector<Recording> recordings;
+    ScoreStore store;
+    const char* storeDir = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--sessions") && i + 1 < argc) {
+            sessionCounts.clear();
+            for (char* tok = strtok(argv[++i], ","); tok; tok = strtok(nullptr, ",")) {
+                if (atoi(tok) > 0) sessionCounts.push_back(atoi(tok));
+            }
+        }
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--batch") && i + 1 < argc) maxBatch = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--no-pin")) pin = false;
+        else if (!strcmp(argv[i], "--realtime")) realtime = true;
+        else if (!strcmp(argv[i], "--store") && i + 1 < argc) storeDir = argv[++i];
+        else if (!strcmp(argv[i], "--set") && i + 1 < argc) {
+            char* arg = argv[++i];
+            char* eq = strchr(arg, '=');
+            const ConfigParam* p = nullptr;
+            if (eq) {
+                *eq = '\0';
+                p = findConfigParam(arg);
+            }
+            if (!p || !configSet(config, *p, atof(eq + 1))) {
+                fprintf(stderr, "FEHLER: --set %s ungültig\n", arg);
+                return 1;
+            }
+        }
+        else if (argv[i][0] != '-') {
+            recordings.emplace_back();
+            recordings.back().path = argv[i];
+        }
+        else {
+            fprintf(stderr, "Aufruf: %s [--sessions 1,4,16,64] [--threads N] [--batch N] [--no-pin] [--realtime] [--set name=wert] [--store DIR] aufnahme.wav [...]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (recordings.empty() || sessionCounts.empty()) {
+        fprintf(stderr, "FEHLER: keine Aufnahme bzw. keine Sitzungszahl\n");
+        return 1;
+    }
+    for (Recording& r : recordings) {
+        if (!readWav(r.path, r.samples, r.rate)) {
+            fprintf(stderr, "FEHLER: %s nicht lesbar oder kein PCM16\n", r.path);
+            return 1;
+        }
+    }
+    if (storeDir && (!store.open(storeDir) || store.size() == 0)) {
+        fprintf(stderr, "FEHLER: Partitur-Speicher %s: %s\n", storeDir,
+                store.getError()[0] ? store.getError() : "keine passende Partitur");
+        return 1;
+    }
+    int scores = storeDir ? store.size() : score_library_size;
+    if (threads < 1) threads = 1;
+    if (threads > SERVER_MAX_THREADS) threads = SERVER_MAX_THREADS;
+    if (maxBatch < 1) maxBatch = 1;
+    if (maxBatch > SERVER_MAX_BATCH) maxBatch = SERVER_MAX_BATCH;
+
+    // Tracker geben Statusmeldungen über Serial aus, das ist zwischen Threads nicht geschützt
+    Serial.quiet = true;
+    Serial1.quiet = true;
+
+    // Takt der Freigabe im Echtzeit-Modus; gleichzeitig die Grenze für "verspätete" Frames
+    float period = FFT_SIZE / recordings[0].rate;
+    uint32_t periodMicros = (uint32_t)(period * 1e6f);
+
+    int cores = (int)std::thread::hardware_concurrency();
+    int usedCores = std::min(threads, cores > 0 ? cores : 1);
+    WorkerPool pool;
+    pool.start(threads, pin, periodMicros);
+    int pinned = 0;
+    for (int i = 0; i < pool.size(); i++) pinned += pool.worker(i).core >= 0;
+    printf("Server: %d Worker auf %d Kern(en) (%d gebunden), Batch <= %d, %s, %zu Aufnahme(n), %d Partitur(en)\n",
+           threads, usedCores, pinned, maxBatch, realtime ? "Echtzeit" : "so schnell wie möglich",
+           recordings.size(), scores);
+    printf("Sitzungen   Frames   Zeit s      fps  fps/Kern   p50 ms   p99 ms   max ms  verspätet  Batch  gestohlen  Ende\n");
+
+    int maxSessions = *std::max_element(sessionCounts.begin(), sessionCounts.end());
+    std::vector<std::unique_ptr<Session>> allSessions;
+    for (int i = 0; i < maxSessions; i++) allSessions.emplace_back(new Session());
+
+    for (int count : sessionCounts) {
+        std::vector<Session*> sessions;
+        for (int i = 0; i < count; i++) {
+            Session* s = allSessions[i].get();
+            s->id = i;
+            int score = i % scores;
+            s->init(&recordings[i % recordings.size()], score, storeDir ? store.view(score) : nullptr, config);
+            sessions.push_back(s);
+        }
+        std::vector<Batch> batches;
+        planBatches(sessions, threads, maxBatch, batches);
+        for (int i = 0; i < pool.size(); i++) pool.worker(i).resetStats();
+
+        uint32_t start = (uint32_t)micros();
+        uint64_t tick = 0;
+        int active = count;
+        while (active > 0) {
+            uint32_t release = (uint32_t)micros();
+            if (realtime) {
+                uint32_t due = start + (uint32_t)(tick * period * 1e6f);
+                if ((int32_t)(due - release) > 0) std::this_thread::sleep_for(std::chrono::microseconds(due - release));
+                release = due;
+            }
+            pool.run(batches, release);
+            tick++;
+            active = 0;
+            for (Session* s : sessions) active += !s->done;
+        }
+        float seconds = ((uint32_t)micros() - start) / 1e6f;
+
+        LatencyHistogram latency;
+        uint32_t maxLatency = 0, late = 0;
+        uint64_t frames = 0, executed = 0, stolen = 0;
+        for (int i = 0; i < pool.size(); i++) {
+            WorkerPool::Worker& w = pool.worker(i);
+            latency.merge(w.latency);
+            maxLatency = std::max(maxLatency, w.maxLatency);
+            late += w.lateFrames;
+            frames += w.frames;
+            executed += w.batches;
+            stolen += w.stolen;
+        }
+        int endMin = INT32_MAX, endMax = 0;
+        for (Session* s : sessions) {
+            endMin = std::min(endMin, s->tracker.current_position);
+            endMax = std::max(endMax, s->tracker.current_position);
+        }
+        float fps = seconds > 0.0f ? frames / seconds : 0.0f;
+        printf("%9d %8llu %8.2f %8.0f %9.0f %8.2f %8.2f %8.2f %10u %6.1f %9.1f%%  %d..%d\n", count,
+               (unsigned long long)frames, seconds, fps, fps / usedCores, latency.percentile(0.5f) / 1000.0f,
+               latency.percentile(0.99f) / 1000.0f, maxLatency / 1000.0f, late,
+               (float)count / batches.size(), executed ? 100.0f * stolen / executed : 0.0f, endMin, endMax);
+        fflush(stdout);
+    }
+
+    // Auslastung der Worker im letzten Durchlauf (ungleich verteilt -> Stehlen prüfen)
+    printf("Worker (letzter Durchlauf):");
+    for (int i = 0; i < pool.size(); i++) {
+        WorkerPool::Worker& w = pool.worker(i);
+        printf(" [%d: Kern %d, %llu Frames, %.2f s, %llu gestohlen]", i, w.core, (unsigned long long)w.frames,
+               w.busyMicros / 1e6f, (unsigned long long)w.stolen);
+    }
+    printf("\n");
+    pool.stop();
+    return 0;
+}
@@ -5,94 +5,682 @@
 
 #include "Settings.h"
 #include "Chroma.h"      
+#include "Activity.h"
+#include "FeatureStage.h"
+#include "Resampler.h"
+#include "AGC.h"
+#include "Scheduler.h"
+#include "AudioHealth.h"
+#include "Shell.h"
+#include "Storage.h"
+#include "Capture.h"
+#include "Memory.h"
+#include "Power.h"
+#include "SpscQueue.h"
 #include "DTW.h"         
+#include "TrackStage.h"
+#include "Recorder.h"
 #include "ScoreData.h"   
 
+// Pipeline: Erzeuger (Audio -> Aktivität -> FFT/Chroma) und Verbraucher (CENS -> DTW -> Ausgabe)
+// hängen nur über die lock-freie featureQueue zusammen.
+// 0 = Erzeuger in loop() hinter der AudioRecordQueue (Standard)
+// 1 = Erzeuger im Audio-Update-Interrupt (AudioFeatureStream); die DSP muss dann sicher unter einem
+//     Block (~2.9 ms) bleiben, sonst verliert die I2S-Eingabe Blöcke. Rohaudio-Mitschnitt geht dann nicht.
+#define PIPELINE_ISR_PRODUCER 0
+
+FeatureStage features;
+FeatureQueue featureQueue;
+BlockAGC agc;
+DTWTracker tracker;      
+TrackStage trackStage;   // Verbraucher: CENS -> [Schlag-Raster] -> DTW
+FrameScheduler scheduler;
+AudioHealthMonitor health;
+CommandShell shell;
+SlotRing checkpoints;
+DMAMEM RecorderRings recorderRings;   // ~39 KB in RAM2, RAM1 bleibt Partitur, DSP und Code
+FlightRecorder recorder(recorderRings);
+DMAMEM CaptureBuffers captureBuffers;   // 16 KB in RAM2, Mitschnitt ist meist aus
+CaptureWriter capture(captureBuffers);
+MemoryMonitor memory;
+PowerManager power;
+QueueLatency featureLatency;    // Wartezeit der Frames zwischen den Stufen
+uint32_t expectedSeq = 0;
+uint32_t lostFrames = 0;        // Lücken in FeatureFrame::seq (Queue voll)
+
+// Laufzeit-Parameter; nur zwischen zwei Frames geändert (Shell), tracker.setConfig() übernimmt sie
+TrackerConfig config = defaultTrackerConfig();
+
+int lastCheckpointPage = 0;     // Seite beim letzten Checkpoint
+bool checkpointStored = false;
+bool checkpointPending = false; // Im Frame vorgemerkt, geschrieben wird in loop()
+uint32_t sleepStart = 0;        // Beginn des letzten WFI (Tastgrad)
+
+#define AUDIO_MEMORY_BLOCKS 60
+#define SCHED_REPORT_INTERVAL 64   // Scheduler-Statistik alle ~6 s
+#define CHECKPOINT_INTERVAL 64     // Tracker-Zustand alle ~6 s und bei jedem Seitenwechsel sichern
+#define CHECKPOINT_MAX_BACKLOG 2   // ... aber erst, wenn höchstens 2 Audio-Blöcke warten
+#define DUMP_BUTTON_PIN -1         // Taster gegen GND für den Flight-Recorder-Dump (-1 = keiner)
+
+// 1 = Pegel vor der FFT automatisch auf ~-12 dBFS regeln (BlockAGC, Q15)
+#define USE_AGC 1
+int16_t block[AUDIO_BLOCK_SAMPLES];
+
+// 1 = Live-Audio per Polyphasen-Filter exakt auf SCORE_SAMPLE_RATE bringen (kostet ~16 MAC/Sample).
+// 0 = Rate-Unterschied nur im Frame-Raster des Trackers und in der Chroma-Tabelle ausgleichen.
+#define RESAMPLE_TO_SCORE_RATE 0
+
+#if RESAMPLE_TO_SCORE_RATE
+PolyphaseResampler resampler;
+int16_t resampled[RESAMPLER_MAX_BLOCK + 4];
+#define LIVE_SAMPLE_RATE SCORE_SAMPLE_RATE
+#else
+#define LIVE_SAMPLE_RATE AUDIO_SAMPLE_RATE_EXACT
+#endif
+
+// Block durch AGC/Resampler in die DSP-Stufe; volle Frames landen in der featureQueue
+void produceBlock(int16_t* samples) {
+#if USE_AGC
+    agc.process(samples, AUDIO_BLOCK_SAMPLES);
+#endif
+#if RESAMPLE_TO_SCORE_RATE
+    int n = resampler.process(samples, AUDIO_BLOCK_SAMPLES, resampled, RESAMPLER_MAX_BLOCK + 4);
+    features.push(resampled, n, featureQueue);
+#else
+    features.push(samples, AUDIO_BLOCK_SAMPLES, featureQueue);
+#endif
+}
+
 AudioInputI2S            i2s1;           
+#if PIPELINE_ISR_PRODUCER
+// Erzeuger als Knoten im Audio-Graph: update() läuft alle 128 Samples im Software-Interrupt
+// der Audio-Library und rechnet volle Frames sofort, loop() holt nur noch fertige Features.
+class AudioFeatureStream : public AudioStream {
+public:
+    AudioFeatureStream() : AudioStream(1, inputQueueArray) {}
+    virtual void update() {
+        audio_block_t* in = receiveReadOnly();
+        if (!in) return;
+        // Bis setup() fertig ist (DSP initialisiert) nur verwerfen, wie die Queue vor begin()
+        if (running) {
+            memcpy(block, in->data, sizeof(block));
+            health.consumed();
+        }
+        release(in);
+        if (running) produceBlock(block);
+    }
+    volatile bool running = false;
+private:
+    audio_block_t* inputQueueArray[1];
+};
+AudioFeatureStream       featureStream;
+AudioConnection          patchCord1(i2s1, 0, featureStream, 0);
+#else
 AudioRecordQueue         queue1;         
 AudioConnection          patchCord1(i2s1, 0, queue1, 0); 
+#endif
 
-AudioDSP dsp;            
-DTWTracker tracker;      
-
-int16_t audioBuffer[FFT_SIZE];
-float chromaVector[NUM_CHROMA];
-int bufferIndex = 0;
+void consumeFrame(FeatureFrame& f);
+void setupShell();
+void clearCheckpoint();
+void writeCheckpoint();
+void dumpRecorder();
+bool dumpRecorderToSd();
+void registerMemory();
+void printCaptureStatus();
 
 void setup() {
+    // Zuerst, solange der Stack noch flach ist
+    memory.paintStack();
     Serial.begin(115200);
-    Serial1.begin(9600); 
-    AudioMemory(60); 
+    Serial1.begin(LINK_BAUD);
+    AudioMemory(AUDIO_MEMORY_BLOCKS);
+#if DUMP_BUTTON_PIN >= 0
+    pinMode(DUMP_BUTTON_PIN, INPUT_PULLUP);
+#endif
 
-    dsp.init();
+    // Teensy I2S läuft mit 44117.647 Hz, die Partitur mit SCORE_SAMPLE_RATE
+#if RESAMPLE_TO_SCORE_RATE
+    resampler.init(AUDIO_SAMPLE_RATE_EXACT, SCORE_SAMPLE_RATE);
+#endif
+    agc.init(AUDIO_SAMPLE_RATE_EXACT);
+    features.init(LIVE_SAMPLE_RATE);
+    // Gespeicherte Parameter (Befehl "save") haben Vorrang vor den Standardwerten aus Settings.h
+    if (Storage::load(STORAGE_CONFIG_ADDR, STORAGE_CONFIG_MAGIC, &config, sizeof(config))) {
+        if (config.score_index >= score_library_size) config.score_index = 0;
+        Serial.println("Parameter aus EEPROM geladen");
+    }
+    tracker.setConfig(config);
     tracker.init();
-    queue1.begin();
-    
+    tracker.setFrameClock(LIVE_SAMPLE_RATE, FFT_SIZE);
+    // Partitur im Schlag-Raster (--beat-sync) -> Live-Chroma zwischen Einsätzen mitteln
+    trackStage.init(tracker);
+    scheduler.init(FFT_SIZE / LIVE_SAMPLE_RATE);
+    power.init();
+
+    // Nach Reset/Brown-out mitten im Stück an der gesicherten Stelle weitermachen
+    TrackerCheckpoint cp;
+    checkpoints.init(STORAGE_CHECKPOINT_ADDR, STORAGE_CHECKPOINT_SLOTS, STORAGE_CHECKPOINT_MAGIC, sizeof(cp));
+    if (checkpoints.loadLatest(&cp) && tracker.restoreCheckpoint(cp)) {
+        lastCheckpointPage = tracker.next_page_idx;
+        checkpointStored = true;
+        Serial.print("Fortsetzen bei Frame ");
+        Serial.print(tracker.current_position);
+        Serial.print(", Seite ");
+        Serial.println(tracker.next_page_idx);
+    }
+
     delay(1000);
-    Serial.println("System Bereit. Warte auf Audio...");
+    // Queue erst jetzt starten, sonst läuft sie während delay() voll und die Messung beginnt mit Verlusten
+#if PIPELINE_ISR_PRODUCER
+    featureStream.running = true;
+#else
+    queue1.begin();
+#endif
+    health.init(AUDIO_SAMPLE_RATE_EXACT, AUDIO_MEMORY_BLOCKS);
+    setupShell();
+    registerMemory();
+    memory.printReport();
+    Serial.println("System Bereit. Warte auf Audio... ('help' für Befehle)");
+    sleepStart = micros();
+}
+
+#if !PIPELINE_ISR_PRODUCER
+// Einen Block aus der Queue holen und an die DSP-Stufe geben
+void readBlock() {
+    // Block sofort kopieren und an die Audio-Library zurückgeben
+    memcpy(block, queue1.readBuffer(), sizeof(block));
+    queue1.freeBuffer();
+    health.consumed();
+    // Rohaudio wie vom Mikrofon, AGC/Resampler rechnet das Replay selbst nach
+    capture.writeSamples(block, AUDIO_BLOCK_SAMPLES);
+    produceBlock(block);
+}
+#endif
+
+// Wartet noch Audio oder ein fertiger Frame?
+bool audioPending() {
+#if PIPELINE_ISR_PRODUCER
+    return !featureQueue.empty();
+#else
+    return queue1.available() > 0 || !featureQueue.empty();
+#endif
 }
 
 void loop() {
-    // 1. Audio sammeln
-    if (queue1.available() >= 1) {
-        int16_t *buffer = queue1.readBuffer();
-        
-        for (int i = 0; i < 128; i++) {
-            if (bufferIndex < FFT_SIZE) {
-                audioBuffer[bufferIndex] = buffer[i];
-                bufferIndex++;
-            }
+    uint32_t loopStart = micros();
+    uint32_t slept = loopStart - sleepStart;
+
+    // Befehle von der USB-Serial (zwischen Frames, nie während update())
+    while (Serial.available()) shell.feed(Serial.read());
+    // 'p' vom ESP32 (Taster dort) oder eigener Taster -> Flight-Recorder ausgeben
+    while (Serial1.available()) {
+        if (Serial1.read() == 'p') dumpRecorder();
+    }
+#if DUMP_BUTTON_PIN >= 0
+    static bool buttonWasDown = false;
+    bool buttonDown = digitalRead(DUMP_BUTTON_PIN) == LOW;
+    if (buttonDown && !buttonWasDown) dumpRecorder();
+    buttonWasDown = buttonDown;
+#endif
+
+    // 0. Queue-Zustand erfassen
+#if PIPELINE_ISR_PRODUCER
+    int available = 0;
+#else
+    int available = queue1.available();
+#endif
+    health.update(available, AudioMemoryUsage(), AudioMemoryUsageMax());
+    // Im Aufholmodus billigster Pfad erzwingen, bis der Rückstand abgebaut ist
+    scheduler.setMinLevel(health.isCatchingUp() ? DEGRADE_CHROMA : DEGRADE_NONE);
+
+#if !PIPELINE_ISR_PRODUCER
+    // 1. Erzeuger: normal ein Block pro Durchlauf, beim Aufholen alles Wartende am Stück
+    int blocks = health.isCatchingUp() ? available : (available >= 1 ? 1 : 0);
+    for (int b = 0; b < blocks; b++) readBlock();
+#endif
+
+    // 2. Verbraucher: alle fertigen Frames tracken und ausgeben
+    FeatureFrame frame;
+    while (featureQueue.pop(frame)) consumeFrame(frame);
+
+    // 3. Mitschnitt: höchstens ein Sektor pro Durchlauf, beim Aufholen gar nicht. Hängt die Karte
+    // länger als ein Audio-Block, zählt das als Stall
+    if (!health.isCatchingUp()) health.blocked(capture.service());
+
+    // 4. Checkpoint: im Frame nur vorgemerkt, geschrieben erst nach dem Frame und bei flacher Queue
+#if PIPELINE_ISR_PRODUCER
+    int waiting = 0;
+#else
+    int waiting = queue1.available();
+#endif
+    if (checkpointPending && waiting <= CHECKPOINT_MAX_BACKLOG && featureQueue.empty()) writeCheckpoint();
+
+    // 5. Nichts mehr zu tun -> schlafen bis zum nächsten Interrupt (Audio-Block, SysTick, UART)
+    sleepStart = micros();
+    power.account(sleepStart - loopStart, slept);
+    if (!audioPending() && !Serial.available() && !Serial1.available()) power.idle();
+}
+
+// Checkpoint nur vormerken: die EEPROM-Emulation blockiert (ggf. Sektor-Löschen im Flash), und
+// gerade beim Seitenwechsel zählt die Latenz. writeCheckpoint() holt das in loop() nach
+void updateCheckpoint() {
+    if (tracker.finished) {
+        // Stück zu Ende -> beim nächsten Einschalten von vorne beginnen
+        if (checkpointStored) checkpointPending = true;
+        return;
+    }
+    if (!tracker.running) return;
+    if (tracker.next_page_idx != lastCheckpointPage || scheduler.getFrames() % CHECKPOINT_INTERVAL == 0) {
+        lastCheckpointPage = tracker.next_page_idx;
+        checkpointPending = true;
+    }
+}
+
+// Vorgemerkten Checkpoint schreiben; sichert den Tracker-Zustand von jetzt, nicht den beim Vormerken
+void writeCheckpoint() {
+    checkpointPending = false;
+    if (tracker.finished) {
+        clearCheckpoint();
+        return;
+    }
+    if (!tracker.running) return;
+    TrackerCheckpoint cp;
+    tracker.saveCheckpoint(cp);
+    checkpoints.save(&cp);
+    checkpointStored = true;
+}
+
+void clearCheckpoint() {
+    if (checkpointStored) checkpoints.erase();
+    lastCheckpointPage = 0;
+    checkpointStored = false;
+    checkpointPending = false;
+}
+
+// Verbraucher: ein fertiger Frame aus der DSP-Stufe -> CENS -> DTW -> Ausgabe
+void consumeFrame(FeatureFrame& f) {
+    featureLatency.add(micros() - f.produced);
+    if (f.seq != expectedSeq) lostFrames += f.seq - expectedSeq;
+    expectedSeq = f.seq + 1;
+
+    // --- ZEITSTEMPEL (Fertigstellung in der DSP-Stufe) ---
+    float timestamp = f.millis / 1000.0;
+
+    // Flight-Recorder: Keyframe vor update(), Eingaben und Entscheidung dieses Frames
+    recorder.beginFrame(tracker);
+    RecorderFrame& rec = recorder.current(tracker);
+    rec.millis = f.millis;
+    int pageBefore = tracker.next_page_idx;
+
+    scheduler.beginFrame();
+    scheduler.addWork(f.dspMicros);
+    rec.volume = f.volume;
+
+    // Mitschnitt vor CENS (wie aus der DSP-Stufe), Recorder danach (Feature-Raum des Trackers)
+    if (f.flags & FEATURE_ACTIVE) capture.writeFrame(f.volume, f.flatness, f.snr, f.onset, f.chroma);
+    else capture.writeFrame(f.volume, 0.0f, 0.0f, 0.0f, nullptr);
+    TrackAction action = trackStage.consume(f);
+    bool tracked = action != TRACK_REST;
+    if (f.flags & FEATURE_ACTIVE) {
+        memcpy(rec.chroma, f.chroma, sizeof(rec.chroma));
+        rec.flags |= REC_ACTIVE;
+    }
+    if (action == TRACK_UPDATE) FlightRecorder::noteUpdate(rec, trackStage.input, trackStage.snr, trackStage.onset, trackStage.advance);
+    if (!tracked) rec.flags |= REC_REST;
+    scheduler.endFrame();
+    recorder.endFrame(tracker, rec, pageBefore);
+    trackStage.applyDegradation(scheduler.getLevel(), features);
+    // Takt nach Last; voller Takt nur, solange tatsächlich verfolgt wird
+    bool tracking = tracker.running && !tracker.finished && features.activity.isActive();
+    // Mit der DSP im Audio-Interrupt zählt auch deren Block-Frist (PowerManager::update)
+    if (power.update(scheduler.getFrameLoad(), tracking, PIPELINE_ISR_PRODUCER ? f.dspMicros : 0)) scheduler.clockChanged();
+    updateCheckpoint();
+
+    // --- AUSGABE JEDEN FRAME ---
+    // Nur ausgeben, wenn Tracker läuft (sonst spammt er "Waiting"); beim Aufholen spart das Serial-Zeit
+    if (tracker.running && !health.isCatchingUp()) {
+        Serial.print("["); 
+        Serial.print(timestamp, 3); // 3 Nachkommastellen (ms)
+        Serial.print("s] ");
+
+        // Fortschrittsbalken
+        int barWidth = 20;
+        float progress = (float)tracker.current_position / (float)tracker.score->len;
+        int pos = barWidth * progress;
+
+        Serial.print("[");
+        for (int i = 0; i < barWidth; ++i) {
+            if (i < pos) Serial.print("=");
+            else if (i == pos) Serial.print(">");
+            else Serial.print(" ");
+        }
+        Serial.print("] Pos: ");
+        Serial.print(tracker.current_position);
+        Serial.print(" | Tempo: ");
+        Serial.print(tracker.tempo, 2);
+        Serial.print(" | Konf: ");
+        Serial.print(tracker.confidence, 2);
+#if USE_AGC
+        Serial.print(" | Gain: ");
+        Serial.print(agc.getGainDb(), 1);
+        Serial.print(" dB");
+#endif
+        Serial.print(" | Load: ");
+        Serial.print((int)(scheduler.getLoad() * 100));
+        Serial.print("% L");
+        Serial.print((int)scheduler.getLevel());
+        Serial.print(" @");
+        Serial.print((unsigned long)power.getClockMHz());
+
+        // Debug Kosten (vom aktuellen Frame, vor der Normalisierung; danach ist das Minimum immer 0)
+        if (!tracked) {
+            Serial.println(" | Pause");
+        } else {
+            Serial.print(" | Cost: ");
+            Serial.println(tracker.cost, 2);
         }
-        queue1.freeBuffer();
-
-        // 2. Wenn Puffer voll -> Verarbeiten
-        if (bufferIndex >= FFT_SIZE) {
-            
-            // --- ZEITSTEMPEL HOLEN ---
-            float timestamp = millis() / 1000.0;
-
-            // Lautstärke berechnen
-            float sum = 0;
-            for(int i=0; i<FFT_SIZE; i++) sum += abs(audioBuffer[i]);
-            float volume = sum / FFT_SIZE;
-
-            // Berechnung
-            dsp.process(audioBuffer, chromaVector);
-            tracker.update(chromaVector, volume);
-
-            // --- AUSGABE JEDEN FRAME ---
-            // Nur ausgeben, wenn Tracker läuft (sonst spammt er "Waiting")
-            if (tracker.running) {
-                Serial.print("["); 
-                Serial.print(timestamp, 3); // 3 Nachkommastellen (ms)
-                Serial.print("s] ");
-                
-                // Fortschrittsbalken
-                int barWidth = 20;
-                float progress = (float)tracker.current_position / (float)score_len;
-                int pos = barWidth * progress;
-                
-                Serial.print("[");
-                for (int i = 0; i < barWidth; ++i) {
-                    if (i < pos) Serial.print("=");
-                    else if (i == pos) Serial.print(">");
-                    else Serial.print(" ");
-                }
-                Serial.print("] Pos: ");
-                Serial.print(tracker.current_position);
-                
-                // Debug Kosten (vom aktuellen Frame)
-                // Wir greifen direkt auf das Array im Tracker zu
-                // Vorsicht: prev_col enthält jetzt die Werte dieses Durchlaufs (wegen swap am Ende von update)
-                if (tracker.current_position < score_len) {
-                    Serial.print(" | Cost: ");
-                    Serial.println(tracker.prev_col[tracker.current_position], 2);
-                } else {
-                    Serial.println();
-                }
-            }
-
-            bufferIndex = 0; 
+    }
+
+    // --- SCHEDULER- UND AUDIO-STATISTIK ---
+    if (scheduler.getFrames() % SCHED_REPORT_INTERVAL == 0) {
+        Serial.print("Sched: ");
+        Serial.print(scheduler.getFrames());
+        Serial.print(" Frames, max ");
+        Serial.print(scheduler.getMaxMicros());
+        Serial.print(" us, Überläufe ");
+        Serial.print(scheduler.getOverruns());
+        Serial.print(", verpasst ");
+        Serial.print(scheduler.getMissedDeadlines());
+        Serial.print(", Degradationen ");
+        Serial.println(scheduler.getDegradations());
+
+        Serial.print("Audio: Queue max ");
+        Serial.print(health.getMaxBacklog());
+        Serial.print(" Blöcke, Lag ");
+        Serial.print(health.getLagSamples());
+        Serial.print(" Samples, verloren ");
+        Serial.print(health.getLostBlocks());
+        Serial.print(", Speicher ");
+        Serial.print(health.getMemoryMax());
+        Serial.print("/");
+        Serial.print(health.getMemoryBlocks());
+        Serial.print(health.isMemoryCritical() ? " (kritisch)" : "");
+        Serial.print(", Aufholen ");
+        Serial.print(health.getCatchups());
+        Serial.print(", Stalls ");
+        Serial.print((unsigned long)health.getStalls());
+        Serial.print(" (max ");
+        Serial.print((unsigned long)health.getMaxStallMicros());
+        Serial.println(" us)");
+
+        Serial.print("Pipeline: Queue max ");
+        Serial.print((unsigned long)featureQueue.getMaxDepth());
+        Serial.print("/");
+        Serial.print((unsigned long)featureQueue.capacity());
+        Serial.print(" Frames, verworfen ");
+        Serial.print((unsigned long)lostFrames);
+        Serial.print(", Wartezeit ");
+        Serial.print((unsigned long)featureLatency.mean());
+        Serial.print(" us (max ");
+        Serial.print((unsigned long)featureLatency.max);
+        Serial.println(" us)");
+        featureLatency.reset();
+
+        if (capture.isActive()) printCaptureStatus();
+
+        // Tastgrad und Leistung über die letzten 64 Frames
+        Serial.print("Power: ");
+        Serial.print((unsigned long)power.getClockMHz());
+        Serial.print(" MHz, wach ");
+        Serial.print(power.getDutyCycle() * 100.0f, 1);
+        Serial.print("%, ~");
+        Serial.print((int)power.getPowerMw());
+        Serial.print(" mW, Taktwechsel ");
+        Serial.print((unsigned long)power.getClockChanges());
+        Serial.print(", WFI ");
+        Serial.println((unsigned long)power.getSleeps());
+        power.resetStats();
+    }
+}
+
+// --- FLIGHT-RECORDER ---
+// Ring einfrieren und binär über USB ausgeben; Rahmen "DUMP <Bytes>" ... "END" für die Mitschrift.
+// Auswerten: host_replay --dump mitschnitt.bin (sucht den Dump-Kopf in der Datei)
+void dumpRecorder() {
+    recorder.frozen = true;
+    Serial.print("DUMP ");
+    Serial.println((unsigned long)recorder.dumpSize());
+    recorder.dump(Serial, tracker);
+    Serial.println();
+    Serial.println("END");
+    recorder.frozen = false;
+}
+
+// Dasselbe Format als REC<n>.BIN auf die SD-Karte (host_replay --dump liest die Datei direkt).
+// Blockiert wie die USB-Ausgabe, nur aus der Shell
+bool dumpRecorderToSd() {
+    char name[16];
+    File file = createNumberedFile(RECORDER_FILE_PATTERN, name, sizeof(name));
+    if (!file) return false;
+    recorder.frozen = true;
+    size_t bytes = recorder.dump(file, tracker);
+    recorder.frozen = false;
+    file.close();
+    Serial.print("OK dump ");
+    Serial.print(name);
+    Serial.print(", ");
+    Serial.print((unsigned long)bytes);
+    Serial.println(" Bytes");
+    return true;
+}
+
+// --- SERIAL-SHELL ---
+void printParam(const ConfigParam& p) {
+    Serial.print(p.name);
+    Serial.print(" = ");
+    if (p.f) Serial.println(configGet(config, p), 3);
+    else Serial.println((int)configGet(config, p));
+}
+
+void cmdGet(int argc, char** argv) {
+    if (argc < 2) {
+        for (int i = 0; i < config_param_count; i++) printParam(config_params[i]);
+        return;
+    }
+    const ConfigParam* p = findConfigParam(argv[1]);
+    if (p) printParam(*p);
+    else Serial.println("ERR Unbekannter Parameter");
+}
+
+void cmdSet(int argc, char** argv) {
+    if (argc < 3) { Serial.println("ERR set <name> <wert>"); return; }
+    const ConfigParam* p = findConfigParam(argv[1]);
+    if (!p) { Serial.println("ERR Unbekannter Parameter"); return; }
+    if (!configSet(config, *p, atof(argv[2]))) { Serial.println("ERR Wert außerhalb des Bereichs"); return; }
+    // Unter dem Minimum des Zeitrasters würde der Tracker still hochsetzen -> wirksamen Wert speichern und zeigen
+    bool raised = p->i == &TrackerConfig::radius && config.radius < tracker.minRadius();
+    if (raised) config.radius = tracker.minRadius();
+    tracker.setConfig(config);
+    if (raised) Serial.print("(Minimum) ");
+    printParam(*p);
+}
+
+void cmdReset(int argc, char** argv) {
+    tracker.reset();
+    trackStage.reset();
+    clearCheckpoint();
+    Serial.println("OK reset");
+}
+
+void cmdSeek(int argc, char** argv) {
+    if (argc < 2) { Serial.println("ERR seek <frame>"); return; }
+    tracker.seek(atoi(argv[1]));
+    trackStage.beats.reset();
+    clearCheckpoint();
+    Serial.print("OK seek ");
+    Serial.println(tracker.current_position);
+}
+
+void cmdScore(int argc, char** argv) {
+    if (argc < 2) {
+        for (int i = 0; i < score_library_size; i++) {
+            Serial.print(i == config.score_index ? "* " : "  ");
+            Serial.print(i);
+            Serial.print(": ");
+            Serial.print(score_library[i].name);
+            Serial.print(" (");
+            Serial.print(score_library[i].len);
+            Serial.println(" Frames)");
         }
+        return;
     }
-}
\ No newline at end of file
+    int idx = atoi(argv[1]);
+    if (idx < 0 || idx >= score_library_size) { Serial.println("ERR Unbekannte Partitur"); return; }
+    config.score_index = idx;
+    tracker.setConfig(config);
+    tracker.setScore(&score_library[idx]);
+    trackStage.reset();
+    clearCheckpoint();
+    Serial.print("OK score ");
+    Serial.println(score_library[idx].name);
+}
+
+void cmdSave(int argc, char** argv) {
+    Storage::save(STORAGE_CONFIG_ADDR, STORAGE_CONFIG_MAGIC, &config, sizeof(config));
+    Serial.println("OK gespeichert");
+}
+
+void cmdDefaults(int argc, char** argv) {
+    uint8_t scoreIndex = config.score_index;
+    config = defaultTrackerConfig();
+    config.score_index = scoreIndex;
+    tracker.setConfig(config);
+    Serial.println("OK Standardwerte (mit 'save' übernehmen)");
+}
+
+void cmdDump(int argc, char** argv) {
+    if (argc < 2) {
+        dumpRecorder();
+        return;
+    }
+    if (strcmp(argv[1], "sd")) { Serial.println("ERR dump [sd]"); return; }
+    if (!dumpRecorderToSd()) Serial.println("ERR SD-Karte nicht bereit");
+}
+
+void printCaptureStatus() {
+    Serial.print("Capture: ");
+    Serial.print(capture.getFileName());
+    Serial.print(", ");
+    Serial.print((unsigned long)capture.getBytes());
+    Serial.print(" Bytes, verworfen ");
+    Serial.print((unsigned long)capture.getDropped());
+    Serial.print(", max ");
+    Serial.print((unsigned long)capture.getMaxWriteMicros());
+    Serial.println(" us pro Sektor");
+}
+
+void cmdCapture(int argc, char** argv) {
+    if (argc < 2) {
+        if (capture.isActive()) printCaptureStatus();
+        else Serial.println("Capture aus");
+        return;
+    }
+    if (!strcmp(argv[1], "stop")) {
+        if (!capture.isActive()) { Serial.println("ERR Capture läuft nicht"); return; }
+        capture.stop();
+        Serial.print("OK ");
+        printCaptureStatus();
+        return;
+    }
+    CaptureType type;
+    if (!strcmp(argv[1], "raw")) type = CAPTURE_RAW;
+    else if (!strcmp(argv[1], "features")) type = CAPTURE_FEATURES;
+    else { Serial.println("ERR capture raw|features|stop"); return; }
+    // Rohaudio mit der I2S-Rate, Features im Raster des DSP (ggf. nach dem Resampler)
+#if PIPELINE_ISR_PRODUCER
+    // Rohaudio käme aus dem Interrupt, während service() in loop() auf die SD schreibt
+    if (type == CAPTURE_RAW) { Serial.println("ERR Rohaudio nicht mit PIPELINE_ISR_PRODUCER"); return; }
+#endif
+    float rate = (type == CAPTURE_RAW) ? AUDIO_SAMPLE_RATE_EXACT : LIVE_SAMPLE_RATE;
+    if (!capture.start(type, rate, FFT_SIZE, NUM_CHROMA)) {
+        Serial.println("ERR SD-Karte nicht bereit");
+        return;
+    }
+    Serial.print("OK capture ");
+    Serial.println(capture.getFileName());
+}
+
+// --- SPEICHER-BUDGET ---
+// Partitur-Daten sind const -> ohne PROGMEM liegen sie auf dem Teensy 4 in RAM1 (wie .data)
+uint32_t scoreBytes(const ScoreView& s) {
+    return s.len * NUM_CHROMA * sizeof(float) + (s.onset ? s.len * sizeof(float) : 0) + s.num_pages * sizeof(int);
+}
+
+// Tracker: prev_col, curr_col, score_magnitudes je ein float pro Partitur-Frame
+uint32_t trackerHeap(int len) {
+    return 3 * len * sizeof(float);
+}
+
+void registerMemory() {
+    uint32_t scores = 0;
+    for (int i = 0; i < score_library_size; i++) scores += scoreBytes(score_library[i]);
+    memory.setModule("AudioDSP", sizeof(features), 0);
+    memory.setModule("DTWTracker", sizeof(tracker), trackerHeap(tracker.score->len));
+    memory.setModule("Partituren", scores, 0);
+    memory.setModule("Flight-Recorder", sizeof(recorder), 0);
+    memory.setModule("Recorder-Ringe", sizeof(recorderRings), 0, true);
+    memory.setModule("Capture", sizeof(capture), 0);
+    memory.setModule("Capture-Puffer", sizeof(captureBuffers), 0, true);
+    memory.setModule("AudioMemory", AUDIO_MEMORY_BLOCKS * sizeof(audio_block_t), 0);
+    memory.setModule("Feature-Queue", sizeof(featureQueue), 0);
+    memory.setModule("Frame-Puffer", sizeof(block), 0);
+    memory.setModule("Sonstige", sizeof(trackStage) + sizeof(agc) +
+                     sizeof(scheduler) + sizeof(health) + sizeof(shell) + sizeof(checkpoints), 0);
+}
+
+void cmdMem(int argc, char** argv) {
+    registerMemory();
+    memory.printReport();
+    Serial.print("AudioMemory: max ");
+    Serial.print(AudioMemoryUsageMax());
+    Serial.print(" / ");
+    Serial.print(AUDIO_MEMORY_BLOCKS);
+    Serial.println(" Blöcke");
+
+    // "mem <frames>": passt eine Partitur dieser Länge noch? (alte Spalten werden vorher freigegeben)
+    int len = (argc >= 2) ? atoi(argv[1]) : tracker.score->len;
+    int32_t reserve = (int32_t)memory.getHeapSize() - (int32_t)memory.getHeapUsed()
+                      + (int32_t)trackerHeap(tracker.score->len) - (int32_t)trackerHeap(len);
+    Serial.print("Partitur mit ");
+    Serial.print(len);
+    Serial.print(" Frames: Tracker-Heap ");
+    Serial.print((unsigned long)trackerHeap(len));
+    Serial.print(" B, Reserve ");
+    Serial.print((long)reserve);
+    Serial.println(reserve < 0 ? " B -> passt NICHT" : " B");
+    // Der Radius kostet keinen RAM (Fenster liegt in den Spalten), nur Rechenzeit
+    Serial.print("Radius ");
+    Serial.print(tracker.radius);
+    Serial.print(": ");
+    Serial.print(2 * tracker.radius + 1);
+    Serial.println(" Zellen pro Frame, Keyframes fest für CONFIG_MAX_RADIUS");
+}
+
+void cmdHelp(int argc, char** argv) {
+    shell.printHelp();
+}
+
+void setupShell() {
+    shell.add("get", cmdGet, "get [name] - Parameter anzeigen");
+    shell.add("set", cmdSet, "set <name> <wert> - Parameter ändern (sofort aktiv)");
+    shell.add("reset", cmdReset, "Tracker auf Anfang");
+    shell.add("seek", cmdSeek, "seek <frame> - Position setzen");
+    shell.add("score", cmdScore, "score [nr] - Partituren anzeigen / wechseln");
+    shell.add("save", cmdSave, "Parameter im EEPROM speichern");
+    shell.add("defaults", cmdDefaults, "Standardwerte aus Settings.h");
+    shell.add("dump", cmdDump, "dump [sd] - Flight-Recorder (letzte ~24 s) binär ausgeben / auf SD");
+    shell.add("capture", cmdCapture, "capture raw|features|stop - Mitschnitt auf SD");
+    shell.add("mem", cmdMem, "mem [frames] - Stack/Heap/AudioMemory und Budget pro Modul");
+    shell.add("help", cmdHelp, "Diese Liste");
+}
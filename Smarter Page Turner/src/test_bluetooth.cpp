@@ -1,12 +1,15 @@
 #include <Arduino.h>
+#include "Settings.h"
 
 // Auf dem Teensy 4.1
 void setup() {
   // Serial1 sind Pins 0(RX1) und 1(TX1) am Teensy 4.1
-  Serial1.begin(115200);
+  Serial1.begin(LINK_BAUD);
 }
 
 void loop() {
+    // Präambel weckt den ESP32 aus dem Light-Sleep, dann 'n'
+    for (int i = 0; i < LINK_WAKE_PREAMBLE; i++) Serial1.write((uint8_t)LINK_WAKE_BYTE);
     Serial1.print('n'); // Sende 'n' an den ESP32
     delay(2000); // Entprellen
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <Wire.h>
 #include <SPI.h>
 #include "Chroma.h"
+#include "AudioHealth.h"
 
 // --- AUDIO GUI SETUP ---
 // GUItool: begin automatically generated code
@@ -13,10 +14,26 @@ AudioConnection          patchCord1(i2s1, 0, queue1, 0); // Linker Kanal -> Queu
 
 // --- DSP SETUP ---
 AudioDSP dsp;
+AudioHealthMonitor health;
+uint32_t reportedLost = 0;
 int16_t audioBuffer[FFT_SIZE];
 float chromaVector[NUM_CHROMA];
 int bufferIndex = 0;
 
+// CSV-Kopf passend zu NUM_CHROMA: 12 Bins "C,C#,...", feiner mit Abstand in Cent ("C+0,C+50,C#+0,...")
+void printCsvHeader() {
+    static const char* names[12] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+    for (int i = 0; i < NUM_CHROMA; i++) {
+        Serial.print(names[i / CHROMA_BINS_PER_SEMITONE]);
+        if (CHROMA_BINS_PER_SEMITONE > 1) {
+            Serial.print("+");
+            Serial.print((int)lroundf(100.0f * (i % CHROMA_BINS_PER_SEMITONE) / CHROMA_BINS_PER_SEMITONE));
+        }
+        if (i < NUM_CHROMA - 1) Serial.print(",");
+    }
+    Serial.println();
+}
+
 void setup() {
     Serial.begin(115200);
     
@@ -28,12 +45,21 @@ void setup() {
 
     // Audio Input starten
     queue1.begin();
+    health.init(AUDIO_SAMPLE_RATE_EXACT, 30);
     
     Serial.println("Start Mic Test & Chroma Analysis...");
-    Serial.println("C,C#,D,D#,E,F,F#,G,G#,A,A#,B"); // CSV Header
+    printCsvHeader();
 }
 
 void loop() {
+    health.update(queue1.available(), AudioMemoryUsage(), AudioMemoryUsageMax());
+    // Verlorene Blöcke als Kommentarzeile melden (stört die CSV-Auswertung nicht)
+    if (health.getLostBlocks() > reportedLost) {
+        reportedLost = health.getLostBlocks();
+        Serial.print("# Verlorene Audio-Blöcke: ");
+        Serial.println(reportedLost);
+    }
+
     // Wir sammeln Daten aus der Queue, bis wir FFT_SIZE (1024) Samples haben
     if (queue1.available() >= 1) {
         int16_t *buffer = queue1.readBuffer();
@@ -47,6 +73,7 @@ void loop() {
         }
         
         queue1.freeBuffer();
+        health.consumed();
 
         // Wenn unser Puffer voll ist (1024 Samples), DSP starten
         if (bufferIndex >= FFT_SIZE) {